@@ -3,8 +3,11 @@
 
 // misc
 #include "RandLAPACK/misc/rl_util.hh"
+#include "RandLAPACK/misc/rl_lapack_work.hh"
 #include "RandLAPACK/misc/rl_linops.hh"
 #include "RandLAPACK/misc/rl_gen.hh"
+#include "RandLAPACK/misc/rl_panels.hh"
+#include "RandLAPACK/misc/rl_sparse.hh"
 
 // Computational routines
 #include "RandLAPACK/comps/rl_determiter.hh"
@@ -15,11 +18,14 @@
 #include "RandLAPACK/comps/rl_syps.hh"
 #include "RandLAPACK/comps/rl_syrf.hh"
 #include "RandLAPACK/comps/rl_orth.hh"
+#include "RandLAPACK/comps/rl_sketch_qrcp.hh"
 
 // Drivers
 #include "RandLAPACK/drivers/rl_rsvd.hh"
 #include "RandLAPACK/drivers/rl_cqrrpt.hh"
+#include "RandLAPACK/drivers/rl_cqrrpt_update.hh"
 #include "RandLAPACK/drivers/rl_cqrrp.hh"
+#include "RandLAPACK/drivers/rl_cqrrp_recursive.hh"
 #include "RandLAPACK/drivers/rl_revd2.hh"
 #include "RandLAPACK/drivers/rl_rbki.hh"
 
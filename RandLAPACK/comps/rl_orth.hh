@@ -3,6 +3,7 @@
 #include "rl_blaspp.hh"
 #include "rl_lapackpp.hh"
 #include "rl_util.hh"
+#include "rl_lapack_work.hh"
 
 #include <RandBLAS.hh>
 #include <cstdint>
@@ -62,6 +63,7 @@ class CholQRQ : public Stabilization<T> {
         bool chol_fail;
         bool cond_check;
         bool verbose;
+        std::vector<T> A_gram; // Buffer for the Gram matrix, reused across calls
 };
 
 // -----------------------------------------------------------------------------
@@ -72,7 +74,8 @@ int CholQRQ<T>::call(
     T* A
 ){
 
-    T* A_gram  = ( T * ) calloc( k * k, sizeof( T ) );
+    T* A_gram  = util::upsize(k * k, this->A_gram);
+    std::fill(&A_gram[0], &A_gram[k * k], (T) 0.0);
 
     // Find normal equation Q'Q - Just the upper triangular portion
     blas::syrk(Layout::ColMajor, Uplo::Upper, Op::Trans, k, m, 1.0, A, m, 0.0, A_gram, k);
@@ -83,20 +86,16 @@ int CholQRQ<T>::call(
             printf("CHOLESKY QR FAILED\n");
         }
         this->chol_fail = true; // scheme failure
-        free(A_gram);
         return 1;
     }
 
     // Scheme may succeed, but output garbage
     if(this->cond_check) {
-        if(util::cond_num_check(k, k, A_gram, this->verbose) > (1 / std::sqrt(std::numeric_limits<T>::epsilon()))){
-                free(A_gram);
+        if(util::cond_num_check(k, k, A_gram, this->verbose) > (1 / std::sqrt(std::numeric_limits<T>::epsilon())))
                 return 1;
-        }
     }
 
     blas::trsm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, m, k, 1.0, A_gram, k, A, m);
-    free(A_gram);
     return 0;
 }
 
@@ -141,6 +140,8 @@ class HQRQ : public Stabilization<T> {
     public:
         bool cond_check;
         bool verbose;
+        std::vector<T> tau; // Buffer for the scalar factors, reused across calls
+        std::vector<T> work; // Work array of GEQRF and UNGQR, reused across calls
 };
 
 // -----------------------------------------------------------------------------
@@ -154,15 +155,14 @@ int HQRQ<T>::call(
     // tau The vector tau of length min(m,n). The scalar factors of the elementary reflectors (see Further Details).
     // tau needs to be a vector of all 2's by default
 
-    T* tau  = ( T * ) calloc( n, sizeof( T ) );
+    T* tau  = util::upsize(n, this->tau);
+    int64_t lwork = std::max(util::geqrf_work_size<T>(m, n), util::ungqr_work_size<T>(m, n, n));
+    T* work = util::upsize(lwork, this->work);
 
-    if(lapack::geqrf(m, n, A, m, tau)) {
-        free(tau);
+    if(util::geqrf(m, n, A, m, tau, work, lwork))
         return 1; // Failure condition
-    }
 
-    lapack::ungqr(m, n, n, A, m, tau);
-    free(tau);
+    util::ungqr(m, n, n, A, m, tau, work, lwork);
     return 0;
 }
 
@@ -207,6 +207,7 @@ class PLUL : public Stabilization<T> {
     public:
         bool cond_check;
         bool verbose;
+        std::vector<lapack_int> ipiv; // Buffer for the pivot vector, reused across calls
 };
 
 
@@ -217,17 +218,14 @@ int PLUL<T>::call(
     int64_t n,
     T* A
 ){
-    int64_t* ipiv  = ( int64_t * ) calloc( n, sizeof( int64_t ) );
+    lapack_int* ipiv  = util::upsize(n, this->ipiv);
 
-    if(lapack::getrf(m, n, A, m, ipiv)) {
-        free(ipiv);
+    if(util::getrf(m, n, A, m, ipiv))
         return 1; // failure condition
-    }
 
     util::get_L(m, n, A, 1);
-    lapack::laswp(n, A, m, 1, n, ipiv, 1);
+    util::laswp(n, A, m, 1, n, ipiv, 1);
 
-    free(ipiv);
     return 0;
 }
 
@@ -5,6 +5,7 @@
 #include "rl_blaspp.hh"
 #include "rl_lapackpp.hh"
 #include "rl_util.hh"
+#include "rl_lapack_work.hh"
 
 #include <RandBLAS.hh>
 #include <math.h>
@@ -31,6 +32,27 @@ class QBalg {
             T* &BT,
             RandBLAS::RNGState<RNG> &state
         ) = 0;
+
+        virtual int64_t workspace_query(
+            int64_t m,
+            int64_t n,
+            int64_t k,
+            int64_t b_sz
+        ) = 0;
+
+        virtual int call(
+            int64_t m,
+            int64_t n,
+            T* A,
+            int64_t &k,
+            int64_t b_sz,
+            T tol,
+            T* Q,
+            T* BT,
+            RandBLAS::RNGState<RNG> &state,
+            void* work,
+            int64_t work_bytes
+        ) = 0;
 };
 
 template <typename T, typename RNG>
@@ -122,6 +144,34 @@ class QB : public QBalg<T, RNG> {
             RandBLAS::RNGState<RNG> &state
         ) override;
 
+        /// Returns the size (in bytes) of the workspace that the call() overload below
+        /// requires for an m by n input, expected rank k and block size b_sz.
+        int64_t workspace_query(
+            int64_t m,
+            int64_t n,
+            int64_t k,
+            int64_t b_sz
+        ) override;
+
+        /// Same as above, but Q (m by k) and BT (n by k) are caller-owned buffers of full size,
+        /// and the internal buffers are placed into a caller-owned workspace
+        /// of at least workspace_query(m, n, k, b_sz) bytes, aligned to 64 bytes.
+        /// No heap allocations are made by QB itself, so repeated calls on same-sized problems
+        /// can reuse one workspace.
+        int call(
+            int64_t m,
+            int64_t n,
+            T* A,
+            int64_t &k,
+            int64_t b_sz,
+            T tol,
+            T* Q,
+            T* BT,
+            RandBLAS::RNGState<RNG> &state,
+            void* work,
+            int64_t work_bytes
+        ) override;
+
     public:
         RandLAPACK::RangeFinder<T, RNG> &RF_Obj;
         RandLAPACK::Stabilization<T> &Orth_Obj;
@@ -129,6 +179,18 @@ class QB : public QBalg<T, RNG> {
         bool orth_check;
 };
 
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int64_t QB<T, RNG>::workspace_query(
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    int64_t b_sz
+){
+    return util::workspace_bytes<T>(k * std::min(b_sz, k))   // QtQi
+         + util::workspace_bytes<T>(m * n);                  // A_cpy
+}
+
 // -----------------------------------------------------------------------------
 template <typename T, typename RNG>
 int QB<T, RNG>::call(
@@ -141,6 +203,37 @@ int QB<T, RNG>::call(
     T* &Q,
     T* &BT,
     RandBLAS::RNGState<RNG> &state
+){
+    // We require Q, B to be nullptr.
+    if(Q) free(Q);
+    if(BT) free(BT);
+    // Make sure Q, B have space for k columns.
+    Q  = ( T * ) calloc(m * k, sizeof( T ) );
+    BT = ( T * ) calloc(n * k, sizeof( T ) );
+
+    int64_t work_bytes = this->workspace_query(m, n, k, b_sz);
+    void* work = util::workspace_alloc(work_bytes);
+
+    int info = this->call(m, n, A, k, b_sz, tol, Q, BT, state, work, work_bytes);
+
+    free(work);
+    return info;
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int QB<T, RNG>::call(
+    int64_t m,
+    int64_t n,
+    T* A,
+    int64_t &k,
+    int64_t b_sz,
+    T tol,
+    T* Q,
+    T* BT,
+    RandBLAS::RNGState<RNG> &state,
+    void* work,
+    int64_t work_bytes
 ){
     // #cols(Q) & #cols(BT) that are filled at a given iteration.
     int64_t curr_sz = 0;
@@ -151,21 +244,16 @@ int QB<T, RNG>::call(
     T prev_err = 0.0;
     T approx_err = 0.0;
 
-    // We require Q, B to be nullptr.
-    if(Q) free(Q);
-    if(BT) free(BT);
-    // Make sure Q, B have space for one iteration
-    Q  = ( T * ) calloc(m * b_sz, sizeof( T ) );
-    BT = ( T * ) calloc(n * b_sz, sizeof( T ) );
-    // Allocate buffers
-    T* QtQi  = ( T * ) calloc( b_sz * b_sz, sizeof( T ) );
-    T* A_cpy = ( T * ) calloc( m * n,       sizeof( T ) );
+    // Place buffers into the workspace
+    util::Workspace ws(work, work_bytes);
+    T* QtQi  = ws.take<T>(k * std::min(b_sz, k), true);
+    T* A_cpy = ws.take<T>(m * n);
     // Declate pointers to the iteration buffers.
     T* Q_i;
     T* BT_i;
 
     // pre-compute nrom
-    T norm_A = lapack::lange(Norm::Fro, m, n, A, m);
+    T norm_A = util::lange(Norm::Fro, m, n, A, m, (T*) nullptr);
 
     // Copy the initial data to avoid unwanted modification
     lapack::lacpy(MatrixType::General, m, n, A, m, A_cpy, m);
@@ -174,13 +262,7 @@ int QB<T, RNG>::call(
         // Dynamically changing block size.
         b_sz = std::min(b_sz, k - curr_sz);
         next_sz = curr_sz + b_sz;
-        
-        // Allocate more space in Q, B, QtQi buffer if needed.
-        if (curr_sz != 0) {
-            Q    = ( T * ) realloc(Q,    next_sz * m * sizeof( T ));
-            BT   = ( T * ) realloc(BT,   next_sz * n * sizeof( T ));
-            QtQi = ( T * ) realloc(QtQi, next_sz * b_sz * sizeof( T ));
-        }
+
 
         // Avoid extra buffer allocation, but be careful about pointing to the
         // correct location.
@@ -191,8 +273,6 @@ int QB<T, RNG>::call(
         if(this->RF_Obj.call(m, n, A_cpy, b_sz, Q_i, state)) {
             // RF failed
             k = curr_sz;
-            free(A_cpy);
-            free(QtQi);
             return 6;
         }
 
@@ -200,8 +280,6 @@ int QB<T, RNG>::call(
             if (util::orthogonality_check(m, b_sz, Q_i, this->verbose)) {
                 // Lost orthonormality of Q
                 k = curr_sz;
-                free(A_cpy);
-                free(QtQi);
                 return 4;
             }
         }
@@ -218,7 +296,7 @@ int QB<T, RNG>::call(
         blas::gemm(Layout::ColMajor, Op::Trans, Op::NoTrans, n, b_sz, m, 1.0, A_cpy, m, Q_i, m, 0.0, BT_i, n);
 
         // Updating B norm estimation
-        T norm_B_i = lapack::lange(Norm::Fro, n, b_sz, BT_i, n);
+        T norm_B_i = util::lange(Norm::Fro, n, b_sz, BT_i, n, (T*) nullptr);
         norm_B = std::hypot(norm_B, norm_B_i);
         // Updating approximation error
         prev_err = approx_err;
@@ -228,8 +306,6 @@ int QB<T, RNG>::call(
         if ((curr_sz > 0) && (approx_err > prev_err)) {
             // Early termination - error has grown.
             k = curr_sz;
-            free(A_cpy);
-            free(QtQi);
             return 2;
         }
 
@@ -237,8 +313,6 @@ int QB<T, RNG>::call(
             if (util::orthogonality_check(m, next_sz, Q, this->verbose)) {
                 // Lost orthonormality of Q
                 k = curr_sz;
-                free(A_cpy);
-                free(QtQi);
                 return 5;
             }
         }
@@ -250,8 +324,6 @@ int QB<T, RNG>::call(
         if (approx_err < tol) {
             // Reached the required error tol
             k = curr_sz;
-            free(A_cpy);
-            free(QtQi);
             return 0;
         }
 
@@ -260,9 +332,6 @@ int QB<T, RNG>::call(
         blas::gemm(Layout::ColMajor, Op::NoTrans, Op::Trans, m, n, b_sz, -1.0, Q_i, m, BT_i, n, 1.0, A_cpy, m);
     }
 
-    free(A_cpy);
-    free(QtQi);
-
     // Reached expected rank without achieving the tolerance
     return 3;
 }
@@ -100,6 +100,7 @@ class RF : public RangeFinder<T, RNG> {
 
        // Implementation-specific vars
        std::vector<T> cond_nums; // Condition nubers of sketches
+       std::vector<T> Omega;     // Sketching operator buffer, reused across calls
 };
 
 // -----------------------------------------------------------------------------
@@ -113,12 +114,10 @@ int RF<T, RNG>::call(
     RandBLAS::RNGState<RNG> &state
 ){
 
-    T* Omega  = ( T * ) calloc( n * k, sizeof( T ) );
+    T* Omega  = util::upsize(n * k, this->Omega);
 
-    if(this->RS_Obj.call(m, n, A, k, Omega, state)) {
-        free(Omega);
+    if(this->RS_Obj.call(m, n, A, k, Omega, state))
         return 1;
-    }
 
     // Q = orth(A * Omega)
     blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, m, k, n, 1.0, A, m, Omega, n, 0.0, Q, m);
@@ -131,7 +130,6 @@ int RF<T, RNG>::call(
         return 2; // Orthogonalization failed
 
     // Normal termination
-    free(Omega);
     return 0;
 }
 
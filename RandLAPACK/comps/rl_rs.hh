@@ -110,6 +110,7 @@ class RS : public RowSketcher<T, RNG>
         bool verbose;
         bool cond_check;
         std::vector<T> cond_nums;
+        std::vector<T> Omega_1; // Buffer for A * Omega, reused across calls
 };
 
 // -----------------------------------------------------------------------------
@@ -127,7 +128,7 @@ int RS<T, RNG>::call(
     int64_t q = this->passes_per_stab;
     int64_t p_done= 0;
 
-    T* Omega_1  = ( T * ) calloc( m * k, sizeof( T ) );
+    T* Omega_1  = util::upsize(m * k, this->Omega_1);
 
     if (p % 2 == 0) {
         // Fill n by k Omega
@@ -168,7 +169,6 @@ int RS<T, RNG>::call(
             return 1;
     }
 
-    free(Omega_1);
     //successful termination
     return 0;
 }
@@ -0,0 +1,238 @@
+#pragma once
+
+#include "rl_blaspp.hh"
+#include "rl_lapackpp.hh"
+#include "rl_util.hh"
+
+#include <RandBLAS.hh>
+#include <cstdint>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+namespace RandLAPACK {
+
+/// QR with column pivoting of a short, wide sketch, as used by CQRRPT, CQRRP_blocked and hqrrp.
+///
+/// Computes A_sk[:, J] = QR for a d-by-n sketch A_sk, with the output formatted like that of GEQP3:
+/// R overwrites the upper trapezoid of A_sk, the Householder vectors of Q are stored below it,
+/// with their scalar factors in tau (of length min(d, n)), and J receives 1-based column indices.
+/// Only the leading pivots have to be rank-revealing; the drivers use at most min(d, n) of them.
+///
+/// Both precisions are supported, since the sketch may be kept in single precision
+/// while the driver runs in double.
+class SketchQRCP {
+    public:
+        virtual ~SketchQRCP() {}
+
+        virtual int call(
+            int64_t d,
+            int64_t n,
+            double* A_sk,
+            int64_t lda,
+            int64_t* J,
+            double* tau
+        ) = 0;
+
+        virtual int call(
+            int64_t d,
+            int64_t n,
+            float* A_sk,
+            int64_t lda,
+            int64_t* J,
+            float* tau
+        ) = 0;
+};
+
+/// QRCP of the sketch with LAPACK's GEQP3.
+class GEQP3_QRCP : public SketchQRCP {
+    public:
+        int call(int64_t d, int64_t n, double* A_sk, int64_t lda, int64_t* J, double* tau) override {
+            return this->qrcp(d, n, A_sk, lda, J, tau);
+        }
+
+        int call(int64_t d, int64_t n, float* A_sk, int64_t lda, int64_t* J, float* tau) override {
+            return this->qrcp(d, n, A_sk, lda, J, tau);
+        }
+
+    private:
+        template <typename T>
+        int qrcp(
+            int64_t d,
+            int64_t n,
+            T* A_sk,
+            int64_t lda,
+            int64_t* J,
+            T* tau
+        ) {
+            // Nonzero entries of J would mark leading columns for GEQP3.
+            std::fill(J, &J[n], 0);
+            lapack::geqp3(d, n, A_sk, lda, J, tau);
+            return 0;
+        }
+};
+
+/// QRCP of the sketch through a pivoted LU, as in CQRRP_blocked:
+///     A_sk[:, J] = L * U, L = Q * R_L, R = R_L * U.
+/// The pivots are found along the rows of A_sk (see util::getrf_col_piv), so that
+/// most of the work is done in BLAS-3, unlike in GEQP3. Not intended for rank-deficient sketches.
+class LUQR_QRCP : public SketchQRCP {
+    public:
+        int call(int64_t d, int64_t n, double* A_sk, int64_t lda, int64_t* J, double* tau) override {
+            return this->qrcp(d, n, A_sk, lda, J, tau, this->L_d);
+        }
+
+        int call(int64_t d, int64_t n, float* A_sk, int64_t lda, int64_t* J, float* tau) override {
+            return this->qrcp(d, n, A_sk, lda, J, tau, this->L_f);
+        }
+
+    private:
+        // Buffers for the L-factor, reused across calls
+        std::vector<double> L_d;
+        std::vector<float>  L_f;
+
+        template <typename T>
+        int qrcp(
+            int64_t d,
+            int64_t n,
+            T* A_sk,
+            int64_t lda,
+            int64_t* J,
+            T* tau,
+            std::vector<T> &L_buf
+        ) {
+            int64_t k = std::min(d, n);
+            T* L = util::upsize(d * k, L_buf);
+
+            util::getrf_col_piv(d, n, A_sk, lda, J);
+
+            // L is moved out of A_sk, and U, with its unit diagonal, is made explicit in its place.
+            for(int64_t j = 0; j < k; ++j) {
+                std::fill(&L[d * j], &L[d * j + j], (T) 0.0);
+                blas::copy(d - j, &A_sk[lda * j + j], 1, &L[d * j + j], 1);
+                std::fill(&A_sk[lda * j + j + 1], &A_sk[lda * j + d], (T) 0.0);
+                A_sk[lda * j + j] = (T) 1.0;
+            }
+            lapack::geqrf(d, k, L, d, tau);
+            blas::trmm(Layout::ColMajor, Side::Left, Uplo::Upper, Op::NoTrans, Diag::NonUnit, k, n, (T) 1.0, L, d, A_sk, lda);
+            // Q is that of L.
+            if(d > 1)
+                lapack::lacpy(MatrixType::Lower, d - 1, k, &L[1], d, &A_sk[1], lda);
+            return 0;
+        }
+};
+
+/// QRCP of the sketch with tournament pivoting, as in communication-avoiding QRCP
+/// (https://doi.org/10.1137/13092157X).
+///
+/// The columns of A_sk are split into groups of 'group_cols' columns (0, the default, picks 2 * k),
+/// and k = min(d, n, num_pivots) candidate pivots are chosen in every group by GEQP3 on a copy of it
+/// (num_pivots = 0, the default, means no limit). The candidates then compete in groups of the same size,
+/// until a single group is left, whose k winners are the leading pivots. The remaining columns
+/// keep their original order, and R comes from an unpivoted QR of the permuted sketch.
+///
+/// The groups at every level of the tournament are factored in parallel, so this backend pays off
+/// when n is much larger than d, where GEQP3 on the whole sketch runs mostly in serial BLAS-2.
+/// With n <= 2 * k, it reduces to GEQP3.
+class Tournament_QRCP : public SketchQRCP {
+    public:
+        Tournament_QRCP() {
+            group_cols = 0;
+            num_pivots = 0;
+        }
+
+        int call(int64_t d, int64_t n, double* A_sk, int64_t lda, int64_t* J, double* tau) override {
+            return this->qrcp(d, n, A_sk, lda, J, tau, this->buf_d);
+        }
+
+        int call(int64_t d, int64_t n, float* A_sk, int64_t lda, int64_t* J, float* tau) override {
+            return this->qrcp(d, n, A_sk, lda, J, tau, this->buf_f);
+        }
+
+    public:
+        // Number of columns in a group
+        int64_t group_cols;
+
+        // Number of leading pivots that are selected by the tournament
+        int64_t num_pivots;
+
+    private:
+        // Copies of the groups and their pivots, reused across calls
+        std::vector<double>  buf_d;
+        std::vector<float>   buf_f;
+        std::vector<int64_t> cand;
+        std::vector<int64_t> winners;
+        std::vector<int64_t> J_grp;
+        std::vector<int64_t> J_work;
+
+        template <typename T>
+        int qrcp(
+            int64_t d,
+            int64_t n,
+            T* A_sk,
+            int64_t lda,
+            int64_t* J,
+            T* tau,
+            std::vector<T> &buf
+        ) {
+            int64_t k = std::min(d, n);
+            if(this->num_pivots > 0)
+                k = std::min(k, this->num_pivots);
+            int64_t gs = std::max(this->group_cols > 0 ? this->group_cols : 2 * k, k + 1);
+
+            if(n <= gs) {
+                std::fill(J, &J[n], 0);
+                lapack::geqp3(d, n, A_sk, lda, J, tau);
+                return 0;
+            }
+
+            // Every group holds at most gs columns, its tau at most gs entries.
+            T* A_grp = util::upsize(d * n + n, buf);
+            T* tau_grp = &A_grp[d * n];
+            int64_t* cand    = util::upsize(n, this->cand);
+            int64_t* winners = util::upsize(n, this->winners);
+            int64_t* J_grp   = util::upsize(n, this->J_grp);
+            int64_t num_cand = n;
+            std::iota(cand, &cand[n], 0);
+
+            while(true) {
+                int64_t num_groups = (num_cand + gs - 1) / gs;
+
+                #pragma omp parallel for schedule(dynamic)
+                for(int64_t g = 0; g < num_groups; ++g) {
+                    int64_t c0 = g * gs;
+                    int64_t w  = std::min(gs, num_cand - c0);
+                    T* A_g     = &A_grp[d * c0];
+                    int64_t* J_g = &J_grp[c0];
+                    for(int64_t j = 0; j < w; ++j)
+                        blas::copy(d, &A_sk[lda * cand[c0 + j]], 1, &A_g[d * j], 1);
+                    std::fill(J_g, &J_g[w], 0);
+                    lapack::geqp3(d, w, A_g, d, J_g, &tau_grp[c0]);
+                    // Winners of group g go into slots [g * k, g * k + min(k, w)).
+                    for(int64_t j = 0; j < std::min(k, w); ++j)
+                        winners[g * k + j] = cand[c0 + J_g[j] - 1];
+                }
+
+                num_cand = (num_groups - 1) * k + std::min(k, num_cand - (num_groups - 1) * gs);
+                std::copy(winners, &winners[num_cand], cand);
+                if(num_groups == 1)
+                    break;
+            }
+
+            // The k winners lead, the rest of the columns follow in their original order.
+            std::fill(J_grp, &J_grp[n], 0);
+            for(int64_t j = 0; j < k; ++j) {
+                J[j] = cand[j] + 1;
+                J_grp[cand[j]] = 1;
+            }
+            for(int64_t j = 0, pos = k; j < n; ++j)
+                if(!J_grp[j])
+                    J[pos++] = j + 1;
+
+            util::col_swap(d, n, n, A_sk, lda, J, util::upsize(n, this->J_work));
+            lapack::geqrf(d, n, A_sk, lda, tau);
+            return 0;
+        }
+};
+
+} // end namespace RandLAPACK
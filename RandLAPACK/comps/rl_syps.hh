@@ -4,6 +4,7 @@
 #include "rl_lapackpp.hh"
 #include "rl_orth.hh"
 #include "rl_util.hh"
+#include "rl_lapack_work.hh"
 #include "rl_linops.hh"
 
 #include <RandBLAS.hh>
@@ -120,6 +121,7 @@ class SYPS : public SymmetricPowerSketch<T, RNG> {
         bool verbose;
         bool cond_check;
         std::vector<T> cond_nums;
+        std::vector<lapack_int> ipiv; // Buffer for the LU pivots, reused across calls
 };
 
 // -----------------------------------------------------------------------------
@@ -149,20 +151,19 @@ int SYPS<T, RNG>::call(
 
     T *symm_out = work_buff;
     T *symm_in  = skop_buff;
-    int64_t* ipiv = new int64_t[m]{};
+    lapack_int* ipiv = util::upsize(m, this->ipiv);
     while (p - p_done > 0) {
         A(Layout::ColMajor, k, 1.0, symm_in, m, 0.0, symm_out, m);
         ++p_done;
         if (p_done % q == 0) {
-                if(lapack::getrf(m, k, symm_out, m, ipiv))
+                if(util::getrf(m, k, symm_out, m, ipiv))
                     throw std::runtime_error("Sketch did not have an LU decomposition.");
                 util::get_L(m, k, symm_out, 1);
-                lapack::laswp(k, symm_out, m, 1, k, ipiv, 1);
+                util::laswp(k, symm_out, m, 1, k, ipiv, 1);
         }
         symm_out = (p_done % 2 == 1) ? skop_buff : work_buff;
         symm_in  = (p_done % 2 == 1) ? work_buff : skop_buff; 
     }
-    delete[] ipiv;
     if (p % 2 == 1)
         blas::copy(m * k, work_buff, 1, skop_buff, 1);
 
@@ -1,15 +1,19 @@
 #pragma once
 
 #include "rl_util.hh"
+#include "rl_lapack_work.hh"
 #include "rl_blaspp.hh"
 #include "rl_lapackpp.hh"
 #include "rl_hqrrp.hh"
+#include "rl_sketch_qrcp.hh"
 
 #include <RandBLAS.hh>
+#include <type_traits>
 #include <cstdint>
 #include <vector>
 #include <chrono>
 #include <numeric>
+#include <future>
 
 using namespace std::chrono;
 
@@ -49,6 +53,29 @@ class CQRRP_blocked : public CQRRPalg<T, RNG> {
         ///     2. Applying Q-factor from Cholesky QR to the working area of matrix A (done via gemqrt).
         ///
         /// The algorithm optionally times all of its subcomponents through a user-defined 'timing' parameter.
+        ///
+        /// For T = double, the sketch and its QRCP may be kept in single precision through 'use_mixed_precision'
+        /// parameter, which defaults to false. The sketch is then formed from float copies of cache-sized row panels of A,
+        /// and the blocks of R that update it are converted to float. Preconditioning, Cholesky QR, updating A
+        /// and the R-factor remain in double precision.
+        ///
+        /// The d-by-m Gaussian sketching operator is never formed in full: it is generated 'sketch_tile_cols'
+        /// columns at a time (0, the default, picks 2048), and every tile is applied to the matching rows of A.
+        /// With several tiles and threads, one thread of the OpenMP team generates the next tile while the others
+        /// apply the current one. The tiles are bit-identical to the columns of the full operator.
+        ///
+        /// With 'use_lookahead' (false by default), the rows of R12 are found first, as Q_econ' * A(:, b_sz:end).
+        /// Updating the sketch and the QRCP on it for the next iteration then run on 'lookahead_threads'
+        /// threads (0 picks a quarter of them), alongside the update of the rest of A on the remaining threads.
+        /// With fewer than two OpenMP threads available, there is nothing to overlap, and the lookahead is not done.
+        ///
+        /// In 'truncated' mode (false by default), the algorithm stops as soon as ||A_work||_F <= eps * ||A||_F,
+        /// or once 'max_rank' columns have been factored (0, the default, means no cap), whichever happens first.
+        /// Both norms are estimated from the sketch, which costs O(d * n) per iteration. On exit, the leading
+        /// 'rank' rows of R and the Householder vectors of Q are as usual, while the rows of A below R are not updated.
+        ///
+        /// The QRCP of the sketch may be replaced by any SketchQRCP through 'QRCP_Obj' (nullptr by default).
+        /// The workspace then does not cover the buffers of that QRCP, which are managed by the object itself.
 
 
         CQRRP_blocked(
@@ -69,6 +96,13 @@ class CQRRP_blocked : public CQRRPalg<T, RNG> {
             use_gemqrt   = false;
             internal_nb  = b_sz;
             tol = std::numeric_limits<T>::epsilon();
+            use_mixed_precision = false;
+            sketch_tile_cols = 0;
+            use_lookahead = false;
+            lookahead_threads = 0;
+            truncated = false;
+            max_rank  = 0;
+            QRCP_Obj = nullptr;
         }
 
         /// Computes a QR factorization with column pivots of the form:
@@ -120,6 +154,32 @@ class CQRRP_blocked : public CQRRPalg<T, RNG> {
             RandBLAS::RNGState<RNG> &state
         ) override;
 
+        /// Returns the size (in bytes) of the workspace that the call() overload below
+        /// requires for an m by n input and a given d_factor, with the current block size.
+        int64_t workspace_query(
+            int64_t m,
+            int64_t n,
+            T d_factor
+        );
+
+        /// Same as above, but all internal buffers are placed into a caller-owned workspace
+        /// of at least workspace_query(m, n, d_factor) bytes, aligned to 64 bytes, including the work arrays
+        /// of the LAPACK routines it calls. No heap allocations are made by the algorithm itself,
+        /// so repeated calls on same-sized problems can reuse one workspace. The one exception is 'use_lookahead',
+        /// which starts a helper thread at every iteration; 'QRCP_Obj' is responsible for its own allocations.
+        int call(
+            int64_t m,
+            int64_t n,
+            T* A,
+            int64_t lda,
+            T d_factor,
+            T* tau,
+            int64_t* J,
+            RandBLAS::RNGState<RNG> &state,
+            void* work,
+            int64_t work_bytes
+        );
+
     public:
         bool timing;
         bool cond_check;
@@ -134,6 +194,9 @@ class CQRRP_blocked : public CQRRPalg<T, RNG> {
         // QRCP option
         bool use_qp3;
 
+        // QRCP of the sketch, used instead of the built-in ones when set
+        SketchQRCP* QRCP_Obj;
+
         // Option for updating A
         bool use_gemqrt;
 
@@ -142,8 +205,118 @@ class CQRRP_blocked : public CQRRPalg<T, RNG> {
 
         // Naive rank estimation parameter;
         T tol;
+
+        // Mixed precision option (T = double only)
+        bool use_mixed_precision;
+
+        // Number of columns in a tile of the sketching operator
+        int64_t sketch_tile_cols;
+
+        // Option for overlapping the sketch QRCP with updating A
+        bool use_lookahead;
+
+        // Number of threads working on the sketch while A is being updated
+        int lookahead_threads;
+
+        // Truncated mode, stopping at a relative residual of eps or at max_rank columns
+        bool truncated;
+
+        // Rank cap in truncated mode (0 means none)
+        int64_t max_rank;
+
+    private:
+        /// Number of columns of the sketching operator generated at a time.
+        int64_t sketch_tile_width(
+            int64_t m
+        ) {
+            return std::min(m, this->sketch_tile_cols > 0 ? this->sketch_tile_cols : (int64_t) 2048);
+        }
+
+        /// Size of the work array of the LAPACK routines in the QRCP of a d-by-n sketch.
+        /// It is kept apart from the one for updating A, since the two may run at the same time.
+        template <typename T_sk>
+        int64_t sketch_qr_work_size(
+            int64_t d,
+            int64_t n
+        ) {
+            int64_t lwork = util::geqrf_work_size<T_sk>(d, std::min(d, n));
+            if(this->use_qp3)
+                lwork = std::max(lwork, util::geqp3_work_size<T_sk>(d, n));
+            return lwork;
+        }
+
+        /// Size of the work array for applying Q' to the trailing columns of an m-by-n A.
+        int64_t update_work_size(
+            int64_t m,
+            int64_t n
+        ) {
+            if(this->use_gemqrt)
+                return util::gemqrt_work_size<T>(Side::Left, m, n, this->internal_nb);
+            return util::ormqr_work_size<T>(Side::Left, Op::Trans, m, n, std::min(this->block_size, m));
+        }
+
+        /// Whether the sketch is kept in single precision.
+        bool sketch_in_float() {
+            return this->use_mixed_precision && std::is_same_v<T, double>;
+        }
+
+        #if !defined(__APPLE__)
+        /// The algorithm itself, with the sketch stored in precision T_sk.
+        template <typename T_sk>
+        int call_impl(
+            int64_t m,
+            int64_t n,
+            T* A,
+            int64_t lda,
+            T d_factor,
+            T* tau,
+            int64_t* J,
+            RandBLAS::RNGState<RNG> &state,
+            void* work,
+            int64_t work_bytes
+        );
+        #endif
 };
 
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int64_t CQRRP_blocked<T, RNG>::workspace_query(
+    int64_t m,
+    int64_t n,
+    T d_factor
+){
+    int64_t b_sz = this->block_size;
+    int64_t d    = d_factor * b_sz;
+    int64_t tile_cols = this->sketch_tile_width(m);
+
+    int64_t work_bytes = util::workspace_bytes<int64_t>(n)                    // J_buffer
+                       + util::workspace_bytes<int64_t>(n)                    // J_buffer_work
+                       + util::workspace_bytes<T>(b_sz * b_sz)                // R_cholqr
+                       + util::workspace_bytes<T>(b_sz * b_sz)                // T_dat
+                       + util::workspace_bytes<T>(n)                          // Work2
+                       + util::workspace_bytes<T>(this->update_work_size(m, n));   // upd_work
+
+    if(this->use_lookahead || this->truncated)
+        work_bytes += util::workspace_bytes<T>(b_sz * n);                     // R12_la
+
+    if(this->sketch_in_float()) {
+        work_bytes += util::workspace_bytes<float>(d * n)                     // A_sk
+                    + util::workspace_bytes<float>(d * std::min(d, n))        // L_sk
+                    + util::workspace_bytes<float>(n)                         // tau_sk
+                    + util::workspace_bytes<T>(b_sz * b_sz)                   // R_pre
+                    + util::workspace_bytes<float>(b_sz * n)                  // R_upd
+                    + util::workspace_bytes<float>(d * tile_cols) * 2         // S tiles
+                    + util::workspace_bytes<float>(tile_cols * n)             // A_panel
+                    + util::workspace_bytes<float>(this->template sketch_qr_work_size<float>(d, n));   // qr_work_sk
+    } else {
+        work_bytes += util::workspace_bytes<T>(d * n)                         // A_sk
+                    + util::workspace_bytes<T>(d * std::min(d, n))            // L_sk
+                    + util::workspace_bytes<T>(d * tile_cols) * 2             // S tiles
+                    + util::workspace_bytes<T>(this->template sketch_qr_work_size<T>(d, n));           // qr_work_sk
+    }
+    return work_bytes;
+}
+
 // We are assuming that tau and J have been pre-allocated
 // -----------------------------------------------------------------------------
 template <typename T, typename RNG>
@@ -161,6 +334,56 @@ int CQRRP_blocked<T, RNG>::call(
     UNUSED(m); UNUSED(n); UNUSED(A); UNUSED(lda); UNUSED(d_factor); UNUSED(tau); UNUSED(J); UNUSED(state);
     throw std::runtime_error("CQRRP is not supported when BLAS is linked against Apple Accelerate.");
     #else
+    int64_t work_bytes = this->workspace_query(m, n, d_factor);
+    void* work = util::workspace_alloc(work_bytes);
+
+    int info = this->call(m, n, A, lda, d_factor, tau, J, state, work, work_bytes);
+
+    free(work);
+    return info;
+    #endif
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int CQRRP_blocked<T, RNG>::call(
+    int64_t m,
+    int64_t n,
+    T* A,
+    int64_t lda,
+    T d_factor,
+    T* tau,
+    int64_t* J,
+    RandBLAS::RNGState<RNG> &state,
+    void* work,
+    int64_t work_bytes
+){
+    #ifdef __APPLE__
+    UNUSED(m); UNUSED(n); UNUSED(A); UNUSED(lda); UNUSED(d_factor); UNUSED(tau); UNUSED(J); UNUSED(state); UNUSED(work); UNUSED(work_bytes);
+    throw std::runtime_error("CQRRP is not supported when BLAS is linked against Apple Accelerate.");
+    #else
+    if(this->sketch_in_float())
+        return this->template call_impl<float>(m, n, A, lda, d_factor, tau, J, state, work, work_bytes);
+    return this->template call_impl<T>(m, n, A, lda, d_factor, tau, J, state, work, work_bytes);
+    #endif
+}
+
+#if !defined(__APPLE__)
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+template <typename T_sk>
+int CQRRP_blocked<T, RNG>::call_impl(
+    int64_t m,
+    int64_t n,
+    T* A,
+    int64_t lda,
+    T d_factor,
+    T* tau,
+    int64_t* J,
+    RandBLAS::RNGState<RNG> &state,
+    void* work,
+    int64_t work_bytes
+){
     //-------TIMING VARS--------/
     high_resolution_clock::time_point preallocation_t_stop;
     high_resolution_clock::time_point preallocation_t_start;
@@ -249,14 +472,14 @@ int CQRRP_blocked<T, RNG>::call(
     //*******************POINTERS TO DATA REQUIRING ADDITIONAL STORAGE BEGIN*******************
     // BELOW ARE MATRICES THAT WE CANNOT PUT INTO COMMON BUFFERS
 
+    // All of the buffers below are placed into the caller-provided workspace.
+    util::Workspace ws(work, work_bytes);
+
     // J_buffer serves as a buffer for the pivots found at every iteration, of size n.
     // At every iteration, it would only hold "cols" entries.
-    // Cannot really fully switch this to pointers bc we do not want data to be modified in "col_swap."
-    std::vector<int64_t> J_buf (n, 0);
-    int64_t* J_buffer = J_buf.data();
-    // Special pivoting buffer for LU factorization, capturing the swaps on A_sk'.
-    // Needs to be converted in a proper format of length rows(A_sk')
-    int64_t* J_buffer_lu = ( int64_t * ) calloc( std::min(d, n), sizeof( int64_t ) );
+    int64_t* J_buffer = ws.take<int64_t>(n, true);
+    // Scratch space for "col_swap," so that J_buffer itself is never modified by it.
+    int64_t* J_buffer_work = ws.take<int64_t>(n);
 
     // A_sk serves as a skething matrix, of size d by n, lda d
     // Below algorithm does not perform repeated sampling, hence A_sk
@@ -264,14 +487,12 @@ int CQRRP_blocked<T, RNG>::call(
     // Should remain unchanged throughout the algorithm,
     // As the algorithm needs to have access to the upper-triangular factor R
     // (stored in this matrix after geqp3) at all times. 
-    T* A_sk = ( T * ) calloc( d * n, sizeof( T ) );
-    // Create a separate pointer to free when function terminates
-    T* A_sk_const = A_sk;
+    T_sk* A_sk = ws.take<T_sk>(d * n);
     // Pointer to the b_sz by b_sz upper-triangular facor R stored in A_sk after GEQP3.
-    T* R_sk = NULL;
-    // View to the transpose of A_sk.
-    // Is of size n * d, with an lda n.
-    T* A_sk_trans = ( T * ) calloc( n * d, sizeof( T ) );
+    T_sk* R_sk = NULL;
+    // Buffer for the L-factor from the pivoted LU on A_sk.
+    // Is of size d * min(d, n), with an lda d.
+    T_sk* L_sk = ws.take<T_sk>(d * std::min(d, n));
 
     // Buffer for the R-factor in Cholesky QR, of size b_sz by b_sz, lda b_sz.
     // Also used to store the proper R11_full-factor after the 
@@ -279,14 +500,117 @@ int CQRRP_blocked<T, RNG>::call(
     // That is done by applying the sign vector D from orhr_col().
     // Eventually, will be used to store R11 (computed via trmm)
     // which is then copied into its appropriate space in the matrix A.
-    T* R_cholqr = ( T * ) calloc( b_sz_const * b_sz_const, sizeof( T ) );
+    T* R_cholqr = ws.take<T>(b_sz_const * b_sz_const, true);
     // Pointer to matrix T from orhr_col at currect iteration, will point to Work2 space.
-    T* T_dat    = ( T * ) calloc( b_sz_const * b_sz_const, sizeof( T ) );
+    T* T_dat    = ws.take<T>(b_sz_const * b_sz_const, true);
 
     // Buffer for Tau in GEQP3 and D in orhr_col, of size n.
-    T* Work2    = ( T * ) calloc( n, sizeof( T ) );
+    T* Work2    = ws.take<T>(n, true);
+
+    // Work array of ORMQR or GEMQRT when applying Q' to A.
+    int64_t lwork_upd = this->update_work_size(m, n);
+    T* upd_work       = ws.take<T>(lwork_upd);
+
+    // Buffers for moving data between the sketch, stored in precision T_sk, and A.
+    // If the precisions coincide, no extra space is needed.
+    // Buffer for Tau in QRCP on the sketch, of size n.
+    T_sk* tau_sk   = NULL;
+    // R_sk in precision T, used for preconditioning and for computing R11, of size b_sz by b_sz.
+    T* R_pre       = NULL;
+    int64_t ld_pre = d;
+    // Rows of R11 and R12 in precision T_sk, used for updating the sketch, of size b_sz by n.
+    T_sk* R_upd    = NULL;
+    if constexpr (std::is_same_v<T_sk, T>) {
+        tau_sk = Work2;
+    } else {
+        tau_sk = ws.take<T_sk>(n, true);
+        R_pre  = ws.take<T>(b_sz_const * b_sz_const, true);
+        ld_pre = b_sz_const;
+        R_upd  = ws.take<T_sk>(b_sz_const * n);
+    }
+    // Work array of GEQRF or GEQP3 in the QRCP of the sketch.
+    int64_t lwork_sk = this->template sketch_qr_work_size<T_sk>(d, n);
+    T_sk* qr_work_sk = ws.take<T_sk>(lwork_sk);
+    // Threshold for naive rank estimation cannot be below the precision of the sketch.
+    T tol_rank = this -> tol;
+    if constexpr (!std::is_same_v<T_sk, T>)
+        tol_rank = std::max(tol_rank, (T) std::numeric_limits<T_sk>::epsilon());
+
+    // With lookahead or truncation, R12 is computed ahead of updating A, of size b_sz by n, lda b_sz.
+    T* R12_la = NULL;
+    if(this -> use_lookahead || this -> truncated)
+        R12_la = ws.take<T>(b_sz_const * n);
+    // Whether the QRCP of the sketch for the current iteration has been done at the end of the previous one.
+    bool sketch_factored = false;
+    // Thread counts for the sketch and for updating A when these are overlapped; at least one is left for each.
+    int threads_total = util::max_threads();
+    int threads_sk    = this -> lookahead_threads > 0 ? this -> lookahead_threads : threads_total / 4;
+    threads_sk        = std::max(1, std::min(threads_sk, threads_total - 1));
+    int threads_upd   = std::max(1, threads_total - threads_sk);
     //*******************POINTERS TO DATA REQUIRING ADDITIONAL STORAGE END*******************
 
+    // QRCP on the active sketch_rows by sketch_cols portion of A_sk.
+    auto qrcp_sketch = [&](int64_t sketch_rows, int64_t sketch_cols) {
+        // Zero-out data - may not be necessary
+        std::fill(&J_buffer[0], &J_buffer[n], 0);
+        std::fill(&Work2[0], &Work2[n], (T) 0.0);
+
+        if (this -> QRCP_Obj != nullptr) {
+            this -> QRCP_Obj -> call(sketch_rows, sketch_cols, A_sk, d, J_buffer, tau_sk);
+        } else if (this -> use_qp3) {
+            util::geqp3(sketch_rows, sketch_cols, A_sk, d, J_buffer, tau_sk, qr_work_sk, lwork_sk);
+        } else {
+            // Perform pivoted LU on A_sk, A_sk[:, J] = L * U, with pivots chosen along the rows of A_sk.
+            util::getrf_col_piv(sketch_rows, sketch_cols, A_sk, d, J_buffer);
+
+            // The R-factor of A_sk[:, J] is R_L * U, where L = Q * R_L is an unpivoted QR of L.
+            // L is moved out of A_sk, and U, with its unit diagonal, is made explicit in its place.
+            int64_t k = std::min(sketch_rows, sketch_cols);
+            for(int64_t j = 0; j < k; ++j) {
+                std::fill(&L_sk[d * j], &L_sk[d * j + j], (T_sk) 0.0);
+                blas::copy(sketch_rows - j, &A_sk[d * j + j], 1, &L_sk[d * j + j], 1);
+                std::fill(&A_sk[d * j + j + 1], &A_sk[d * j + sketch_rows], (T_sk) 0.0);
+                A_sk[d * j + j] = (T_sk) 1.0;
+            }
+            // Perform an unpivoted QR on L
+            util::geqrf(sketch_rows, k, L_sk, d, tau_sk, qr_work_sk, lwork_sk);
+            blas::trmm(Layout::ColMajor, Side::Left, Uplo::Upper, Op::NoTrans, Diag::NonUnit, k, sketch_cols, (T_sk) 1.0, L_sk, d, A_sk, d);
+        }
+    };
+
+    // Updating the skethcing buffer, given R11 and R12 of the current iteration.
+    // Moves A_sk to the portion of the sketch that is active at the next iteration.
+    auto update_sketch = [&](const T* R11_in, int64_t ld11, const T* R12_in, int64_t ld12) {
+        // trsm (R_sk, R11) -> R_sk
+        // Clearing the lower-triangular portion here is necessary, if there is a more elegant way, need to use that.
+        RandLAPACK::util::get_U(b_sz, b_sz, R_sk, d);
+        // R_sk_12 - R_sk_11 * inv(R_11) * R_12
+        // Side note: might need to be careful when d = b_sz.
+        // Cannot perform trmm here as an alternative, since matrix difference is involved.
+        if constexpr (std::is_same_v<T_sk, T>) {
+            blas::trsm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, b_sz, b_sz, (T) 1.0, R11_in, ld11, R_sk, d);
+            blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, b_sz, cols - b_sz, b_sz, (T) -1.0, R_sk, d, R12_in, ld12, (T) 1.0, &R_sk[d * b_sz], d);
+        } else {
+            util::lacpy_convert(MatrixType::General, b_sz, b_sz, R11_in, ld11, R_upd, b_sz_const);
+            util::lacpy_convert(MatrixType::General, b_sz, cols - b_sz, R12_in, ld12, &R_upd[b_sz_const * b_sz], b_sz_const);
+            blas::trsm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, b_sz, b_sz, (T_sk) 1.0, R_upd, b_sz_const, R_sk, d);
+            blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, b_sz, cols - b_sz, b_sz, (T_sk) -1.0, R_sk, d, &R_upd[b_sz_const * b_sz], b_sz_const, (T_sk) 1.0, &R_sk[d * b_sz], d);
+        }
+        
+        // Changing the sampling dimension parameter
+        sampling_dimension = std::min(sampling_dimension, cols);
+
+        // Need to zero out the lower triangular portion of R_sk_22
+        // Make sure R_sk_22 exists.
+        if (sampling_dimension - b_sz > 0)
+            RandLAPACK::util::get_U(sampling_dimension - b_sz, sampling_dimension - b_sz, &R_sk[(d + 1) * b_sz], d);
+
+        // Changing the pointer to relevant data in A_sk - this is equaivalent to copying data over to the beginning of A_sk.
+        // Remember that the only "active" portion of A_sk remaining would be of size sampling_dimension by cols;
+        // if any rows beyond that would be accessed, we would have issues. 
+        A_sk = &A_sk[d * b_sz];
+    };
+
     if(this -> timing) {
         preallocation_t_stop  = high_resolution_clock::now();
         preallocation_t_dur   = duration_cast<microseconds>(preallocation_t_stop - preallocation_t_start).count();
@@ -296,53 +620,142 @@ int CQRRP_blocked<T, RNG>::call(
     // Using Gaussian matrix as a sketching operator.
     // Using a sparse sketching operator may be dangerous if LU-based QRCP is in use,
     // as LU is not intended to be used with rank-deficient matrices.
-    T* S  = ( T * ) calloc( d * m, sizeof( T ) );
-    RandBLAS::DenseDist D(d, m);
-    state = RandBLAS::fill_dense(D, S, state).second;
-    blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, d, n, m, 1.0, S, d, A, m, 0.0, A_sk, d);
-    free(S);
+    // S = [S_1, ..., S_t] is generated one column tile at a time, and A_sk = sum_i S_i * A_i is accumulated
+    // over the matching row blocks of A.
+    int64_t tile_cols = this->sketch_tile_width(m);
+    int64_t num_tiles = (m + tile_cols - 1) / tile_cols;
+    T_sk* S_tiles[2]  = {ws.take<T_sk>(d * tile_cols), ws.take<T_sk>(d * tile_cols)};
+    // Row block of A converted to T_sk
+    T_sk* A_panel     = NULL;
+    if constexpr (!std::is_same_v<T_sk, T>)
+        A_panel = ws.take<T_sk>(tile_cols * n);
+
+    auto fill_tile = [&](int64_t t) {
+        int64_t col_start = t * tile_cols;
+        return util::fill_dense_cols(d, m, col_start, std::min(tile_cols, m - col_start), S_tiles[t % 2], state);
+    };
+    // Accumulates S_t * A_t into columns [col_start, col_start + cols) of A_sk.
+    auto apply_tile = [&](int64_t t, int64_t col_start, int64_t cols) {
+        int64_t row_start = t * tile_cols;
+        int64_t tile_rows = std::min(tile_cols, m - row_start);
+        if constexpr (std::is_same_v<T_sk, T>) {
+            blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, d, cols, tile_rows, (T) 1.0, S_tiles[t % 2], d, &A[row_start + lda * col_start], lda, (T) (t > 0), &A_sk[d * col_start], d);
+        } else {
+            util::lacpy_convert(MatrixType::General, tile_rows, cols, &A[row_start + lda * col_start], lda, &A_panel[tile_cols * col_start], tile_cols);
+            blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, d, cols, tile_rows, (T_sk) 1.0, S_tiles[t % 2], d, &A_panel[tile_cols * col_start], tile_cols, (T_sk) (t > 0), &A_sk[d * col_start], d);
+        }
+    };
+
+    // Every tile returns the state that follows the entire S.
+    RandBLAS::RNGState<RNG> state_next = state;
+    int64_t threads_total = util::max_threads();
+    if(num_tiles == 1 || threads_total == 1) {
+        for(int64_t t = 0; t < num_tiles; ++t) {
+            state_next = fill_tile(t);
+            apply_tile(t, 0, n);
+        }
+    } else {
+        // Thread 0 generates tile t + 1 while the rest of the team applies tile t, each to its own
+        // column block of A. The team is reused for all tiles, and BLAS runs on one thread per block.
+        #pragma omp parallel num_threads(threads_total)
+        {
+            #if defined(_OPENMP)
+            int64_t tid = omp_get_thread_num();
+            int64_t nt  = omp_get_num_threads();
+            omp_set_num_threads(1);
+            #else
+            int64_t tid = 0;
+            int64_t nt  = 1;
+            #endif
+            // The team may have fewer threads than requested; a lone thread does both jobs in turn.
+            int64_t num_appliers = std::max(nt - 1, (int64_t) 1);
+            int64_t applier      = std::max(tid - 1, (int64_t) 0);
+            int64_t col_start    = applier * n / num_appliers;
+            int64_t cols         = (applier + 1) * n / num_appliers - col_start;
+
+            if(nt > 1 && tid == 0)
+                state_next = fill_tile(0);
+            #pragma omp barrier
+            for(int64_t t = 0; t < num_tiles; ++t) {
+                if(nt == 1) {
+                    state_next = fill_tile(t);
+                    apply_tile(t, 0, n);
+                } else if(tid == 0) {
+                    if(t + 1 < num_tiles)
+                        state_next = fill_tile(t + 1);
+                } else {
+                    apply_tile(t, col_start, cols);
+                }
+                // Tile t + 1 is ready, and tile t's buffer may be overwritten.
+                #pragma omp barrier
+            }
+        }
+    }
+    state = state_next;
+
+    // Norm of the full sketch, relative to which the truncation criteria is checked.
+    T norm_sk = 0;
+    if(this -> truncated)
+        norm_sk = (T) util::lange(Norm::Fro, d, n, A_sk, d, (T_sk*) nullptr);
 
     if(this -> timing) {
         skop_t_stop  = high_resolution_clock::now();
         skop_t_dur   = duration_cast<microseconds>(skop_t_stop - skop_t_start).count();
     }
 
+    // Records and prints the timing results once the algorithm terminates.
+    auto report_times = [&]() {
+        if(this -> timing) {
+            total_t_stop = high_resolution_clock::now();
+            total_t_dur  = duration_cast<microseconds>(total_t_stop - total_t_start).count();
+            long t_rest  = total_t_dur - (preallocation_t_dur + skop_t_dur + qrcp_t_dur + reconstruction_t_dur + preconditioning_t_dur + updating1_t_dur + updating2_t_dur + updating3_t_dur + r_piv_t_dur);
+            this -> times.resize(12);
+            this -> times = {skop_t_dur, preallocation_t_dur, qrcp_t_dur, preconditioning_t_dur, cholqr_t_dur, reconstruction_t_dur, updating1_t_dur, updating2_t_dur, updating3_t_dur, r_piv_t_dur, t_rest, total_t_dur};
+
+            printf("\n\n/------------CQRRP TIMING RESULTS BEGIN------------/\n");
+            printf("Preallocation time: %25ld μs,\n",                  preallocation_t_dur);
+            printf("skop time: %34ld μs,\n",                           skop_t_dur);
+            printf("QRCP time: %36ld μs,\n",                           qrcp_t_dur);
+            printf("Preconditioning time: %24ld μs,\n",                preconditioning_t_dur);
+            printf("CholQR time: %32ld μs,\n",                         cholqr_t_dur);
+            printf("Householder vector restoration time: %7ld μs,\n",  reconstruction_t_dur);
+            printf("Computing A_new, R12 time: %23ld μs,\n",           updating1_t_dur);
+            printf("Factors updating time: %23ld μs,\n",               updating3_t_dur);
+            printf("Sketch updating time: %24ld μs,\n",                updating2_t_dur);
+            printf("Trailing cols(R) pivoting time: %10ld μs,\n",      r_piv_t_dur);
+            printf("Other routines time: %24ld μs,\n",                 t_rest);
+            printf("Total time: %35ld μs.\n",                          total_t_dur);
+
+            printf("\nPreallocation takes %22.2f%% of runtime.\n",                  100 * ((T) preallocation_t_dur   / (T) total_t_dur));
+            printf("skop generation and application takes %2.2f%% of runtime.\n",   100 * ((T) skop_t_dur            / (T) total_t_dur));
+            printf("QRCP takes %32.2f%% of runtime.\n",                             100 * ((T) qrcp_t_dur            / (T) total_t_dur));
+            printf("Preconditioning takes %20.2f%% of runtime.\n",                  100 * ((T) preconditioning_t_dur / (T) total_t_dur));
+            printf("Cholqr takes %29.2f%% of runtime.\n",                           100 * ((T) cholqr_t_dur          / (T) total_t_dur));
+            printf("Householder restoration takes %12.2f%% of runtime.\n",          100 * ((T) reconstruction_t_dur  / (T) total_t_dur));
+            printf("Computing A_new, R12 takes %14.2f%% of runtime.\n",             100 * ((T) updating1_t_dur       / (T) total_t_dur));
+            printf("Factors updating time takes %14.2f%% of runtime.\n",            100 * ((T) updating3_t_dur       / (T) total_t_dur));
+            printf("Sketch updating time takes %15.2f%% of runtime.\n",             100 * ((T) updating2_t_dur       / (T) total_t_dur));
+            printf("Trailing cols(R) pivoting takes %10.2f%% of runtime.\n",        100 * ((T) r_piv_t_dur           / (T) total_t_dur));
+            printf("Everything else takes %20.2f%% of runtime.\n",                  100 * ((T) t_rest                / (T) total_t_dur));
+            printf("/-------------CQRRP TIMING RESULTS END-------------/\n\n");
+        }
+    };
+
     for(iter = 0; iter < maxiter; ++iter) {
         // Make sure we fit into the available space
         b_sz = std::min(b_sz, std::min(m, n) - curr_sz);
+        // In truncated mode, the last block is shrunk to stop exactly at the rank cap.
+        if(this -> truncated && this -> max_rank > 0)
+            b_sz = std::min(b_sz, this -> max_rank - curr_sz);
         internal_nb = std::min(internal_nb, b_sz);
         block_rank = b_sz;
 
-        // Zero-out data - may not be necessary
-        std::fill(&J_buffer[0], &J_buffer[n], 0);
-        std::fill(&J_buffer_lu[0], &J_buffer_lu[std::min(d, n)], 0);
-        std::fill(&Work2[0], &Work2[n], (T) 0.0);
-
         if(this -> timing)
             qrcp_t_start = high_resolution_clock::now();
-            
-        if (this -> use_qp3) {
-            lapack::geqp3(sampling_dimension, cols, A_sk, d, J_buffer, Work2);
-        } else {
-            // Perform pivoted LU on A_sk', follow it up by unpivoted QR on a permuted A_sk.
-            // Get a transpose of A_sk 
-            util::transposition(sampling_dimension, cols, A_sk, d, A_sk_trans, n, 0);
-            
-            // Perform a row-pivoted LU on a transpose of A_sk
-            lapack::getrf(cols, sampling_dimension, A_sk_trans, n, J_buffer_lu);
-            // Fill the pivot vector, apply swaps found via lu on A_sk'.
-            std::iota(&J_buffer[0], &J_buffer[cols], 1);
-
-            for (i = 0; i < std::min(sampling_dimension, cols); ++i) {
-                tmp = J_buffer[J_buffer_lu[i] - 1];
-                J_buffer[J_buffer_lu[i] - 1] = J_buffer[i];
-                J_buffer[i] = tmp;
-            }
-            // Apply pivots to A_sk
-            util::col_swap(sampling_dimension, cols, cols, A_sk, d, J_buf);
-            // Perform an unpivoted QR on A_sk
-            lapack::geqrf(sampling_dimension, cols, A_sk, d, Work2);
-        }
+
+        if(!sketch_factored)
+            qrcp_sketch(sampling_dimension, cols);
+        sketch_factored = false;
 
         if(this -> timing) {
             qrcp_t_stop = high_resolution_clock::now();
@@ -353,7 +766,7 @@ int CQRRP_blocked<T, RNG>::call(
         // Need to premute trailing columns of the full R-factor.
         // Remember that the R-factor is stored the upper-triangular portion of A.
         if(iter != 0)
-            util::col_swap(curr_sz, cols, cols, &A[lda * curr_sz], m, J_buf);
+            util::col_swap(curr_sz, cols, cols, &A[lda * curr_sz], m, J_buffer, J_buffer_work);
 
         if(this -> timing) {
             r_piv_t_stop  = high_resolution_clock::now();
@@ -362,7 +775,7 @@ int CQRRP_blocked<T, RNG>::call(
         }
 
         // Pivoting the current matrix A.
-        util::col_swap(rows, cols, cols, A_work, lda, J_buf);
+        util::col_swap(rows, cols, cols, A_work, lda, J_buffer, J_buffer_work);
 
         // Checking for the zero matrix post-pivoting is the best idea, 
         // as we would only need to check one column (pivoting moves the column with the largest norm upfront)
@@ -381,15 +794,9 @@ int CQRRP_blocked<T, RNG>::call(
             if(iter == 0) {
                 blas::copy(cols, J_buffer, 1, J, 1);
             } else {
-                RandLAPACK::util::col_swap<T>(cols, cols, &J[curr_sz], J_buf);
+                RandLAPACK::util::col_swap<T>(cols, cols, &J[curr_sz], J_buffer, J_buffer_work);
             }
 
-            free(J_buffer_lu);
-            free(A_sk_const);
-            free(A_sk_trans);
-            free(R_cholqr);
-            free(T_dat);
-            free(Work2);
             return 0;
         }
 
@@ -407,16 +814,23 @@ int CQRRP_blocked<T, RNG>::call(
         // If the internal_nb, used in gemqrt and orhr_col is larger than the updated block_rank, it would need to be updated as well.
         // Updating block_rank affects the way the preconditioning is done, which, in its turn, affects CholQR, ORHR_COL, updating A and updating R.
         for(i = 0; i < b_sz; ++i) {
-            if(std::abs(R_sk[i * d + i]) / std::abs(R_sk[0]) < this -> tol) {
+            if(std::abs(R_sk[i * d + i]) / std::abs(R_sk[0]) < tol_rank) {
                 block_rank = i;
                 internal_nb = std::min(internal_nb, block_rank);
                 break;
             }
         }
         
+        // R_sk in the working precision.
+        if constexpr (std::is_same_v<T_sk, T>) {
+            R_pre = R_sk;
+        } else {
+            util::lacpy_convert(MatrixType::Upper, b_sz, b_sz, R_sk, d, R_pre, ld_pre);
+        }
+
         // A_pre = AJ(:, 1:rank_b_sz) * inv(R_sk)
         // Performing preconditioning of the current matrix A.
-        blas::trsm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, rows, block_rank, (T) 1.0, R_sk, d, A_work, lda);
+        blas::trsm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, rows, block_rank, (T) 1.0, R_pre, ld_pre, A_work, lda);
 
         if(this -> timing) {
             preconditioning_t_stop  = high_resolution_clock::now();
@@ -438,6 +852,26 @@ int CQRRP_blocked<T, RNG>::call(
             reconstruction_t_start = high_resolution_clock::now();
         }
 
+        // Whether this is the last iteration, unless the algorithm is stopped by the truncation criteria.
+        bool last_block = (block_rank != b_sz_const) || (curr_sz + b_sz >= n) || (iter + 1 >= maxiter);
+        // Overlapping the sketch QRCP for the next iteration with updating A only makes sense if there is a next iteration,
+        // and if there are threads for both.
+        bool lookahead  = this -> use_lookahead && !last_block && threads_total > 1;
+        // In truncated mode, R12 is found ahead of updating A as well, so that A does not need to be updated
+        // if the algorithm stops at this iteration.
+        bool r12_ahead  = lookahead || (this -> truncated && (block_rank == b_sz));
+        if(r12_ahead) {
+            // The rows of R12, up to the signs from orhr_col(), are Q_econ' * A_piv(:, b_sz:end).
+            // These need to be found before Q_econ gets overwritten by the Householder vectors.
+            blas::gemm(Layout::ColMajor, Op::Trans, Op::NoTrans, b_sz, cols - b_sz, rows, (T) 1.0, A_work, lda, Work1, lda, (T) 0.0, R12_la, b_sz_const);
+
+            if(this -> timing) {
+                updating1_t_stop  = high_resolution_clock::now();
+                updating1_t_dur  += duration_cast<microseconds>(updating1_t_stop - reconstruction_t_start).count();
+                reconstruction_t_start = high_resolution_clock::now();
+            }
+        }
+
         // Find Q (stored in A) using Householder reconstruction. 
         // This will represent the full (rows by rows) Q factor form Cholesky QR
         // It would have been really nice to store T right above Q, but without using extra space,
@@ -467,6 +901,123 @@ int CQRRP_blocked<T, RNG>::call(
             updating1_t_start = high_resolution_clock::now();
         }
 
+        if(r12_ahead) {
+            for(i = 0; i < cols - b_sz; ++i)
+                for(j = 0; j < b_sz; ++j)
+                    R12_la[(b_sz_const * i) + j] *= Work2[j];
+
+            // Updating pivots
+            if(iter == 0) {
+                blas::copy(cols, J_buffer, 1, J, 1);
+            } else {
+                RandLAPACK::util::col_swap<T>(cols, cols, &J[curr_sz], J_buffer, J_buffer_work);
+            }
+
+            // R11 stays in R_cholqr until A has been updated, since R11 and V1 share space.
+            blas::trmm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, b_sz, b_sz, (T) 1.0, R_pre, ld_pre, R_cholqr, b_sz_const);
+
+            if(this -> timing) {
+                updating3_t_stop  = high_resolution_clock::now();
+                updating3_t_dur  += duration_cast<microseconds>(updating3_t_stop - updating1_t_start).count();
+                updating2_t_start = high_resolution_clock::now();
+            }
+
+            bool stop = last_block || (this -> truncated && this -> max_rank > 0 && curr_sz + b_sz >= this -> max_rank);
+            if(!stop) {
+                update_sketch(R_cholqr, b_sz_const, R12_la, b_sz_const);
+                if(this -> truncated) {
+                    // The updated sketch is Q_sk' * S * (A_piv(:, b_sz:end) - Q_econ * R12), which has the same Frobenius norm
+                    // as the sketch of the new "current A" with the original operator S. Hence, the ratio of its norm to that of
+                    // the original sketch estimates ||A_work||_F / ||A||_F.
+                    stop = util::lange(Norm::Fro, sampling_dimension, cols - b_sz, A_sk, d, (T_sk*) nullptr) <= this -> eps * norm_sk;
+                }
+            }
+
+            if(this -> timing) {
+                updating2_t_stop  = high_resolution_clock::now();
+                updating2_t_dur  += duration_cast<microseconds>(updating2_t_stop - updating2_t_start).count();
+                updating1_t_start = high_resolution_clock::now();
+            }
+
+            if(stop) {
+                // Only R11 and R12 are needed, the trailing rows of A are left as they are.
+                lapack::lacpy(MatrixType::General, b_sz, cols - b_sz, R12_la, b_sz_const, Work1, lda);
+                lapack::lacpy(MatrixType::Upper, b_sz, b_sz, R_cholqr, b_sz_const, A_work, lda);
+                this -> rank = curr_sz + b_sz;
+
+                if(this -> timing) {
+                    updating1_t_stop  = high_resolution_clock::now();
+                    updating1_t_dur  += duration_cast<microseconds>(updating1_t_stop - updating1_t_start).count();
+                }
+                report_times();
+
+                return 0;
+            }
+
+            // Applying Q_full' to A_piv(:, b_sz:end) = [A1; A2].
+            // With Q_full = I - V * T * V' and V = [V1; V2], the first b_sz rows of Q_full' * A_piv(:, b_sz:end)
+            // are R12 = A1 - V1 * Y, where Y = T' * V' * A_piv(:, b_sz:end). Since R12 is already known,
+            // Y = inv(V1) * (A1 - R12), and the remaining rows are A2 - V2 * Y. The flop count is the same as in gemqrt.
+            auto update_A = [&, rows, cols, b_sz, A_work, Work1]() {
+                for(int64_t k = 0; k < cols - b_sz; ++k)
+                    blas::axpy(b_sz, (T) -1.0, &R12_la[b_sz_const * k], 1, &Work1[lda * k], 1);
+                blas::trsm(Layout::ColMajor, Side::Left, Uplo::Lower, Op::NoTrans, Diag::Unit, b_sz, cols - b_sz, (T) 1.0, A_work, lda, Work1, lda);
+                blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, rows - b_sz, cols - b_sz, b_sz, (T) -1.0, &A_work[b_sz], lda, Work1, lda, (T) 1.0, &Work1[b_sz], lda);
+                lapack::lacpy(MatrixType::General, b_sz, cols - b_sz, R12_la, b_sz_const, Work1, lda);
+            };
+
+            if(lookahead) {
+                // A is updated on threads_upd threads, while the QRCP of the next iteration is done on threads_sk threads.
+                auto updating_A = std::async(std::launch::async, [&]() {
+                    #if defined(_OPENMP)
+                    omp_set_num_threads(threads_upd);
+                    #endif
+                    update_A();
+                });
+
+                // The caller's thread count is restored afterwards.
+                #if defined(_OPENMP)
+                int threads_caller = omp_get_max_threads();
+                omp_set_num_threads(threads_sk);
+                #endif
+
+                if(this -> timing)
+                    qrcp_t_start = high_resolution_clock::now();
+
+                qrcp_sketch(sampling_dimension, cols - b_sz);
+                sketch_factored = true;
+
+                #if defined(_OPENMP)
+                omp_set_num_threads(threads_caller);
+                #endif
+
+                if(this -> timing) {
+                    qrcp_t_stop  = high_resolution_clock::now();
+                    qrcp_t_dur  += duration_cast<microseconds>(qrcp_t_stop - qrcp_t_start).count();
+                    updating1_t_start = high_resolution_clock::now();
+                }
+
+                // Only the part of updating A that did not overlap with the above is timed.
+                updating_A.get();
+            } else {
+                update_A();
+            }
+
+            R11 = A_work;
+            lapack::lacpy(MatrixType::Upper, b_sz, b_sz, R_cholqr, b_sz_const, A_work, lda);
+
+            if(this -> timing) {
+                updating1_t_stop  = high_resolution_clock::now();
+                updating1_t_dur  += duration_cast<microseconds>(updating1_t_stop - updating1_t_start).count();
+            }
+
+            curr_sz += b_sz;
+            A_work   = &Work1[b_sz];
+            rows    -= b_sz;
+            cols    -= b_sz;
+            continue;
+        }
+
         // Perform Q_full' * A_piv(:, b_sz:end) to find R12 and the new "current A."
         // A_piv (Work1) is a rows by cols - b_sz matrix, stored in space of the original A.
         // The first b_sz rows will represent R12.
@@ -475,9 +1026,9 @@ int CQRRP_blocked<T, RNG>::call(
         // Q is defined with block_rank elementary reflectors. 
         // GEMQRT is a faster alternative to ORMQR, takes in the matrix T instead of vector tau.
         if(use_gemqrt) {
-            lapack::gemqrt(Side::Left, Op::Trans, rows, cols - b_sz, block_rank, internal_nb, A_work, lda, T_dat, b_sz_const, Work1, lda);
+            util::gemqrt(Side::Left, Op::Trans, rows, cols - b_sz, block_rank, internal_nb, A_work, lda, T_dat, b_sz_const, Work1, lda, upd_work);
         } else {
-            lapack::ormqr(Side::Left, Op::Trans, rows, cols - b_sz, block_rank, A_work, lda, tau_sub, Work1, lda);
+            util::ormqr(Side::Left, Op::Trans, rows, cols - b_sz, block_rank, A_work, lda, tau_sub, Work1, lda, upd_work, lwork_upd);
         }
 
         if(this -> timing) {
@@ -490,13 +1041,13 @@ int CQRRP_blocked<T, RNG>::call(
         if(iter == 0) {
             blas::copy(cols, J_buffer, 1, J, 1);
         } else {
-            RandLAPACK::util::col_swap<T>(cols, cols, &J[curr_sz], J_buf);
+            RandLAPACK::util::col_swap<T>(cols, cols, &J[curr_sz], J_buffer, J_buffer_work);
         }
 
         // Alternatively, instead of trmm + copy, we could perform a single gemm.
         // Compute R11 = R11_full(1:block_rank, :) * R_sk
         // R11_full is stored in R_cholqr space, R_sk is stored in A_sk space.
-        blas::trmm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, block_rank, block_rank, (T) 1.0, R_sk, d, R_cholqr, b_sz_const);
+        blas::trmm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, block_rank, block_rank, (T) 1.0, R_pre, ld_pre, R_cholqr, b_sz_const);
 
         // Need to copy R11 over form R_cholqr into the appropriate space in A.
         // We cannot avoid this copy, since trmm() assumes R_cholqr is a square matrix.
@@ -527,47 +1078,7 @@ int CQRRP_blocked<T, RNG>::call(
         if((curr_sz >= n) || (block_rank != b_sz_const)) {
             this -> rank = curr_sz;
 
-            if(this -> timing) {
-                total_t_stop = high_resolution_clock::now();
-                total_t_dur  = duration_cast<microseconds>(total_t_stop - total_t_start).count();
-                long t_rest  = total_t_dur - (preallocation_t_dur + skop_t_dur + qrcp_t_dur + reconstruction_t_dur + preconditioning_t_dur + updating1_t_dur + updating2_t_dur + updating3_t_dur + r_piv_t_dur);
-                this -> times.resize(12);
-                this -> times = {skop_t_dur, preallocation_t_dur, qrcp_t_dur, preconditioning_t_dur, cholqr_t_dur, reconstruction_t_dur, updating1_t_dur, updating2_t_dur, updating3_t_dur, r_piv_t_dur, t_rest, total_t_dur};
-
-                printf("\n\n/------------CQRRP TIMING RESULTS BEGIN------------/\n");
-                printf("Preallocation time: %25ld μs,\n",                  preallocation_t_dur);
-                printf("skop time: %34ld μs,\n",                           skop_t_dur);
-                printf("QRCP time: %36ld μs,\n",                           qrcp_t_dur);
-                printf("Preconditioning time: %24ld μs,\n",                preconditioning_t_dur);
-                printf("CholQR time: %32ld μs,\n",                         cholqr_t_dur);
-                printf("Householder vector restoration time: %7ld μs,\n",  reconstruction_t_dur);
-                printf("Computing A_new, R12 time: %23ld μs,\n",           updating1_t_dur);
-                printf("Factors updating time: %23ld μs,\n",               updating3_t_dur);
-                printf("Sketch updating time: %24ld μs,\n",                updating2_t_dur);
-                printf("Trailing cols(R) pivoting time: %10ld μs,\n",      r_piv_t_dur);
-                printf("Other routines time: %24ld μs,\n",                 t_rest);
-                printf("Total time: %35ld μs.\n",                          total_t_dur);
-
-                printf("\nPreallocation takes %22.2f%% of runtime.\n",                  100 * ((T) preallocation_t_dur   / (T) total_t_dur));
-                printf("skop generation and application takes %2.2f%% of runtime.\n",   100 * ((T) skop_t_dur            / (T) total_t_dur));
-                printf("QRCP takes %32.2f%% of runtime.\n",                             100 * ((T) qrcp_t_dur            / (T) total_t_dur));
-                printf("Preconditioning takes %20.2f%% of runtime.\n",                  100 * ((T) preconditioning_t_dur / (T) total_t_dur));
-                printf("Cholqr takes %29.2f%% of runtime.\n",                           100 * ((T) cholqr_t_dur          / (T) total_t_dur));
-                printf("Householder restoration takes %12.2f%% of runtime.\n",          100 * ((T) reconstruction_t_dur  / (T) total_t_dur));
-                printf("Computing A_new, R12 takes %14.2f%% of runtime.\n",             100 * ((T) updating1_t_dur       / (T) total_t_dur));
-                printf("Factors updating time takes %14.2f%% of runtime.\n",            100 * ((T) updating3_t_dur       / (T) total_t_dur));
-                printf("Sketch updating time takes %15.2f%% of runtime.\n",             100 * ((T) updating2_t_dur       / (T) total_t_dur));
-                printf("Trailing cols(R) pivoting takes %10.2f%% of runtime.\n",        100 * ((T) r_piv_t_dur           / (T) total_t_dur));
-                printf("Everything else takes %20.2f%% of runtime.\n",                  100 * ((T) t_rest                / (T) total_t_dur));
-                printf("/-------------CQRRP TIMING RESULTS END-------------/\n\n");
-            }
-
-            free(J_buffer_lu);
-            free(A_sk_const);
-            free(A_sk_trans);
-            free(R_cholqr);
-            free(T_dat);
-            free(Work2);
+            report_times();
 
             return 0;
         }
@@ -583,27 +1094,7 @@ int CQRRP_blocked<T, RNG>::call(
         A_work = &Work1[b_sz];
         
         // Updating the skethcing buffer
-        // trsm (R_sk, R11) -> R_sk
-        // Clearing the lower-triangular portion here is necessary, if there is a more elegant way, need to use that.
-        RandLAPACK::util::get_U(b_sz, b_sz, R_sk, d);
-        blas::trsm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, b_sz, b_sz, (T) 1.0, R11, lda, R_sk, d);
-        // R_sk_12 - R_sk_11 * inv(R_11) * R_12
-        // Side note: might need to be careful when d = b_sz.
-        // Cannot perform trmm here as an alternative, since matrix difference is involved.
-        blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, b_sz, cols - b_sz, b_sz, (T) -1.0, R_sk, d, R12, lda, (T) 1.0, &R_sk[d * b_sz], d);
-        
-        // Changing the sampling dimension parameter
-        sampling_dimension = std::min(sampling_dimension, cols);
-
-        // Need to zero out the lower triangular portion of R_sk_22
-        // Make sure R_sk_22 exists.
-        if (sampling_dimension - b_sz > 0)
-            RandLAPACK::util::get_U(sampling_dimension - b_sz, sampling_dimension - b_sz, &R_sk[(d + 1) * b_sz], d);
-
-        // Changing the pointer to relevant data in A_sk - this is equaivalent to copying data over to the beginning of A_sk.
-        // Remember that the only "active" portion of A_sk remaining would be of size sampling_dimension by cols;
-        // if any rows beyond that would be accessed, we would have issues. 
-        A_sk = &A_sk[d * b_sz];
+        update_sketch(R11, lda, R12, lda);
 
         if(this -> timing) {
             updating2_t_stop  = high_resolution_clock::now();
@@ -614,8 +1105,10 @@ int CQRRP_blocked<T, RNG>::call(
         rows -= b_sz;
         cols -= b_sz;
     }
-    #endif
+    // Reached when m < n, once all rows have been factored.
+    this -> rank = curr_sz;
     return 0;
 }
+#endif
 
 } // end namespace RandLAPACK
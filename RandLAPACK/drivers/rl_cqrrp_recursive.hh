@@ -0,0 +1,305 @@
+#pragma once
+
+#include "rl_util.hh"
+#include "rl_lapack_work.hh"
+#include "rl_blaspp.hh"
+#include "rl_lapackpp.hh"
+#include "rl_cqrrp.hh"
+
+#include <RandBLAS.hh>
+#include <cstdint>
+#include <vector>
+#include <chrono>
+#include <numeric>
+#include <algorithm>
+
+using namespace std::chrono;
+
+namespace RandLAPACK {
+
+/// Recursive (cache-oblivious) variant of CQRRP.
+///
+/// A column range is split in two, with the left part of w columns, where w is
+/// roughly half of the range, rounded to a multiple of the block size.
+/// The w pivots of the left part are selected with a pivoted LU on a (d_factor * w)-by-width sparse sketch of the range,
+/// the left part is factored recursively, and the right part is then updated by a single gemqrt with all w reflectors
+/// (and one w-by-w triangular factor T, formed by a single larft), before being factored recursively in turn. Ranges of at most 'leaf_cols' columns (0, the default, picks 4 * b_sz)
+/// are factored by the blocked kernel 'leaf', which may be configured as a stand-alone CQRRP_blocked object.
+///
+/// Compared to CQRRP_blocked, most of the flops in updating the trailing matrix go into gemqrt calls whose
+/// inner dimension grows with the size of the subproblem, rather than staying at b_sz.
+/// The output is formatted exactly like that of CQRRP_blocked (and GEQP3).
+template <typename T, typename RNG>
+class CQRRP_recursive : public CQRRPalg<T, RNG> {
+    public:
+
+        /// 'ep' and 'b_sz' are passed on to the leaf kernel.
+        CQRRP_recursive(
+            bool time_subroutines,
+            T ep,
+            int64_t b_sz
+        ) : leaf(false, ep, b_sz) {
+            timing     = time_subroutines;
+            eps        = ep;
+            block_size = b_sz;
+            leaf_cols  = 0;
+            nnz        = 4;
+            rank       = 0;
+        }
+
+        /// Computes a QR factorization with column pivots of the form:
+        ///     A[:, J] = QR,
+        /// where Q and R are of size m-by-k and k-by-n, with rank(A) = k.
+        /// Stores implict Q factor and explicit R factor in A's space (output formatted exactly like GEQP3).
+        ///
+        /// @param[in] m
+        ///     The number of rows in the matrix A.
+        ///
+        /// @param[in] n
+        ///     The number of columns in the matrix A.
+        ///
+        /// @param[in] A
+        ///     Pointer to the m-by-n matrix A, stored in a column-major format.
+        ///
+        /// @param[in] lda
+        ///     Leading dimension of A.
+        ///
+        /// @param[in] d_factor
+        ///     Embedding dimension of a sketch factor, in the leaf kernel and at every node.
+        ///
+        /// @param[in] tau
+        ///     Pointer to a vector of size n. On entry, is empty.
+        ///
+        /// @param[in] state
+        ///     RNG state parameter, required for sketching operator generation.
+        ///
+        /// @param[out] A
+        ///     Overwritten by Implicit Q and explicit R factors.
+        ///
+        /// @param[out] tau
+        ///     On output, similar in format to that in GEQP3.
+        ///
+        /// @param[out] J
+        ///     Stores k integer type pivot index extries.
+        ///
+        /// @return = 0: successful exit
+        ///
+        int call(
+            int64_t m,
+            int64_t n,
+            T* A,
+            int64_t lda,
+            T d_factor,
+            T* tau,
+            int64_t* J,
+            RandBLAS::RNGState<RNG> &state
+        ) override;
+
+    public:
+        bool timing;
+        T eps;
+        int64_t rank;
+        int64_t block_size;
+
+        // Widest column range factored by the leaf kernel
+        int64_t leaf_cols;
+
+        // Number of nonzeros per column in the sparse sketches of the recursion nodes
+        int64_t nnz;
+
+        // Blocked kernel at the bottom of the recursion
+        CQRRP_blocked<T, RNG> leaf;
+
+        // 7 entries - logs time for different portions of the algorithm
+        std::vector<long> times;
+
+    private:
+        /// Factors the column range [off, off + width) of A, assuming that columns [0, off) have been factored
+        /// and that the range has been updated accordingly. Returns the rank of the range.
+        int64_t factor_range(
+            int64_t m,
+            int64_t off,
+            int64_t width,
+            T* A,
+            int64_t lda,
+            T d_factor,
+            T* tau,
+            int64_t* J,
+            RandBLAS::RNGState<RNG> &state
+        );
+
+        // Buffers shared by all nodes of the recursion
+        std::vector<T> A_sk;
+        std::vector<T> T_dat;
+        std::vector<T> upd_work;
+        std::vector<int64_t> J_node;
+        std::vector<int64_t> J_work;
+        void* leaf_work;
+        int64_t leaf_bytes;
+        // leaf_cols, or its default, for the current call
+        int64_t leaf_width;
+
+        long sketch_t_dur;
+        long piv_t_dur;
+        long perm_t_dur;
+        long leaf_t_dur;
+        long update_t_dur;
+};
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int CQRRP_recursive<T, RNG>::call(
+    int64_t m,
+    int64_t n,
+    T* A,
+    int64_t lda,
+    T d_factor,
+    T* tau,
+    int64_t* J,
+    RandBLAS::RNGState<RNG> &state
+){
+    high_resolution_clock::time_point total_t_start;
+    high_resolution_clock::time_point total_t_stop;
+    long total_t_dur = 0;
+    sketch_t_dur = 0;
+    piv_t_dur    = 0;
+    perm_t_dur   = 0;
+    leaf_t_dur   = 0;
+    update_t_dur = 0;
+
+    if(this -> timing)
+        total_t_start = high_resolution_clock::now();
+
+    int64_t b_sz = this -> block_size;
+    this -> leaf_width = (this -> leaf_cols > 0) ? this -> leaf_cols : 4 * b_sz;
+
+    // The left part of a node has at most half of the columns of the range, and its sketch has d_factor times as many rows.
+    int64_t w_max = std::max(b_sz, ((n / 2) / b_sz) * b_sz);
+    int64_t d_max = std::min(m, std::max(w_max, (int64_t) (d_factor * w_max)));
+    this -> A_sk.resize(d_max * n);
+    this -> T_dat.resize(w_max * w_max);
+    this -> upd_work.resize(util::gemqrt_work_size<T>(Side::Left, m, n, w_max));
+    this -> J_node.resize(n);
+    this -> J_work.resize(n);
+    // The leaf workspace only grows with the number of columns, so one sized for all of A fits every leaf.
+    this -> leaf_bytes = this -> leaf.workspace_query(m, n, d_factor);
+    this -> leaf_work  = util::workspace_alloc(this -> leaf_bytes);
+
+    std::iota(J, &J[n], 1);
+    this -> rank = this -> factor_range(m, 0, n, A, lda, d_factor, tau, J, state);
+
+    free(this -> leaf_work);
+
+    if(this -> timing) {
+        total_t_stop = high_resolution_clock::now();
+        total_t_dur  = duration_cast<microseconds>(total_t_stop - total_t_start).count();
+        long t_rest  = total_t_dur - (sketch_t_dur + piv_t_dur + perm_t_dur + leaf_t_dur + update_t_dur);
+        this -> times.resize(7);
+        this -> times = {sketch_t_dur, piv_t_dur, perm_t_dur, leaf_t_dur, update_t_dur, t_rest, total_t_dur};
+
+        printf("\n\n/--------CQRRP RECURSIVE TIMING RESULTS BEGIN--------/\n");
+        printf("Node sketching time: %24ld μs,\n",  sketch_t_dur);
+        printf("Node pivot selection time: %18ld μs,\n", piv_t_dur);
+        printf("Node pivoting time: %25ld μs,\n",   perm_t_dur);
+        printf("Leaf CQRRP time: %28ld μs,\n",      leaf_t_dur);
+        printf("Trailing update time: %23ld μs,\n", update_t_dur);
+        printf("Other routines time: %24ld μs,\n",  t_rest);
+        printf("Total time: %33ld μs.\n",           total_t_dur);
+        printf("/---------CQRRP RECURSIVE TIMING RESULTS END---------/\n\n");
+    }
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int64_t CQRRP_recursive<T, RNG>::factor_range(
+    int64_t m,
+    int64_t off,
+    int64_t width,
+    T* A,
+    int64_t lda,
+    T d_factor,
+    T* tau,
+    int64_t* J,
+    RandBLAS::RNGState<RNG> &state
+){
+    high_resolution_clock::time_point t_start;
+    int64_t b_sz = this -> block_size;
+    int64_t rows = m - off;
+    int64_t w    = std::max(b_sz, ((width / 2) / b_sz) * b_sz);
+    T* A_range   = &A[off + lda * off];
+
+    if(rows <= 0 || width <= 0)
+        return 0;
+
+    if(width <= this -> leaf_width || rows <= w) {
+        if(this -> timing)
+            t_start = high_resolution_clock::now();
+
+        this -> leaf.call(rows, width, A_range, lda, d_factor, &tau[off], this -> J_node.data(), state, this -> leaf_work, this -> leaf_bytes);
+        // The leaf permuted the columns of the range below row off only.
+        util::col_swap(off, width, width, &A[lda * off], lda, this -> J_node.data(), this -> J_work.data());
+        util::col_swap<T>(width, width, &J[off], this -> J_node.data(), this -> J_work.data());
+
+        if(this -> timing)
+            leaf_t_dur += duration_cast<microseconds>(high_resolution_clock::now() - t_start).count();
+        return this -> leaf.rank;
+    }
+
+    // Pivots for the left part come from a pivoted LU of the sketch, as in CQRRP_blocked.
+    // Only the leading w pivots are used, but as there, the sketch is oversampled by d_factor,
+    // as a sketch with only w rows is a much weaker embedding of the range.
+    if(this -> timing)
+        t_start = high_resolution_clock::now();
+
+    int64_t d    = std::min(rows, std::max(w, (int64_t) (d_factor * w)));
+    T* A_sk      = this -> A_sk.data();
+    RandBLAS::SparseDist DS = {.n_rows = d, .n_cols = rows, .vec_nnz = std::min(this -> nnz, d)};
+    RandBLAS::SparseSkOp<T, RNG> S(DS, state);
+    state = RandBLAS::fill_sparse(S);
+    RandBLAS::sketch_general(Layout::ColMajor, Op::NoTrans, Op::NoTrans, d, width, rows, (T) 1.0, S, 0, 0, A_range, lda, (T) 0.0, A_sk, d);
+
+    if(this -> timing) {
+        sketch_t_dur += duration_cast<microseconds>(high_resolution_clock::now() - t_start).count();
+        t_start = high_resolution_clock::now();
+    }
+
+    util::getrf_col_piv(d, width, A_sk, d, this -> J_node.data());
+
+    if(this -> timing) {
+        piv_t_dur += duration_cast<microseconds>(high_resolution_clock::now() - t_start).count();
+        t_start = high_resolution_clock::now();
+    }
+
+    // All rows are permuted, including the rows of R above the range.
+    util::col_swap(m, width, width, &A[lda * off], lda, this -> J_node.data(), this -> J_work.data());
+    util::col_swap<T>(width, width, &J[off], this -> J_node.data(), this -> J_work.data());
+
+    if(this -> timing)
+        perm_t_dur += duration_cast<microseconds>(high_resolution_clock::now() - t_start).count();
+
+    int64_t rank_left = this -> factor_range(m, off, w, A, lda, d_factor, tau, J, state);
+
+    // Applying Q_left' to the right part with one gemqrt, whose block is all k reflectors, so that
+    // the inner dimension of its gemms is k rather than b_sz. Even if the left part is rank-deficient,
+    // the rows of R12 above it are still needed.
+    if(this -> timing)
+        t_start = high_resolution_clock::now();
+
+    int64_t k = std::min(rank_left, rows);
+    T* T_dat  = this -> T_dat.data();
+    if(k > 0 && width > w) {
+        lapack::larft(lapack::Direction::Forward, lapack::StoreV::Columnwise, rows, k, A_range, lda, &tau[off], T_dat, k);
+        util::gemqrt(Side::Left, Op::Trans, rows, width - w, k, k, A_range, lda, T_dat, k, &A_range[lda * w], lda, this -> upd_work.data());
+    }
+
+    if(this -> timing)
+        update_t_dur += duration_cast<microseconds>(high_resolution_clock::now() - t_start).count();
+
+    if(rank_left < w)
+        return rank_left;
+
+    return w + this -> factor_range(m, off + w, width - w, A, lda, d_factor, tau, J, state);
+}
+
+} // end namespace RandLAPACK
@@ -1,15 +1,21 @@
 #pragma once
 
 #include "rl_util.hh"
+#include "rl_lapack_work.hh"
 #include "rl_blaspp.hh"
 #include "rl_lapackpp.hh"
 #include "rl_hqrrp.hh"
+#include "rl_sketch_qrcp.hh"
+#include "rl_panels.hh"
+#include "rl_sparse.hh"
 
 #include <RandBLAS.hh>
 #include <cstdint>
 #include <vector>
 #include <chrono>
 #include <numeric>
+#include <future>
+#include <type_traits>
 
 using namespace std::chrono;
 
@@ -40,7 +46,8 @@ class CQRRPT : public CQRRPTalg<T, RNG> {
 
         /// The algorithm allows for choosing how QRCP is emplemented: either thropught LAPACK's GEQP3
         /// or through a custom HQRRP function. This decision is controlled through 'no_hqrrp' parameter,
-        /// which defaults to 1.
+        /// which defaults to 1. Any other QRCP may be plugged in through 'QRCP_Obj' (see SketchQRCP),
+        /// which takes precedence over 'no_hqrrp' when set. It defaults to nullptr.
         ///
         /// The algorithm allows for choosing the rank estimation scheme either naively, through looking at the
         /// diagonal entries of an R-factor from QRCP or via finding the smallest k such that ||A[k:, k:]||_F <= tau_trunk * ||A||_x.
@@ -48,11 +55,29 @@ class CQRRPT : public CQRRPTalg<T, RNG> {
         /// The choice of norm ||A||_x, either 2 or F, is controlled via 'use_fro_norm'.
         ///
         ///
-        /// The algorithm optionally computes a condition number of a preconditioned matrix A through a 'cond_check'
-        /// parameter, which defaults to 0. This requires extra n * (m + 1) * sizeof(T) bytes of space, which will be 
-        /// internally allocated by a utility routine. 
-        /// A computation is handled by a utility method that finds the l2 condition number by computing all singular
-        /// values of the R-factor via an appropriate LAPACK function.
+        /// The embedding dimension of the in-core dense version may be chosen adaptively through 'adaptive_sketch'
+        /// parameter, which defaults to 0. The sketch then starts with n + 'adaptive_oversampling' rows, and
+        /// d_factor * n becomes an upper bound on its size. Before Cholesky QR, the condition number of the
+        /// preconditioned matrix A[:, J[:k]] * inv(R_sp) is estimated through 'adaptive_steps' Lanczos steps
+        /// (see util::estimate_precond_cond), at the cost of 2 * 'adaptive_steps' matrix-vector products with A.
+        /// While the estimate exceeds 'adaptive_cond_tol', the number of the oversampling rows is quadrupled:
+        /// the new rows are sketched from A[:, J] with an independent sparse sign operator and stacked under R, whose QR
+        /// gives the updated R and R_sp. The pivots are kept. The embedding dimension that was used and
+        /// the last estimate are stored in 'd_used' and 'cond_est'. The out-of-core and the sparse-input versions
+        /// ignore 'adaptive_sketch' and always use d_factor * n rows; they set 'd_used' to that and 'cond_est' to 0.
+        /// This requires extra ((d_factor + 1) * n + 1) * n + m + (adaptive_steps + 2) * (n + 3) entries of workspace,
+        /// plus the columns of the sparse sign operator and the work array of GEQRF.
+        ///
+        /// The preconditioning trsm and the Gram matrix computation of Cholesky QR may be fused into a single
+        /// read of A through 'use_fused_gram' parameter, which defaults to 0. See util::trsm_gram.
+        /// This requires up to (number of threads) * n * n * sizeof(T) bytes of extra space for the per-thread
+        /// partial Gram matrices. The panel size is controlled by 'gram_panel_rows' (0 picks a cache-sized default).
+        ///
+        /// For T = double, the sketching, the QRCP of the sketch and the initial rank estimation may be performed
+        /// in single precision through 'use_mixed_precision' parameter, which defaults to 0. The entries of A are converted
+        /// to float as they are being sketched; the preconditioning, Cholesky QR and the
+        /// final R-factor remain in double precision. For a rank-deficient A, the block R[:, k:n] is then
+        /// computed as Q' * A[:, J[k:n]] in double precision.
         CQRRPT(
             bool time_subroutines,
             T ep
@@ -64,6 +89,16 @@ class CQRRPT : public CQRRPTalg<T, RNG> {
             oversampling = 10;
             use_cholqr = 0;
             panel_pivoting = 1;
+            use_fused_gram = 0;
+            gram_panel_rows = 0;
+            use_mixed_precision = 0;
+            QRCP_Obj = nullptr;
+            adaptive_sketch = 0;
+            adaptive_oversampling = 10;
+            adaptive_cond_tol = 20;
+            adaptive_steps = 8;
+            d_used = 0;
+            cond_est = 0;
         }
 
         /// Computes a QR factorization with column pivots of the form:
@@ -119,9 +154,246 @@ class CQRRPT : public CQRRPTalg<T, RNG> {
             RandBLAS::RNGState<RNG> &state
         ) override;
 
+        /// Returns the size (in bytes) of the workspace that the call() overload below
+        /// requires for an m by n input and a given d_factor, with the current parameters.
+        int64_t workspace_query(
+            int64_t m,
+            int64_t n,
+            T d_factor
+        );
+
+        /// Same as above, but all internal buffers are placed into a caller-owned workspace
+        /// of at least workspace_query(m, n, d_factor) bytes, aligned to 64 bytes.
+        /// No heap allocations are made by the algorithm itself,
+        /// so repeated calls on same-sized problems can reuse one workspace.
+        int call(
+            int64_t m,
+            int64_t n,
+            T* A,
+            int64_t lda,
+            T* R,
+            int64_t ldr,
+            int64_t* J,
+            T d_factor,
+            RandBLAS::RNGState<RNG> &state,
+            void* work,
+            int64_t work_bytes
+        );
+
+        /// Out-of-core version of the above, for matrices that do not fit into memory.
+        /// The m-by-n matrix A is accessed through a row panel reader, with A.m >> A.n,
+        /// and is never held in memory in full; the memory footprint is O((d + panel_rows) * n).
+        ///
+        /// The algorithm makes two passes over A:
+        ///     1. The sketch A_hat = S * A is accumulated panel by panel, with S being
+        ///        a SASO generated one column block at a time. QRCP of A_hat gives J and R_sp.
+        ///     2. The Gram matrix of A[:, J] * inv(R_sp) is accumulated panel by panel,
+        ///        and its Cholesky factor yields the final R.
+        /// If write_q is set, a third pass overwrites the leading k columns of A with Q.
+        /// Reading the next panel is overlapped with the computations on the current one.
+        ///
+        /// @param[in] A
+        ///     Source of the row panels of the m-by-n matrix A.
+        ///     Has to support writes if write_q is set.
+        ///
+        /// @param[in] panel_rows
+        ///     The number of rows in a panel; two panels are kept in memory at a time.
+        ///
+        /// @param[out] R, J
+        ///     Same as in the in-core version.
+        ///
+        /// @param[in] write_q
+        ///     Whether to write the Q-factor back into A.
+        ///
+        /// @return = 0: successful exit
+        ///
+        int call(
+            RowPanelReader<T> &A,
+            int64_t panel_rows,
+            T* R,
+            int64_t ldr,
+            int64_t* J,
+            T d_factor,
+            RandBLAS::RNGState<RNG> &state,
+            bool write_q
+        );
+
+        /// Sparse-input version of the above, for an m-by-n matrix A in the CSR format.
+        /// A is never densified:
+        ///     1. The d-by-n sketch A_hat = S * A is formed with a sparse sign sketching operator S,
+        ///        in O(nnz(A) * nnz) operations (see util::sparse_sign_sketch). QRCP of A_hat gives J and R_sp.
+        ///     2. A[:, J[:k]] is densified one row panel at a time, preconditioned as A_pre = A[:, J[:k]] * inv(R_sp)
+        ///        and its Gram matrix accumulated with syrk; its Cholesky factor yields the final R.
+        ///        Only a single panel of gram_panel_rows (0 picks a cache-sized default) by k entries is dense at a time.
+        /// The Q-factor Q = A[:, J[:rank]] * inv(R_sp) * inv(R_chol) is not formed; the rank-by-rank factors
+        /// R_sp and R_chol are kept in 'Q_precond' and 'Q_chol', and Q can be applied through
+        /// SparseImplicitQ(A, rank, J, Q_precond.data(), Q_chol.data(), rank).
+        /// As in the dense version, the Gram matrix is that of the preconditioned matrix, so the accuracy
+        /// does not depend on cond(A). The computations are done in precision T.
+        ///
+        /// @param[in] A
+        ///     The m-by-n sparse matrix A; not modified.
+        ///
+        /// @param[out] R, J
+        ///     Same as in the dense version.
+        ///
+        /// @return = 0: successful exit
+        ///
+        int call(
+            const CSRMatrixView<T> &A,
+            T* R,
+            int64_t ldr,
+            int64_t* J,
+            T d_factor,
+            RandBLAS::RNGState<RNG> &state
+        );
+
+        /// Same as above, for an m-by-n matrix A in the CSC format.
+        int call(
+            const CSCMatrixView<T> &A,
+            T* R,
+            int64_t ldr,
+            int64_t* J,
+            T d_factor,
+            RandBLAS::RNGState<RNG> &state
+        );
+
+    private:
+        /// Whether the sketch is formed and factorized in single precision.
+        bool sketch_in_float() {
+            return this->use_mixed_precision && std::is_same_v<T, double>;
+        }
+
+        /// Workspace size for sketch_qrcp<T_sk>().
+        template <typename T_sk>
+        int64_t sketch_qrcp_workspace_query(
+            int64_t m,
+            int64_t n,
+            int64_t d
+        );
+
+        /// Workspace size for factor_sketch<T_sk>().
+        template <typename T_sk>
+        int64_t factor_sketch_workspace_query(
+            int64_t d,
+            int64_t n
+        );
+
+        /// Workspace size for the out-of-core call(), with b-by-n row panels.
+        int64_t out_of_core_workspace_query(
+            int64_t d,
+            int64_t n,
+            int64_t b
+        );
+
+        /// Performs QRCP on a d-by-n sketch A_hat in precision T_sk and estimates the rank k.
+        /// Writes the pivots into J, the k-by-k preconditioner into R_sp and the k-by-n R-factor
+        /// of the sketch into R, converted to precision T. Returns k.
+        template <typename T_sk>
+        int64_t factor_sketch(
+            int64_t d,
+            int64_t n,
+            T_sk* A_hat,
+            T* R,
+            int64_t ldr,
+            T* R_sp,
+            int64_t* J,
+            RandBLAS::RNGState<RNG> &state,
+            util::Workspace &ws,
+            long &qrcp_t_dur,
+            long &rank_reveal_t_dur
+        );
+
+        /// Sketches A in precision T_sk, performs QRCP on the sketch and estimates the rank k.
+        /// Writes the pivots into J, the k-by-k preconditioner into R_sp and the k-by-n R-factor
+        /// of the sketch into R, converted to precision T. Returns k.
+        template <typename T_sk>
+        int64_t sketch_qrcp(
+            int64_t m,
+            int64_t n,
+            const T* A,
+            int64_t lda,
+            int64_t d,
+            T* R,
+            int64_t ldr,
+            T* R_sp,
+            int64_t* J,
+            RandBLAS::RNGState<RNG> &state,
+            util::Workspace &ws,
+            long &saso_t_dur,
+            long &qrcp_t_dur,
+            long &rank_reveal_t_dur
+        );
+
+        /// Adaptive mode: estimates the condition number of A[:, J[:k]] * inv(R_sp) and, while it is above
+        /// adaptive_cond_tol, appends rows to the sketch of the (pivoted) A, updating R and R_sp.
+        /// Returns the final embedding dimension.
+        int64_t grow_sketch(
+            int64_t m,
+            int64_t n,
+            int64_t k,
+            const T* A,
+            int64_t lda,
+            T* R,
+            int64_t ldr,
+            T* R_sp,
+            int64_t d,
+            int64_t d_max,
+            RandBLAS::RNGState<RNG> &state,
+            util::Workspace &ws
+        );
+
+        /// Both sparse-input versions of the algorithm.
+        template <typename SpMat>
+        int call_sparse(
+            const SpMat &A,
+            T* R,
+            int64_t ldr,
+            int64_t* J,
+            T d_factor,
+            RandBLAS::RNGState<RNG> &state
+        );
+
+        /// Number of rows per panel of the fused trsm + Gram kernel for a rank-k problem.
+        int64_t fused_gram_rows(
+            int64_t k
+        ) {
+            return this->gram_panel_rows > 0 ? this->gram_panel_rows : util::cache_panel_rows<T>(k);
+        }
+
+        /// Number of partial Gram matrices used by the fused kernel; an upper bound over all k <= n.
+        int64_t fused_gram_partials(
+            int64_t m,
+            int64_t n
+        ) {
+            int64_t rows = this->fused_gram_rows(n);
+            return std::max((int64_t) 1, std::min(util::max_threads(), (m + rows - 1) / rows));
+        }
+
+        /// Rank estimate for the Cholesky factor R_chol of the preconditioned matrix.
+        /// We expect the loss in the orthogonality of Q to be approximately equal to u * cond(R_chol)^2,
+        /// where u is the unit roundoff for the numerical type T.
+        int64_t cholqr_rank(
+            int64_t k,
+            const T* R_chol
+        );
+
+        /// Streams the row panels of A through compute(row_start, num_rows, panel),
+        /// reading the next panel in the background while the current one is being processed.
+        template <typename F>
+        void stream_panels(
+            RowPanelReader<T> &A,
+            int64_t panel_rows,
+            T* panel_0,
+            T* panel_1,
+            F compute
+        );
+
     public:
         bool timing;
         T eps;
+        // Rank estimated a posteriori from the Cholesky factor, in every call() overload.
+        // Only the leading 'rank' rows of R and columns of Q are meaningful.
         int64_t rank;
 
         // 8 entries
@@ -137,8 +409,67 @@ class CQRRPT : public CQRRPTalg<T, RNG> {
         int64_t oversampling;
         int64_t panel_pivoting;
         int64_t use_cholqr;
+
+        // QRCP of the sketch, used instead of the above when set
+        SketchQRCP* QRCP_Obj;
+
+        // Fused trsm + Gram kernel
+        int use_fused_gram;
+        int64_t gram_panel_rows;
+
+        // Mixed precision (T = double only)
+        int use_mixed_precision;
+
+        // Adaptive embedding dimension (in-core dense version only)
+        int adaptive_sketch;
+        int64_t adaptive_oversampling;
+        T adaptive_cond_tol;
+        int64_t adaptive_steps;
+
+        // Embedding dimension used in the last call and, in adaptive mode,
+        // the estimated condition number of the preconditioned matrix (0 otherwise)
+        int64_t d_used;
+        T cond_est;
+
+        // Factors of the implicit Q-factor (sparse-input version only)
+        std::vector<T> Q_precond;
+        std::vector<T> Q_chol;
 };
 
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int64_t CQRRPT<T, RNG>::workspace_query(
+    int64_t m,
+    int64_t n,
+    T d_factor
+){
+    int64_t d = d_factor * n;
+
+    int64_t work_bytes = util::workspace_bytes<int64_t>(n)     // J_buf
+                       + util::workspace_bytes<T>(n * n);      // R_sp
+
+    if(this->sketch_in_float()) {
+        work_bytes += this->template sketch_qrcp_workspace_query<float>(m, n, d);
+    } else {
+        work_bytes += this->template sketch_qrcp_workspace_query<T>(m, n, d);
+    }
+
+    if(this->use_fused_gram)
+        work_bytes += util::workspace_bytes<T>(this->fused_gram_partials(m, n) * n * n);   // Partial Gram matrices
+
+    if(this->adaptive_sketch) {
+        int64_t b = std::min(m, util::sparse_sketch_block_cols);
+        work_bytes += util::workspace_bytes<T>((n + d) * n)                                 // Stacked R-factors
+                    + util::workspace_bytes<T>(n)                                           // tau
+                    + util::workspace_bytes<T>(m + (this->adaptive_steps + 2) * (n + 3))    // Lanczos
+                    + util::workspace_bytes<int64_t>(this->nnz * b)                         // Rows of a block of S
+                    + util::workspace_bytes<T>(this->nnz * b)                               // Values of a block of S
+                    + util::workspace_bytes<T>(util::geqrf_work_size<T>(n + d, n));         // Work array of GEQRF
+    }
+
+    return work_bytes;
+}
+
 // -----------------------------------------------------------------------------
 template <typename T, typename RNG>
 int CQRRPT<T, RNG>::call(
@@ -151,14 +482,32 @@ int CQRRPT<T, RNG>::call(
     int64_t* J,
     T d_factor,
     RandBLAS::RNGState<RNG> &state
+){
+    int64_t work_bytes = this->workspace_query(m, n, d_factor);
+    void* work = util::workspace_alloc(work_bytes);
+
+    int info = this->call(m, n, A, lda, R, ldr, J, d_factor, state, work, work_bytes);
+
+    free(work);
+    return info;
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int CQRRPT<T, RNG>::call(
+    int64_t m,
+    int64_t n,
+    T* A,
+    int64_t lda,
+    T* R,
+    int64_t ldr,
+    int64_t* J,
+    T d_factor,
+    RandBLAS::RNGState<RNG> &state,
+    void* work,
+    int64_t work_bytes
 ){
     ///--------------------TIMING VARS--------------------/
-    high_resolution_clock::time_point saso_t_stop;
-    high_resolution_clock::time_point saso_t_start;
-    high_resolution_clock::time_point qrcp_t_start;
-    high_resolution_clock::time_point qrcp_t_stop;
-    high_resolution_clock::time_point rank_reveal_t_start;
-    high_resolution_clock::time_point rank_reveal_t_stop;
     high_resolution_clock::time_point cholqr_t_start;
     high_resolution_clock::time_point cholqr_t_stop;
     high_resolution_clock::time_point a_mod_piv_t_start;
@@ -178,50 +527,293 @@ int CQRRPT<T, RNG>::call(
     if(this -> timing)
         total_t_start = high_resolution_clock::now();
 
-    int i;
     int64_t k = n;
     int64_t d = d_factor * n;
-    // A constant for initial rank estimation.
-    T eps_initial_rank_estimation = 2 * std::pow(std::numeric_limits<T>::epsilon(), 0.95);
-    // Variables for a posteriori rank estimation.
+    // In adaptive mode, d_factor * n only bounds the embedding dimension.
+    int64_t d_max = d;
+    if(this->adaptive_sketch)
+        d = std::min(d_max, n + this->adaptive_oversampling);
+    // Variable for a posteriori rank estimation.
     int64_t new_rank;
-    T running_max, running_min, curr_entry;
 
-    T* A_hat = ( T * ) calloc( d * n, sizeof( T ) );
-    T* tau   = ( T * ) calloc( n, sizeof( T ) );
+    util::Workspace ws(work, work_bytes);
     // Buffer for column pivoting.
-    std::vector<int64_t> J_buf(n, 0);
+    int64_t* J_buf = ws.take<int64_t>(n);
+    // Space for a preconditioner buffer, of size up to n by n.
+    T* R_sp  = ws.take<T>(n * n);
+
+    /// Sketching, QRCP on a sketch and the initial rank estimation.
+    if(this->sketch_in_float()) {
+        k = this->template sketch_qrcp<float>(m, n, A, lda, d, R, ldr, R_sp, J, state, ws, saso_t_dur, qrcp_t_dur, rank_reveal_t_dur);
+    } else {
+        k = this->template sketch_qrcp<T>(m, n, A, lda, d, R, ldr, R_sp, J, state, ws, saso_t_dur, qrcp_t_dur, rank_reveal_t_dur);
+    }
+    this->rank = k;
 
     if(this -> timing)
-        saso_t_start = high_resolution_clock::now();
-    
-    /// Generating a SASO
-    RandBLAS::SparseDist DS = {.n_rows = d, .n_cols = m, .vec_nnz = this->nnz};
-    RandBLAS::SparseSkOp<T, RNG> S(DS, state);
-    state = RandBLAS::fill_sparse(S);
-
-    /// Applying a SASO
-    RandBLAS::sketch_general(
-        Layout::ColMajor, Op::NoTrans, Op::NoTrans,
-        d, n, m, (T) 1.0, S, 0, 0, A, lda, (T) 0.0, A_hat, d
-    );
+        a_mod_piv_t_start = high_resolution_clock::now();
+
+    // Swap k columns of A with pivots from J.
+    // In mixed precision and in adaptive mode, the trailing columns are needed in their pivoted order as well.
+    if(this->sketch_in_float() || this->adaptive_sketch) {
+        util::col_swap(m, n, n, A, lda, J, J_buf);
+    } else {
+        util::col_swap(m, n, k, A, lda, J, J_buf);
+    }
+
+    this->cond_est = 0;
+    if(this->adaptive_sketch)
+        d = this->grow_sketch(m, n, k, A, lda, R, ldr, R_sp, d, d_max, state, ws);
+    this->d_used = d;
 
     if(this -> timing) {
-        saso_t_stop = high_resolution_clock::now();
-        qrcp_t_start = high_resolution_clock::now();
+        a_mod_piv_t_stop = high_resolution_clock::now();
+        a_mod_trsm_t_start = high_resolution_clock::now();
+    }
+
+    if(this->use_fused_gram) {
+        // A_pre * R_sp = AP, with R_sp overwritten by A_pre' * A_pre, in a single read of A.
+        int64_t num_partials = this->fused_gram_partials(m, n);
+        T* G_work = ws.take<T>(num_partials * n * n);
+        util::trsm_gram(m, k, R_sp, k, A, lda, R_sp, k, this->fused_gram_rows(k), num_partials, G_work);
+    } else {
+        // A_pre * R_sp = AP
+        blas::trsm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, m, k, 1.0, R_sp, k, A, lda);
     }
 
+    if(this -> timing) {
+        a_mod_trsm_t_stop = high_resolution_clock::now();
+        cholqr_t_start = high_resolution_clock::now();
+    }
+
+    // Do Cholesky QR
+    if(!this->use_fused_gram)
+        blas::syrk(Layout::ColMajor, Uplo::Upper, Op::Trans, k, m, 1.0, A, lda, 0.0, R_sp, k);
+    lapack::potrf(Uplo::Upper, k, R_sp, k);
+
+    // Re-estimate rank after we have the R-factor form Cholesky QR.
+    // This also automatically takes care of any potentical failures in Cholesky factorization.
+    new_rank = this->cholqr_rank(k, R_sp);
+
+    blas::trsm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, m, new_rank, 1.0, R_sp, k, A, lda);
+
+    if(this -> timing)
+        cholqr_t_stop = high_resolution_clock::now();
+
+    // Get the final R-factor.
+    if(this->sketch_in_float() && k < n) {
+        blas::trmm(Layout::ColMajor, Side::Left, Uplo::Upper, Op::NoTrans, Diag::NonUnit, new_rank, k, 1.0, R_sp, k, R, ldr);
+        // R12 from a single-precision sketch is not accurate enough, recompute it against Q.
+        blas::gemm(Layout::ColMajor, Op::Trans, Op::NoTrans, new_rank, n - k, m, 1.0, A, lda, &A[lda * k], lda, 0.0, &R[ldr * k], ldr);
+    } else {
+        blas::trmm(Layout::ColMajor, Side::Left, Uplo::Upper, Op::NoTrans, Diag::NonUnit, new_rank, n, 1.0, R_sp, k, R, ldr);
+    }
+
+    // Set the rank parameter to the value comuted a posteriori.
+    this->rank = new_rank;
+
+    if(this -> timing) {
+        a_mod_piv_t_dur   = duration_cast<microseconds>(a_mod_piv_t_stop - a_mod_piv_t_start).count();
+        a_mod_trsm_t_dur  = duration_cast<microseconds>(a_mod_trsm_t_stop - a_mod_trsm_t_start).count();
+        cholqr_t_dur      = duration_cast<microseconds>(cholqr_t_stop - cholqr_t_start).count();
+
+        total_t_stop = high_resolution_clock::now();
+        total_t_dur  = duration_cast<microseconds>(total_t_stop - total_t_start).count();
+        long t_rest  = total_t_dur - (saso_t_dur + qrcp_t_dur + rank_reveal_t_dur + cholqr_t_dur + a_mod_piv_t_dur + a_mod_trsm_t_dur);
+
+        // Fill the data vector
+        this -> times = {saso_t_dur, qrcp_t_dur, rank_reveal_t_dur, cholqr_t_dur, a_mod_piv_t_dur, a_mod_trsm_t_dur, t_rest, total_t_dur};
+    }
+
+    return 0;
+}
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int64_t CQRRPT<T, RNG>::grow_sketch(
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    const T* A,
+    int64_t lda,
+    T* R,
+    int64_t ldr,
+    T* R_sp,
+    int64_t d,
+    int64_t d_max,
+    RandBLAS::RNGState<RNG> &state,
+    util::Workspace &ws
+){
+    int64_t steps = this->adaptive_steps;
+    T* R_st   = ws.take<T>((n + d_max) * n);
+    T* tau    = ws.take<T>(n);
+    T* work   = ws.take<T>(m + (steps + 2) * (n + 3));
+    // Columns of the sparse sign operator, generated one block at a time.
+    int64_t b       = std::min(m, util::sparse_sketch_block_cols);
+    int64_t* S_rows = ws.take<int64_t>(this->nnz * b);
+    T* S_vals       = ws.take<T>(this->nnz * b);
+    int64_t lwork   = util::geqrf_work_size<T>(n + d_max, n);
+    T* qr_work      = ws.take<T>(lwork);
+
+    while(true) {
+        this->cond_est = util::estimate_precond_cond(m, k, A, lda, R_sp, k, steps, state, work);
+        if(this->cond_est <= this->adaptive_cond_tol || d >= d_max)
+            break;
+
+        // The number of rows beyond n is quadrupled.
+        int64_t d_new = std::min(d_max, n + 4 * std::max(d - n, (int64_t) 1));
+        int64_t d_add = d_new - d;
+        int64_t ld    = k + d_add;
+
+        // [R; S_add * A[:, J]] has the Gram matrix of the larger sketch, so its R-factor is that of the larger sketch.
+        std::fill(R_st, &R_st[ld * n], (T) 0.0);
+        lapack::lacpy(MatrixType::Upper, k, n, R, ldr, R_st, ld);
+
+        state = util::sparse_sign_sketch(m, n, A, lda, d_add, std::min(this->nnz, d_add), &R_st[k], ld, b, S_rows, S_vals, state);
+
+        util::geqrf(ld, n, R_st, ld, tau, qr_work, lwork);
+        lapack::lacpy(MatrixType::Upper, k, n, R_st, ld, R, ldr);
+        lapack::lacpy(MatrixType::Upper, k, k, R_st, ld, R_sp, k);
+        d = d_new;
+    }
+    return d;
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+template <typename T_sk>
+int64_t CQRRPT<T, RNG>::sketch_qrcp_workspace_query(
+    int64_t m,
+    int64_t n,
+    int64_t d
+){
+    int64_t b = std::min(m, util::sparse_sketch_block_cols);
+
+    return util::workspace_bytes<T_sk>(d * n)                  // A_hat
+         + util::workspace_bytes<int64_t>(this->nnz * b)       // Rows of a block of S
+         + util::workspace_bytes<T_sk>(this->nnz * b)          // Values of a block of S
+         + this->template factor_sketch_workspace_query<T_sk>(d, n);
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+template <typename T_sk>
+int64_t CQRRPT<T, RNG>::factor_sketch_workspace_query(
+    int64_t d,
+    int64_t n
+){
+    int64_t work_bytes = util::workspace_bytes<T_sk>(n);       // tau
+
+    if(this->QRCP_Obj == nullptr) {
+        if(this->no_hqrrp) {
+            work_bytes += util::workspace_bytes<T_sk>(util::geqp3_work_size<T_sk>(d, n));
+        } else {
+            work_bytes += hqrrp_workspace_query<T_sk>(d, n, this->nb_alg, this->oversampling);
+        }
+    }
+
+    return work_bytes;
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int64_t CQRRPT<T, RNG>::out_of_core_workspace_query(
+    int64_t d,
+    int64_t n,
+    int64_t b
+){
+    return util::workspace_bytes<T>(d * n)            // A_hat
+         + this->template factor_sketch_workspace_query<T>(d, n)
+         + util::workspace_bytes<int64_t>(n)          // J_buf
+         + util::workspace_bytes<T>(n * n)            // R_sp
+         + util::workspace_bytes<T>(n * n)            // R_chol
+         + util::workspace_bytes<T>(b * n)            // panel_0
+         + util::workspace_bytes<T>(b * n);           // panel_1
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+template <typename T_sk>
+int64_t CQRRPT<T, RNG>::sketch_qrcp(
+    int64_t m,
+    int64_t n,
+    const T* A,
+    int64_t lda,
+    int64_t d,
+    T* R,
+    int64_t ldr,
+    T* R_sp,
+    int64_t* J,
+    RandBLAS::RNGState<RNG> &state,
+    util::Workspace &ws,
+    long &saso_t_dur,
+    long &qrcp_t_dur,
+    long &rank_reveal_t_dur
+){
+    high_resolution_clock::time_point t_start;
+
+    T_sk* A_hat = ws.take<T_sk>(d * n);
+    // Columns of the sparse sign operator, generated one block at a time.
+    int64_t b       = std::min(m, util::sparse_sketch_block_cols);
+    int64_t* S_rows = ws.take<int64_t>(this->nnz * b);
+    T_sk* S_vals    = ws.take<T_sk>(this->nnz * b);
+
+    if(this -> timing)
+        t_start = high_resolution_clock::now();
+
+    /// Generating and applying a sparse sign sketching operator with nnz nonzeros per column.
+    /// In mixed precision, the entries of A are converted to T_sk as they are read.
+    state = util::sparse_sign_sketch(m, n, A, lda, d, this->nnz, A_hat, d, b, S_rows, S_vals, state);
+
+    if(this -> timing)
+        saso_t_dur = duration_cast<microseconds>(high_resolution_clock::now() - t_start).count();
+
+    return this->template factor_sketch<T_sk>(d, n, A_hat, R, ldr, R_sp, J, state, ws, qrcp_t_dur, rank_reveal_t_dur);
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+template <typename T_sk>
+int64_t CQRRPT<T, RNG>::factor_sketch(
+    int64_t d,
+    int64_t n,
+    T_sk* A_hat,
+    T* R,
+    int64_t ldr,
+    T* R_sp,
+    int64_t* J,
+    RandBLAS::RNGState<RNG> &state,
+    util::Workspace &ws,
+    long &qrcp_t_dur,
+    long &rank_reveal_t_dur
+){
+    high_resolution_clock::time_point t_start;
+
+    int64_t i;
+    int64_t k = n;
+    // A constant for initial rank estimation, in the precision of the sketch.
+    T_sk eps_initial_rank_estimation = 2 * std::pow(std::numeric_limits<T_sk>::epsilon(), 0.95);
+
+    T_sk* tau = ws.take<T_sk>(n, true);
+
+    if(this -> timing)
+        t_start = high_resolution_clock::now();
+
     /// Performing QRCP on a sketch
-    if(this->no_hqrrp) {
-        lapack::geqp3(d, n, A_hat, d, J, tau);
+    if(this->QRCP_Obj != nullptr) {
+        this->QRCP_Obj->call(d, n, A_hat, d, J, tau);
+    } else if(this->no_hqrrp) {
+        int64_t lwork = util::geqp3_work_size<T_sk>(d, n);
+        util::geqp3(d, n, A_hat, d, J, tau, ws.take<T_sk>(lwork), lwork);
     } else {
         std::iota(J, &J[n], 1);
-        hqrrp(d, n, A_hat, d, J, tau, this->nb_alg, this->oversampling, this->panel_pivoting, this->use_cholqr, state, (T*) nullptr);
+        int64_t hqrrp_bytes = hqrrp_workspace_query<T_sk>(d, n, this->nb_alg, this->oversampling);
+        hqrrp(d, n, A_hat, d, J, tau, this->nb_alg, this->oversampling, this->panel_pivoting, this->use_cholqr, state, (T_sk*) nullptr, 
+              (void*) ws.take<char>(hqrrp_bytes), hqrrp_bytes);
     }
 
     if(this -> timing) {
-        qrcp_t_stop = high_resolution_clock::now();
-        rank_reveal_t_start = high_resolution_clock::now();
+        qrcp_t_dur = duration_cast<microseconds>(high_resolution_clock::now() - t_start).count();
+        t_start = high_resolution_clock::now();
     }
 
     /// Using naive rank estimation to ensure that R used for preconditioning is invertible.
@@ -234,92 +826,344 @@ int CQRRPT<T, RNG>::call(
             break;
         }
     }
-    this->rank = k;
 
     if(this -> timing)
-        rank_reveal_t_stop = high_resolution_clock::now();
+        rank_reveal_t_dur = duration_cast<microseconds>(high_resolution_clock::now() - t_start).count();
 
-    // Allocating space for a preconditioner buffer.
-    T* R_sp  = ( T * ) calloc( k * k, sizeof( T ) );
     /// Extracting a k by k upper-triangular R.
-    lapack::lacpy(MatrixType::Upper, k, k, A_hat, d, R_sp, k);
+    util::lacpy_convert(MatrixType::Upper, k, k, A_hat, d, R_sp, k);
     /// Extracting a k by n R representation (k by k upper-triangular, rest - general)
-    lapack::lacpy(MatrixType::Upper, k, k, A_hat, d, R, ldr);
-    lapack::lacpy(MatrixType::General, k, n - k, &A_hat[d * k], d, &R[n * k], ldr);
+    util::lacpy_convert(MatrixType::Upper, k, k, A_hat, d, R, ldr);
+    util::lacpy_convert(MatrixType::General, k, n - k, &A_hat[d * k], d, &R[ldr * k], ldr);
 
-    if(this -> timing)
-        a_mod_piv_t_start = high_resolution_clock::now();
+    return k;
+}
 
-    // Swap k columns of A with pivots from J
-    blas::copy(n, J, 1, J_buf.data(), 1);
-    util::col_swap(m, n, k, A, lda, J_buf);
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int64_t CQRRPT<T, RNG>::cholqr_rank(
+    int64_t k,
+    const T* R_chol
+){
+    // The strategy here is the same as in naive rank estimation.
+    // Note that the diagonal of R_chol may not be sorted, so we need to keep the running max/min.
+    T running_max = R_chol[0];
+    T running_min = R_chol[0];
+    T curr_entry;
 
-    if(this -> timing) {
-        a_mod_piv_t_stop = high_resolution_clock::now();
-        a_mod_trsm_t_start = high_resolution_clock::now();
+    for(int64_t i = 0; i < k; ++i) {
+        curr_entry = std::abs(R_chol[i * k + i]);
+        running_max = std::max(running_max, curr_entry);
+        running_min = std::min(running_min, curr_entry);
+        if(running_max / running_min >= std::sqrt(this->eps / std::numeric_limits<T>::epsilon()))
+            return i - 1;
     }
+    return k;
+}
 
-    // A_pre * R_sp = AP
-    blas::trsm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, m, k, 1.0, R_sp, k, A, lda);
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+template <typename F>
+void CQRRPT<T, RNG>::stream_panels(
+    RowPanelReader<T> &A,
+    int64_t panel_rows,
+    T* panel_0,
+    T* panel_1,
+    F compute
+){
+    int64_t m = A.m;
+    int64_t num_panels = (m + panel_rows - 1) / panel_rows;
+    T* panels[2] = {panel_0, panel_1};
 
-    if(this -> timing) {
-        a_mod_trsm_t_stop = high_resolution_clock::now();
-        cholqr_t_start = high_resolution_clock::now();
-    }
+    auto read_panel = [&A, m, panel_rows](int64_t p, T* buf) {
+        int64_t row_start = p * panel_rows;
+        A.read(row_start, std::min(panel_rows, m - row_start), buf, panel_rows);
+    };
 
-    // Do Cholesky QR
-    blas::syrk(Layout::ColMajor, Uplo::Upper, Op::Trans, k, m, 1.0, A, lda, 0.0, R_sp, k);
-    lapack::potrf(Uplo::Upper, k, R_sp, k);
+    std::future<void> next_read = std::async(std::launch::async, read_panel, 0, panels[0]);
+    for(int64_t p = 0; p < num_panels; ++p) {
+        next_read.get();
+        if(p + 1 < num_panels)
+            next_read = std::async(std::launch::async, read_panel, p + 1, panels[(p + 1) % 2]);
 
-    // Re-estimate rank after we have the R-factor form Cholesky QR.
-    // The strategy here is the same as in naive rank estimation.
-    // This also automatically takes care of any potentical failures in Cholesky factorization.
-    // Note that the diagonal of R_sp may not be sorted, so we need to keep the running max/min
-    // We expect the loss in the orthogonality of Q to be approximately equal to u * cond(R_sp)^2, where u is the unit roundoff for the numerical type T.
-    new_rank = k;
-    running_max = R_sp[0];
-    running_min = R_sp[0];
-
-    for(i = 0; i < k; ++i) {
-        curr_entry = std::abs(R_sp[i * k + i]);
-        running_max = std::max(running_max, curr_entry);
-        running_min = std::min(running_min, curr_entry);
-        if(running_max / running_min >= std::sqrt(this->eps / std::numeric_limits<T>::epsilon())) {
-            new_rank = i - 1;
-            break;
-        }
+        int64_t row_start = p * panel_rows;
+        compute(row_start, std::min(panel_rows, m - row_start), panels[p % 2]);
     }
+}
 
-    blas::trsm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, m, new_rank, 1.0, R_sp, k, A, lda);
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int CQRRPT<T, RNG>::call(
+    RowPanelReader<T> &A,
+    int64_t panel_rows,
+    T* R,
+    int64_t ldr,
+    int64_t* J,
+    T d_factor,
+    RandBLAS::RNGState<RNG> &state,
+    bool write_q
+){
+    ///--------------------TIMING VARS--------------------/
+    high_resolution_clock::time_point saso_t_stop;
+    high_resolution_clock::time_point saso_t_start;
+    high_resolution_clock::time_point cholqr_t_start;
+    high_resolution_clock::time_point cholqr_t_stop;
+    high_resolution_clock::time_point q_write_t_start;
+    high_resolution_clock::time_point q_write_t_stop;
+    high_resolution_clock::time_point total_t_start;
+    high_resolution_clock::time_point total_t_stop;
+    long saso_t_dur        = 0;
+    long qrcp_t_dur        = 0;
+    long rank_reveal_t_dur = 0;
+    long cholqr_t_dur      = 0;
+    long q_write_t_dur     = 0;
+    long total_t_dur       = 0;
+
+    if(this -> timing)
+        total_t_start = high_resolution_clock::now();
+
+    int64_t m = A.m;
+    int64_t n = A.n;
+    int64_t k = n;
+    int64_t d = d_factor * n;
+    int64_t b = std::min(panel_rows, m);
+    // The embedding dimension is never adapted here.
+    this->d_used = d;
+    this->cond_est = 0;
+    // Variable for a posteriori rank estimation.
+    int64_t new_rank;
+
+    int64_t work_bytes = this->out_of_core_workspace_query(d, n, b);
+    void* work = util::workspace_alloc(work_bytes);
+    util::Workspace ws(work, work_bytes);
+
+    T* A_hat       = ws.take<T>(d * n);
+    int64_t* J_buf = ws.take<int64_t>(n);
+    T* R_sp        = ws.take<T>(n * n);
+    T* R_chol      = ws.take<T>(n * n);
+    // Double buffer for the row panels of A.
+    T* panel_0     = ws.take<T>(b * n);
+    T* panel_1     = ws.take<T>(b * n);
+
+    if(this -> timing)
+        saso_t_start = high_resolution_clock::now();
+
+    /// Pass one: accumulate A_hat = S * A.
+    /// Columns of a SASO are independent, so S is generated one column block at a time,
+    /// matching the row panels of A. Each block needs nnz nonzeros per column, which puts its vectors
+    /// along the long axis when a panel has fewer than d rows (always the case for a short last panel).
+    T beta = 0.0;
+    this->stream_panels(A, b, panel_0, panel_1, [&](int64_t row_start, int64_t rows, T* panel) {
+        RandBLAS::MajorAxis axis = (rows < d) ? RandBLAS::MajorAxis::Long : RandBLAS::MajorAxis::Short;
+        RandBLAS::SparseDist DS = {.n_rows = d, .n_cols = rows, .vec_nnz = this->nnz, .major_axis = axis};
+        RandBLAS::SparseSkOp<T, RNG> S(DS, state);
+        state = RandBLAS::fill_sparse(S);
+
+        RandBLAS::sketch_general(
+            Layout::ColMajor, Op::NoTrans, Op::NoTrans,
+            d, n, rows, (T) 1.0, S, 0, 0, panel, b, beta, A_hat, d
+        );
+        beta = 1.0;
+    });
+
+    if(this -> timing)
+        saso_t_stop = high_resolution_clock::now();
+
+    /// QRCP on a sketch and the initial rank estimation, same as in the in-core version.
+    k = this->template factor_sketch<T>(d, n, A_hat, R, ldr, R_sp, J, state, ws, qrcp_t_dur, rank_reveal_t_dur);
+    this->rank = k;
+
+    if(this -> timing)
+        cholqr_t_start = high_resolution_clock::now();
+
+    /// Pass two: accumulate the Gram matrix of A[:, J] * inv(R_sp), then do Cholesky QR.
+    beta = 0.0;
+    this->stream_panels(A, b, panel_0, panel_1, [&](int64_t row_start, int64_t rows, T* panel) {
+        util::col_swap(rows, n, k, panel, b, J, J_buf);
+        blas::trsm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, rows, k, 1.0, R_sp, k, panel, b);
+        blas::syrk(Layout::ColMajor, Uplo::Upper, Op::Trans, k, rows, 1.0, panel, b, beta, R_chol, k);
+        beta = 1.0;
+    });
+    lapack::potrf(Uplo::Upper, k, R_chol, k);
+
+    // Re-estimate rank after we have the R-factor form Cholesky QR.
+    new_rank = this->cholqr_rank(k, R_chol);
 
     if(this -> timing)
         cholqr_t_stop = high_resolution_clock::now();
 
     // Get the final R-factor.
-    blas::trmm(Layout::ColMajor, Side::Left, Uplo::Upper, Op::NoTrans, Diag::NonUnit, new_rank, n, 1.0, R_sp, k, R, ldr);
+    blas::trmm(Layout::ColMajor, Side::Left, Uplo::Upper, Op::NoTrans, Diag::NonUnit, new_rank, n, 1.0, R_chol, k, R, ldr);
+
+    if(this -> timing)
+        q_write_t_start = high_resolution_clock::now();
+
+    /// Optional pass three: form Q one panel at a time, same as the in-core version does for all of A.
+    if(write_q) {
+        this->stream_panels(A, b, panel_0, panel_1, [&](int64_t row_start, int64_t rows, T* panel) {
+            util::col_swap(rows, n, k, panel, b, J, J_buf);
+            blas::trsm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, rows, k, 1.0, R_sp, k, panel, b);
+            blas::trsm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, rows, new_rank, 1.0, R_chol, k, panel, b);
+            A.write(row_start, rows, k, panel, b);
+        });
+    }
+
+    if(this -> timing)
+        q_write_t_stop = high_resolution_clock::now();
 
     // Set the rank parameter to the value comuted a posteriori.
-    this->rank = k;
+    this->rank = new_rank;
+
+    free(work);
 
     if(this -> timing) {
         saso_t_dur        = duration_cast<microseconds>(saso_t_stop - saso_t_start).count();
-        qrcp_t_dur        = duration_cast<microseconds>(qrcp_t_stop - qrcp_t_start).count();
-        rank_reveal_t_dur = duration_cast<microseconds>(rank_reveal_t_stop - rank_reveal_t_start).count();
-        a_mod_piv_t_dur   = duration_cast<microseconds>(a_mod_piv_t_stop - a_mod_piv_t_start).count();
-        a_mod_trsm_t_dur  = duration_cast<microseconds>(a_mod_trsm_t_stop - a_mod_trsm_t_start).count();
         cholqr_t_dur      = duration_cast<microseconds>(cholqr_t_stop - cholqr_t_start).count();
+        q_write_t_dur     = duration_cast<microseconds>(q_write_t_stop - q_write_t_start).count();
 
         total_t_stop = high_resolution_clock::now();
         total_t_dur  = duration_cast<microseconds>(total_t_stop - total_t_start).count();
-        long t_rest  = total_t_dur - (saso_t_dur + qrcp_t_dur + rank_reveal_t_dur + cholqr_t_dur + a_mod_piv_t_dur + a_mod_trsm_t_dur);
+        long t_rest  = total_t_dur - (saso_t_dur + qrcp_t_dur + rank_reveal_t_dur + cholqr_t_dur + q_write_t_dur);
 
-        // Fill the data vector
-        this -> times = {saso_t_dur, qrcp_t_dur, rank_reveal_t_dur, cholqr_t_dur, a_mod_piv_t_dur, a_mod_trsm_t_dur, t_rest, total_t_dur};
+        // Fill the data vector; the out-of-core version reports the pivoting and the trsm
+        // of the Q-factor as a part of pass two and pass three respectively.
+        this -> times = {saso_t_dur, qrcp_t_dur, rank_reveal_t_dur, cholqr_t_dur, 0, q_write_t_dur, t_rest, total_t_dur};
     }
 
-    free(A_hat);
-    free(R_sp);
-    free(tau);
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int CQRRPT<T, RNG>::call(
+    const CSRMatrixView<T> &A,
+    T* R,
+    int64_t ldr,
+    int64_t* J,
+    T d_factor,
+    RandBLAS::RNGState<RNG> &state
+){
+    return this->call_sparse(A, R, ldr, J, d_factor, state);
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int CQRRPT<T, RNG>::call(
+    const CSCMatrixView<T> &A,
+    T* R,
+    int64_t ldr,
+    int64_t* J,
+    T d_factor,
+    RandBLAS::RNGState<RNG> &state
+){
+    return this->call_sparse(A, R, ldr, J, d_factor, state);
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+template <typename SpMat>
+int CQRRPT<T, RNG>::call_sparse(
+    const SpMat &A,
+    T* R,
+    int64_t ldr,
+    int64_t* J,
+    T d_factor,
+    RandBLAS::RNGState<RNG> &state
+){
+    ///--------------------TIMING VARS--------------------/
+    high_resolution_clock::time_point saso_t_start;
+    high_resolution_clock::time_point cholqr_t_start;
+    high_resolution_clock::time_point total_t_start;
+    long saso_t_dur        = 0;
+    long qrcp_t_dur        = 0;
+    long rank_reveal_t_dur = 0;
+    long cholqr_t_dur      = 0;
+    long total_t_dur       = 0;
+
+    if(this -> timing)
+        total_t_start = high_resolution_clock::now();
+
+    int64_t m = A.n_rows;
+    int64_t n = A.n_cols;
+    int64_t k = n;
+    int64_t d = d_factor * n;
+    // Variable for a posteriori rank estimation.
+    int64_t new_rank;
+
+    // Row panels of the preconditioned A[:, J[:k]], for k <= n.
+    int64_t b = std::min(m, this->fused_gram_rows(n));
+
+    int64_t work_bytes = util::workspace_bytes<T>(d * n)                // A_hat
+                       + this->template factor_sketch_workspace_query<T>(d, n)
+                       + util::workspace_bytes<T>(n * n)                // R_sp
+                       + util::workspace_bytes<T>(n * n)                // R_chol
+                       + util::workspace_bytes<int64_t>(n)              // J_inv
+                       + util::workspace_bytes<T>(b * n);               // A_panel
+    void* work = util::workspace_alloc(work_bytes);
+    util::Workspace ws(work, work_bytes);
+
+    T* A_hat       = ws.take<T>(d * n);
+    T* R_sp        = ws.take<T>(n * n, true);
+    T* R_chol      = ws.take<T>(n * n, true);
+    int64_t* J_inv = ws.take<int64_t>(n);
+    T* A_panel     = ws.take<T>(b * n);
+
+    if(this -> timing)
+        saso_t_start = high_resolution_clock::now();
+
+    /// Sketching, with the nonzeros of A scattered directly into A_hat.
+    state = util::sparse_sign_sketch(A, d, this->nnz, A_hat, state);
+
+    if(this -> timing)
+        saso_t_dur = duration_cast<microseconds>(high_resolution_clock::now() - saso_t_start).count();
+
+    /// QRCP on a sketch and the initial rank estimation.
+    k = this->template factor_sketch<T>(d, n, A_hat, R, ldr, R_sp, J, state, ws, qrcp_t_dur, rank_reveal_t_dur);
+    // The embedding dimension is never adapted here.
+    this->d_used = d;
+    this->cond_est = 0;
+
+    if(this -> timing)
+        cholqr_t_start = high_resolution_clock::now();
+
+    /// Gram matrix of A_pre = A[:, J[0:k]] * inv(R_sp), accumulated over dense row panels of A[:, J[0:k]].
+    for(int64_t j = 0; j < n; ++j)
+        J_inv[J[j] - 1] = j;
+    const int64_t* perm = util::sparse_perm_arg(A, J, J_inv);
+    for(int64_t row_start = 0; row_start < m; row_start += b) {
+        int64_t rows = std::min(b, m - row_start);
+        util::sparse_row_panel(A, row_start, rows, k, perm, A_panel, b);
+        blas::trsm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, rows, k, (T) 1.0, R_sp, k, A_panel, b);
+        blas::syrk(Layout::ColMajor, Uplo::Upper, Op::Trans, k, rows, (T) 1.0, A_panel, b, (T) (row_start > 0), R_chol, k);
+    }
+    lapack::potrf(Uplo::Upper, k, R_chol, k);
+
+    // Re-estimate rank after we have the R-factor form Cholesky QR.
+    new_rank = this->cholqr_rank(k, R_chol);
+
+    // Get the final R-factor.
+    blas::trmm(Layout::ColMajor, Side::Left, Uplo::Upper, Op::NoTrans, Diag::NonUnit, new_rank, n, (T) 1.0, R_chol, k, R, ldr);
+
+    if(this -> timing)
+        cholqr_t_dur = duration_cast<microseconds>(high_resolution_clock::now() - cholqr_t_start).count();
+
+    // The implicit Q-factor is defined by the leading new_rank columns of A[:, J] and by the leading
+    // new_rank-by-new_rank blocks of R_sp and R_chol.
+    this->rank = new_rank;
+    this->Q_precond.assign(new_rank * new_rank, 0.0);
+    this->Q_chol.assign(new_rank * new_rank, 0.0);
+    lapack::lacpy(MatrixType::Upper, new_rank, new_rank, R_sp, k, this->Q_precond.data(), new_rank);
+    lapack::lacpy(MatrixType::Upper, new_rank, new_rank, R_chol, k, this->Q_chol.data(), new_rank);
+
+    free(work);
+
+    if(this -> timing) {
+        total_t_dur = duration_cast<microseconds>(high_resolution_clock::now() - total_t_start).count();
+        long t_rest = total_t_dur - (saso_t_dur + qrcp_t_dur + rank_reveal_t_dur + cholqr_t_dur);
+
+        // Fill the data vector; the sparse version neither permutes nor preconditions A explicitly.
+        this -> times = {saso_t_dur, qrcp_t_dur, rank_reveal_t_dur, cholqr_t_dur, 0, 0, t_rest, total_t_dur};
+    }
 
     return 0;
 }
@@ -0,0 +1,367 @@
+#pragma once
+
+#include "rl_util.hh"
+#include "rl_blaspp.hh"
+#include "rl_lapackpp.hh"
+
+#include <RandBLAS.hh>
+#include <cstdint>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+using namespace std::chrono;
+
+namespace RandLAPACK {
+
+/// CQRRPT factorization of a tall matrix that grows by appending rows.
+///
+/// The object keeps the d-by-n sketch A_hat = S * A, the column pivots J and the R-factor of A[:, J].
+/// Since the columns of a SASO are independent, appending rows to A appends columns to S,
+/// and the sketch is updated with the contribution of the new rows only.
+/// R is updated through a triangular-pentagonal QR (TPQRT) of R stacked on top of the new rows,
+/// which only eliminates the new rows and keeps R's triangular structure.
+/// The cost of an update is O(nnz * m_new * n + m_new * n^2 + n^2), the last term being the pivot check;
+/// it does not depend on the number of rows seen so far.
+///
+/// The pivots J are kept fixed across updates for as long as R remains rank-revealing.
+/// The quality of the pivots is measured by
+///     pivot_quality = max over i < rank, j > i of ||R[i:, j]|| / |R[i, i]|,
+/// which QRCP keeps at 1. Once it exceeds 'pivot_tol', the pivots are refreshed from the current sketch,
+/// and R is re-triangularized by a QR of its permuted columns. None of this requires access to the rows of A.
+template <typename T, typename RNG>
+class CQRRPT_updatable {
+    public:
+
+        /// The numerical rank is the number of leading diagonal entries of R with |R[i, i]| > eps * max_{l <= i} |R[l, l]|.
+        /// 'pivot_tol' defaults to 10.
+        CQRRPT_updatable(
+            bool time_subroutines,
+            T ep
+        ) {
+            timing = time_subroutines;
+            eps = ep;
+            nnz = 2;
+            pivot_tol = 10.0;
+            num_repivots = 0;
+            m = 0;
+            n = 0;
+            d = 0;
+            rank = 0;
+            R_rows = 0;
+        }
+
+        /// Computes the initial factorization A[:, J] = QR, same as CQRRPT, and stores the sketch of A.
+        ///
+        /// @param[in] m
+        ///     The number of rows in the matrix A.
+        ///
+        /// @param[in] n
+        ///     The number of columns in the matrix A.
+        ///
+        /// @param[in] A
+        ///     The m-by-n matrix A, stored in a column-major format.
+        ///
+        /// @param[in] d_factor
+        ///     Embedding dimension of the sketch is d = d_factor * n.
+        ///
+        /// @param[in] state
+        ///     RNG state parameter, required for sketching operator generation.
+        ///     A copy of it is kept for sketching the rows appended later.
+        ///
+        /// @param[out] A
+        ///     Overwritten by an m-by-k orthogonal Q factor.
+        ///
+        /// @return = 0: successful exit
+        ///
+        int factor(
+            int64_t m,
+            int64_t n,
+            T* A,
+            int64_t lda,
+            T d_factor,
+            RandBLAS::RNGState<RNG> &state
+        );
+
+        /// Appends m_new rows to A and updates the sketch, R and (if needed) J.
+        ///
+        /// @param[in] m_new
+        ///     The number of the new rows.
+        ///
+        /// @param[in] A_new
+        ///     The m_new-by-n block of the new rows, stored in a column-major format. Not modified.
+        ///
+        /// @return = 0: the pivots were kept
+        ///
+        /// @return = 1: the pivots were refreshed
+        ///
+        int update(
+            int64_t m_new,
+            const T* A_new,
+            int64_t lda_new
+        );
+
+        /// Computes the pivot quality measure of the current R, in O(n^2) operations.
+        T pivot_quality();
+
+        /// Recomputes the pivots from the current sketch and re-triangularizes R accordingly.
+        void repivot();
+
+    private:
+        /// Rank estimate from the diagonal of R.
+        int64_t estimate_rank();
+
+    public:
+        bool timing;
+        T eps;
+        int64_t nnz;
+        T pivot_tol;
+
+        // The current state of the factorization
+        int64_t m;
+        int64_t n;
+        int64_t d;
+        int64_t rank;
+        // The number of rows stored in R, min(m, n) after the first update.
+        int64_t R_rows;
+        int64_t num_repivots;
+        // d-by-n sketch of A
+        std::vector<T> A_hat;
+        // n-by-n upper-triangular R-factor of A[:, J]; only the leading R_rows rows are meaningful.
+        std::vector<T> R;
+        std::vector<int64_t> J;
+        RandBLAS::RNGState<RNG> state;
+
+        // 4 entries: sketch update, R update, pivot check and refresh, total
+        std::vector<long> times;
+
+        // Buffers reused across updates
+        std::vector<T> A_stack;
+        std::vector<T> A_sk_qr;
+        std::vector<T> tau;
+        std::vector<T> T_dat;
+        std::vector<int64_t> J_inv;
+};
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int CQRRPT_updatable<T, RNG>::factor(
+    int64_t m,
+    int64_t n,
+    T* A,
+    int64_t lda,
+    T d_factor,
+    RandBLAS::RNGState<RNG> &state
+){
+    int64_t d = d_factor * n;
+    // A constant for initial rank estimation.
+    T eps_initial_rank_estimation = 2 * std::pow(std::numeric_limits<T>::epsilon(), 0.95);
+
+    this->m = m;
+    this->n = n;
+    this->d = d;
+    this->num_repivots = 0;
+    util::upsize(d * n, this->A_hat);
+    util::upsize(d * n, this->A_sk_qr);
+    util::upsize(n, this->tau);
+    this->R.assign(n * n, 0.0);
+    this->J.assign(n, 0);
+    this->J_inv.assign(n, 0);
+    std::vector<T> R_sp(n * n, 0.0);
+    std::vector<int64_t> J_buf(n, 0);
+
+    /// Generating and applying a SASO
+    RandBLAS::SparseDist DS = {.n_rows = d, .n_cols = m, .vec_nnz = this->nnz};
+    RandBLAS::SparseSkOp<T, RNG> S(DS, state);
+    state = RandBLAS::fill_sparse(S);
+    this->state = state;
+    RandBLAS::sketch_general(
+        Layout::ColMajor, Op::NoTrans, Op::NoTrans,
+        d, n, m, (T) 1.0, S, 0, 0, A, lda, (T) 0.0, this->A_hat.data(), d
+    );
+
+    /// QRCP on a copy of the sketch, which has to be kept for the updates
+    lapack::lacpy(MatrixType::General, d, n, this->A_hat.data(), d, this->A_sk_qr.data(), d);
+    lapack::geqp3(d, n, this->A_sk_qr.data(), d, this->J.data(), this->tau.data());
+
+    int64_t k = n;
+    for(int64_t i = 0; i < n; ++i) {
+        if(std::abs(this->A_sk_qr[i * d + i]) / std::abs(this->A_sk_qr[0]) < eps_initial_rank_estimation) {
+            k = i;
+            break;
+        }
+    }
+    lapack::lacpy(MatrixType::Upper, k, k, this->A_sk_qr.data(), d, R_sp.data(), k);
+    lapack::lacpy(MatrixType::Upper, k, n, this->A_sk_qr.data(), d, this->R.data(), n);
+
+    /// Cholesky QR on the preconditioned A[:, J[0:k]]
+    util::col_swap(m, n, k, A, lda, this->J.data(), J_buf.data());
+    blas::trsm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, m, k, (T) 1.0, R_sp.data(), k, A, lda);
+    blas::syrk(Layout::ColMajor, Uplo::Upper, Op::Trans, k, m, (T) 1.0, A, lda, (T) 0.0, R_sp.data(), k);
+    lapack::potrf(Uplo::Upper, k, R_sp.data(), k);
+    blas::trsm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, m, k, (T) 1.0, R_sp.data(), k, A, lda);
+    blas::trmm(Layout::ColMajor, Side::Left, Uplo::Upper, Op::NoTrans, Diag::NonUnit, k, n, (T) 1.0, R_sp.data(), k, this->R.data(), n);
+
+    this->R_rows = k;
+    this->rank = this->estimate_rank();
+
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int CQRRPT_updatable<T, RNG>::update(
+    int64_t m_new,
+    const T* A_new,
+    int64_t lda_new
+){
+    ///--------------------TIMING VARS--------------------/
+    high_resolution_clock::time_point sketch_t_start;
+    high_resolution_clock::time_point r_update_t_start;
+    high_resolution_clock::time_point pivot_t_start;
+    high_resolution_clock::time_point total_t_start;
+    long sketch_t_dur   = 0;
+    long r_update_t_dur = 0;
+    long pivot_t_dur    = 0;
+    long total_t_dur    = 0;
+
+    if(this -> timing) {
+        total_t_start = high_resolution_clock::now();
+        sketch_t_start = high_resolution_clock::now();
+    }
+
+    int64_t n = this->n;
+    int64_t d = this->d;
+    int repivoted = 0;
+
+    /// The new columns of the SASO only touch the new rows of A.
+    /// Each of them needs nnz nonzeros, which puts the vectors of the operator along its long axis
+    /// unless more than d rows are appended at once.
+    RandBLAS::MajorAxis axis = (m_new < d) ? RandBLAS::MajorAxis::Long : RandBLAS::MajorAxis::Short;
+    RandBLAS::SparseDist DS = {.n_rows = d, .n_cols = m_new, .vec_nnz = this->nnz, .major_axis = axis};
+    RandBLAS::SparseSkOp<T, RNG> S(DS, this->state);
+    this->state = RandBLAS::fill_sparse(S);
+    RandBLAS::sketch_general(
+        Layout::ColMajor, Op::NoTrans, Op::NoTrans,
+        d, n, m_new, (T) 1.0, S, 0, 0, A_new, lda_new, (T) 1.0, this->A_hat.data(), d
+    );
+
+    if(this -> timing) {
+        sketch_t_dur = duration_cast<microseconds>(high_resolution_clock::now() - sketch_t_start).count();
+        r_update_t_start = high_resolution_clock::now();
+    }
+
+    /// QR of [R; A_new[:, J]] gives the R-factor of the extended A[:, J].
+    /// R is n-by-n upper-triangular, with zeros below its leading R_rows rows, so TPQRT with l = 0
+    /// factors the stack in place, only eliminating the m_new rows of A_new[:, J].
+    if(m_new > 0 && n > 0) {
+        int64_t nb = std::min(n, (int64_t) 32);
+        util::upsize(m_new * n, this->A_stack);
+        util::upsize(nb * n, this->T_dat);
+        T* A_stack = this->A_stack.data();
+        for(int64_t j = 0; j < n; ++j)
+            blas::copy(m_new, &A_new[lda_new * (this->J[j] - 1)], 1, &A_stack[m_new * j], 1);
+        lapack::tpqrt(m_new, n, 0, nb, this->R.data(), n, A_stack, m_new, this->T_dat.data(), nb);
+
+        // Rows of R past the R_rows + m_new rows of the stack are zero up to the rounding.
+        this->R_rows = std::min(this->R_rows + m_new, n);
+        for(int64_t j = this->R_rows; j < n; ++j)
+            std::fill(&this->R[n * j + this->R_rows], &this->R[n * j + j + 1], (T) 0.0);
+    }
+    this->m += m_new;
+    this->rank = this->estimate_rank();
+
+    if(this -> timing) {
+        r_update_t_dur = duration_cast<microseconds>(high_resolution_clock::now() - r_update_t_start).count();
+        pivot_t_start = high_resolution_clock::now();
+    }
+
+    /// Refresh the pivots once R stops being rank-revealing.
+    if(this->pivot_quality() > this->pivot_tol) {
+        this->repivot();
+        repivoted = 1;
+    }
+
+    if(this -> timing) {
+        pivot_t_dur = duration_cast<microseconds>(high_resolution_clock::now() - pivot_t_start).count();
+        total_t_dur = duration_cast<microseconds>(high_resolution_clock::now() - total_t_start).count();
+        this -> times = {sketch_t_dur, r_update_t_dur, pivot_t_dur, total_t_dur};
+    }
+
+    return repivoted;
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+T CQRRPT_updatable<T, RNG>::pivot_quality(){
+    int64_t n = this->n;
+    const T* R = this->R.data();
+    // Squared norms of the trailing parts of the columns of R, downdated one row at a time.
+    std::vector<T> norms(n, 0.0);
+    for(int64_t j = 0; j < n; ++j) {
+        int64_t len = std::min(j + 1, this->R_rows);
+        norms[j] = blas::dot(len, &R[n * j], 1, &R[n * j], 1);
+    }
+
+    T quality = 0.0;
+    for(int64_t i = 0; i < this->rank; ++i) {
+        T r_ii = std::abs(R[n * i + i]);
+        for(int64_t j = i + 1; j < n; ++j) {
+            quality = std::max(quality, std::sqrt(std::max(norms[j], (T) 0.0)) / r_ii);
+            norms[j] -= R[n * j + i] * R[n * j + i];
+        }
+    }
+    return quality;
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+void CQRRPT_updatable<T, RNG>::repivot(){
+    int64_t n = this->n;
+    int64_t d = this->d;
+    int64_t r = this->R_rows;
+    std::vector<int64_t> J_new(n, 0);
+
+    /// New pivots from the QRCP of the sketch.
+    lapack::lacpy(MatrixType::General, d, n, this->A_hat.data(), d, this->A_sk_qr.data(), d);
+    lapack::geqp3(d, n, this->A_sk_qr.data(), d, J_new.data(), this->tau.data());
+
+    /// A[:, J_new] = A[:, J] * P = Q * (R * P), so R is replaced by the R-factor of R * P.
+    for(int64_t j = 0; j < n; ++j)
+        this->J_inv[this->J[j] - 1] = j;
+    util::upsize(r * n, this->A_stack);
+    T* R_perm = this->A_stack.data();
+    for(int64_t j = 0; j < n; ++j) {
+        int64_t col = this->J_inv[J_new[j] - 1];
+        int64_t len = std::min(col + 1, r);
+        blas::copy(len, &this->R[n * col], 1, &R_perm[r * j], 1);
+        std::fill(&R_perm[r * j + len], &R_perm[r * j + r], (T) 0.0);
+    }
+    lapack::geqrf(r, n, R_perm, r, this->tau.data());
+
+    std::fill(this->R.begin(), this->R.end(), (T) 0.0);
+    lapack::lacpy(MatrixType::Upper, r, n, R_perm, r, this->R.data(), n);
+    this->J = J_new;
+    this->rank = this->estimate_rank();
+    ++this->num_repivots;
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int64_t CQRRPT_updatable<T, RNG>::estimate_rank(){
+    int64_t n = this->n;
+    const T* R = this->R.data();
+    // The diagonal of R is not sorted after the updates, so we need to keep the running max.
+    T running_max = 0.0;
+
+    for(int64_t i = 0; i < this->R_rows; ++i) {
+        T curr_entry = std::abs(R[i * n + i]);
+        running_max = std::max(running_max, curr_entry);
+        if(curr_entry <= this->eps * running_max)
+            return i;
+    }
+    return this->R_rows;
+}
+
+} // end namespace RandLAPACK
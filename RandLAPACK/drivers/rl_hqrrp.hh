@@ -44,16 +44,27 @@ WITHOUT ANY WARRANTY EXPRESSED OR IMPLIED.
 
 #include "rl_blaspp.hh"
 #include "rl_lapackpp.hh"
+#include "rl_util.hh"
+#include "rl_sparse.hh"
+#include "rl_sketch_qrcp.hh"
 
 #include <RandBLAS.hh>
 #include <lapack/fortran.h>
 #include <lapack/config.h>
 #include <chrono>
+#include <future>
+#include <numeric>
 
 // Matrices with dimensions larger than THRESHOLD_FOR_DGEQP3 are processed 
 // with the new HQRRP code.
 #define THRESHOLD_FOR_DGEQP3  2
 
+// The column norms of matrices with at least THRESHOLD_FOR_PARALLEL_NORMS entries
+// are computed by multiple threads. The same goes for the downdating of the norms
+// of at least THRESHOLD_FOR_PARALLEL_DOWNDATE columns.
+#define THRESHOLD_FOR_PARALLEL_NORMS     65536
+#define THRESHOLD_FOR_PARALLEL_DOWNDATE  4096
+
 // ============================================================================
 // Definition of macros.
 #define dabs( a )    ( (a) >= 0.0 ? (a) : -(a) )
@@ -183,19 +194,19 @@ template <typename T>
 int64_t NoFLA_Apply_Q_WY_rnfc_blk_var4( 
     int64_t n_U, T * buff_U, int64_t ldim_U,
     T * buff_T, int64_t ldim_T, int64_t m_B, 
-    int64_t n_B, T * buff_B, int64_t ldim_B ) {
+    int64_t n_B, T * buff_B, int64_t ldim_B,
+    T * buff_W ) {
 //
 // It applies a block transformation Q to a matrix B from the right:
 //   B = B * Q
 // where:
 //   Q = I - U * T' * U'.
 //
-    T  * buff_W;
+// "buff_W": scratch space of at least m_B * n_U entries.
+//
     int64_t   ldim_W;
 
-    // Create auxiliary object.
     //// FLA_Obj_create_conf_to( FLA_TRANSPOSE, B1, & W );
-    buff_W = ( T * ) calloc( m_B * n_U, sizeof( T ) );
     ldim_W = std::max<int64_t>( 1, m_B );
 
     // Apply the block transformation. 
@@ -205,9 +216,6 @@ int64_t NoFLA_Apply_Q_WY_rnfc_blk_var4(
         buff_B, ldim_B, buff_W, ldim_W
     );
 
-    // Remove auxiliary object.
-    free( buff_W );
-
     return 0;
 }
 
@@ -221,25 +229,24 @@ int64_t NoFLA_Downdate_Y(
     T * buff_T, int64_t ldim_T,
     int64_t m_Y2, int64_t n_Y2, T * buff_Y2, int64_t ldim_Y2,
     int64_t m_G1, int64_t n_G1, T * buff_G1, int64_t ldim_G1,
-    int64_t n_G2, T * buff_G2, int64_t ldim_G2 ) {
+    int64_t n_G2, T * buff_G2, int64_t ldim_G2,
+    T * buff_B, T * buff_W ) {
 //
 // It downdates matrix Y, and updates matrix G.
 // Only Y2 of Y is updated.
 // Only G1 and G2 of G are updated.
 //
 // Y2 = Y2 - ( G1 - ( G1*U11 + G2*U21 ) * T11 * U11' ) * R12.
+//
+// "buff_B" and "buff_W": scratch spaces of at least m_G1 * n_G1 and m_G1 * n_U11 entries.
 //
     int64_t    i, j;
-    T * buff_B;
     T d_one       = 1.0;
     T d_minus_one = -1.0;
     int64_t    m_B         = m_G1;
     int64_t    n_B         = n_G1;
     int64_t    ldim_B      = m_G1;
 
-    // Create object B.
-    buff_B = ( T * ) calloc( m_B * n_B, sizeof( T ) );
-
     // B = G1.
     lapack::lacpy( MatrixType::General,
                     m_G1, n_G1,
@@ -297,10 +304,7 @@ int64_t NoFLA_Downdate_Y(
     NoFLA_Apply_Q_WY_rnfc_blk_var4( 
         n_U11, buff_U11, ldim_U11,
         buff_T, ldim_T, m_G1, 
-        n_G1 + n_G2, buff_G1, ldim_G1 );
-
-    // Remove object B.
-    free( buff_B );
+        n_G1 + n_G2, buff_G1, ldim_G1, buff_W );
 
     return 0;
 }
@@ -310,7 +314,8 @@ template <typename T>
 int64_t NoFLA_Apply_Q_WY_lhfc_blk_var4( 
     int64_t n_U, T * buff_U, int64_t ldim_U,
     T * buff_T, int64_t ldim_T, int64_t m_B, 
-    int64_t n_B, T * buff_B, int64_t ldim_B ) {
+    int64_t n_B, T * buff_B, int64_t ldim_B,
+    T * buff_W ) {
 //
 // It applies the transpose of a block transformation Q to a matrix B from 
 // the left:
@@ -318,12 +323,11 @@ int64_t NoFLA_Apply_Q_WY_lhfc_blk_var4(
 // where:
 //   Q = I - U * T' * U'.
 //
-    T  * buff_W;
+// "buff_W": scratch space of at least n_B * n_U entries.
+//
     int64_t     ldim_W;
 
-    // Create auxiliary object.
     //// FLA_Obj_create_conf_to( FLA_NO_TRANSPOSE, B1, & W );
-    buff_W = ( T * ) calloc( n_B * n_U, sizeof( T ) );
     ldim_W = std::max<int64_t>( 1, n_B );
 
     // Apply the block transformation.
@@ -336,31 +340,49 @@ int64_t NoFLA_Apply_Q_WY_lhfc_blk_var4(
     buff_W, ldim_W
     );
 
-    // Remove auxiliary object.
-    free( buff_W );
-
     return 0;
 }
 
+// ============================================================================
+template <typename T>
+T NoFLA_QRP_column_norm(
+    int64_t m_A, const T * buff_A ) {
+//
+// It computes the 2-norm of a column of length m_A.
+// The squares are accumulated in SIMD lanes (the compiler contracts the
+// square-accumulate into FMAs). As opposed to nrm2, the sum is not scaled,
+// so nrm2 is called whenever it may have overflowed or lost accuracy to underflow.
+//
+    T sum = 0.0;
+    #pragma omp simd reduction(+:sum)
+    for( int64_t i = 0; i < m_A; i++ ) {
+        sum += buff_A[ i ] * buff_A[ i ];
+    }
+
+    if( sum >= std::numeric_limits<T>::min() / std::numeric_limits<T>::epsilon() &&
+        sum <= std::numeric_limits<T>::max() ) {
+        return std::sqrt( sum );
+    }
+    return blas::nrm2( m_A, buff_A, 1 );
+}
+
 // ============================================================================
 template <typename T>
 int64_t NoFLA_QRP_compute_norms(
     int64_t m_A, int64_t n_A, T * buff_A, int64_t ldim_A,
-    T * buff_d, T * buff_e ) {
+    T * buff_d, T * buff_e, bool parallel ) {
     //
     // It computes the column norms of matrix A. The norms are stored int64_to 
     // vectors d and e.
+    // "parallel": if true, the columns are split among threads.
     //
 
-    int64_t     j, i_one = 1;
+    int64_t     j;
     // Main loop.
-    //#pragma omp parallel for
+    #pragma omp parallel for schedule(static) if(parallel)
     for( j = 0; j < n_A; j++ ) {
-        * buff_d = blas::nrm2(m_A, buff_A, i_one);
-        * buff_e = * buff_d;
-        buff_A += ldim_A;
-        buff_d++;
-        buff_e++;
+        buff_d[ j ] = NoFLA_QRP_column_norm( m_A, & buff_A[ j * ldim_A ] );
+        buff_e[ j ] = buff_d[ j ];
     }
 
     return 0;
@@ -373,51 +395,41 @@ static int64_t NoFLA_QRP_downdate_partial_norms(
     T * buff_d,  int64_t st_d,
     T * buff_e,  int64_t st_e,
     T * buff_wt, int64_t st_wt,
-    T * buff_A,  int64_t ldim_A ) {
+    T * buff_A,  int64_t ldim_A,
+    bool parallel ) {
 //
 // It updates (downdates) the column norms of matrix A. It uses Drmac's method.
+// "parallel": if true, the norms that have to be recomputed are split among threads.
 //
-    int64_t     j, i_one = 1;
-    T  * ptr_d, * ptr_e, * ptr_wt, * ptr_A;
-    T  temp, temp2, temp5, tol3z;
-    // T dnrm2_(), dlamch_();
+    int64_t     j;
+    T  tol3z;
 
     // Some initializations.
-    char dlmach_param = 'E';
-    tol3z = sqrt( LAPACK_dlamch( & dlmach_param
-    #ifdef LAPACK_FORTRAN_STRLEN_END
-    //, 1
-    #endif
-    ) );
-    ptr_d  = buff_d;
-    ptr_e  = buff_e;
-    ptr_wt = buff_wt;
-    ptr_A  = buff_A;
+    // The relative machine precision, as returned by LAPACK's lamch( 'E' ).
+    tol3z = std::sqrt( std::numeric_limits<T>::epsilon() / 2 );
 
-    // Main loop.
-    //#pragma omp parallel for
+    // Downdating pass, free of branches so that it vectorizes.
+    // Columns whose norms have lost too much accuracy are marked with -1.
+    #pragma omp simd
     for( j = 0; j < n_A; j++ ) {
-    if( * ptr_d != 0.0 ) {
-        temp = dabs( * ptr_wt ) / * ptr_d;
-        temp = std::max( 0.0, ( 1.0 + temp ) * ( 1 - temp ) );
-        temp5 = * ptr_d / * ptr_e;
-        temp2 = temp * temp5 * temp5;
-        if( temp2 <= tol3z ) {
-            if( m_A > 0 ) {
-                * ptr_d = blas::nrm2( m_A, ptr_A, i_one );
-                * ptr_e = *ptr_d;
-            } else {
-                * ptr_d = 0.0;
-                * ptr_e = 0.0;
-            }
-        } else {
-            * ptr_d = * ptr_d * sqrt( temp );
+        T d     = buff_d[ j * st_d ];
+        T e     = buff_e[ j * st_e ];
+        bool nz = ( d != 0.0 );
+        T temp  = nz ? dabs( buff_wt[ j * st_wt ] ) / d : (T) 0.0;
+        temp    = std::max( (T) 0.0, ( 1 + temp ) * ( 1 - temp ) );
+        T temp5 = nz ? d / e : (T) 0.0;
+        T temp2 = temp * temp5 * temp5;
+        buff_d[ j * st_d ] = ( nz && temp2 <= tol3z ) ? (T) -1.0 : d * std::sqrt( temp );
+    }
+
+    // Recomputing pass.
+    #pragma omp parallel for schedule(dynamic, 16) if(parallel)
+    for( j = 0; j < n_A; j++ ) {
+        if( buff_d[ j * st_d ] < 0.0 ) {
+            T nrm = ( m_A > 0 ) ? NoFLA_QRP_column_norm( m_A, & buff_A[ j * ldim_A ] ) : (T) 0.0;
+            buff_d[ j * st_d ] = nrm;
+            buff_e[ j * st_e ] = nrm;
         }
-    } 
-    ptr_A  += ldim_A;
-    ptr_d  += st_d;
-    ptr_e  += st_e;
-    ptr_wt += st_wt;
     }
 
     return 0;
@@ -479,10 +491,12 @@ static int64_t GEQRF_mod_WY(
         int64_t num_stages,
         int64_t m_A, int64_t n_A, T * buff_A, int64_t ldim_A,
         T * buff_t,
-        T * buff_T, int64_t ldim_T
+        T * buff_T, int64_t ldim_T,
+        T * buff_work, int64_t lwork
 ) {
     //
     // Simplification of NoFLA_QRPmod_WY_unb_var4 for the case when pivoting=0.
+    // "buff_work" holds lwork >= n_A entries; GEQRF picks its block size to fit.
     //
 
     // Some initializations.
@@ -491,13 +505,7 @@ static int64_t GEQRF_mod_WY(
 
     // run unpivoted Householder QR on buff_A.
     int64_t info[1];
-    T work_query[1];
-    int64_t lwork[1];
-    lwork[0] = -1;
-    _LAPACK_geqrf(m_A, n_A, buff_A, ldim_A, buff_t, work_query, lwork, info);
-    lwork[0] = std::max((int64_t) blas::real(work_query[0]), n_A);
-    T *buff_workspace = ( T * ) calloc( lwork[0], sizeof( T ) );
-    _LAPACK_geqrf(m_A, n_A, buff_A, ldim_A, buff_t, buff_workspace, lwork, info);
+    _LAPACK_geqrf(m_A, n_A, buff_A, ldim_A, buff_t, buff_work, &lwork, info);
 
     // Build T.
     lapack::larft( lapack::Direction::Forward,
@@ -506,15 +514,10 @@ static int64_t GEQRF_mod_WY(
                     buff_t, buff_T, ldim_T
     );
 
-    // Remove auxiliary vectors.
-    free( buff_workspace );
-
     return 0;
 }
 
 // ==========================================================================
-// TODO: pre-allocate workspace
-
 template <typename T>
 static int64_t CHOLQR_mod_WY(
         int64_t num_stages,
@@ -572,7 +575,8 @@ int64_t NoFLA_QRPmod_WY_unb_var4(
     int64_t * buff_p, T * buff_t, 
     int64_t pivot_B, int64_t m_B, T * buff_B, int64_t ldim_B,
     int64_t pivot_C, int64_t m_C, T * buff_C, int64_t ldim_C,
-    int64_t build_T, T * buff_T, int64_t ldim_T, T* buff_R, int64_t ldim_R, T* buff_D, T* timing) {
+    int64_t build_T, T * buff_T, int64_t ldim_T, T* buff_R, int64_t ldim_R, T* buff_D,
+    T * buff_work, int64_t lwork, T* timing) {
 //
 // "pivoting": If pivoting==1, then QR factorization with pivoting is used.
 //
@@ -589,10 +593,12 @@ int64_t NoFLA_QRPmod_WY_unb_var4(
 // "build_T": if "build_T" is true, matrix "T" is built.
 //    The typical use-case for this function is to call with build_T=true.
 //    Calling with build_T=false is only done at HQRRP's last iteration.
+//
+// "buff_work": scratch space of lwork >= 3 * n_A entries.
 //
     /*--------------------------------CUSTOM APPROACHES TO QR WITH NO PANEL PIVOTING--------------------------------*/
     if (!pivoting && (qr_type == 1)) {
-        return GEQRF_mod_WY(num_stages, m_A, n_A, buff_A, ldim_A, buff_t, buff_T, ldim_T);
+        return GEQRF_mod_WY(num_stages, m_A, n_A, buff_A, ldim_A, buff_t, buff_T, ldim_T, buff_work, lwork);
     } else if (!pivoting && (qr_type == 2)) {
         return CHOLQR_mod_WY(num_stages, m_A, n_A, buff_A, ldim_A, buff_t, buff_T, ldim_T, buff_R, ldim_R, buff_D);
     }
@@ -639,10 +645,10 @@ int64_t NoFLA_QRPmod_WY_unb_var4(
     num_stages = mn_A;
     }
 
-    // Create auxiliary vectors.
-    buff_d         = ( T * ) calloc( n_A, sizeof( T ) );
-    buff_e         = ( T * ) calloc( n_A, sizeof( T ) );
-    buff_workspace = ( T * ) calloc( n_A, sizeof( T ) );
+    // Auxiliary vectors.
+    buff_d         = buff_work;
+    buff_e         = & buff_work[ n_A ];
+    buff_workspace = & buff_work[ 2 * n_A ];
 
     if(timing != nullptr) {
         preallocation_t_stop = high_resolution_clock::now();
@@ -651,7 +657,8 @@ int64_t NoFLA_QRPmod_WY_unb_var4(
     }
     if( pivoting == 1 ) {
         // Compute initial norms of A int64_to d and e.
-        NoFLA_QRP_compute_norms( m_A, n_A, buff_A, ldim_A, buff_d, buff_e );
+        NoFLA_QRP_compute_norms( m_A, n_A, buff_A, ldim_A, buff_d, buff_e,
+            m_A * n_A >= THRESHOLD_FOR_PARALLEL_NORMS );
     }
     if(timing != nullptr) {
         norms_t_stop = high_resolution_clock::now();
@@ -733,7 +740,8 @@ int64_t NoFLA_QRPmod_WY_unb_var4(
                 & buff_d[ j+1 ], 1,
                 & buff_e[ j+1 ], 1,
                 & buff_A[ j + ( j+1 ) * ldim_A ], ldim_A,
-                & buff_A[ ( j+1 ) + std::min( n_A-1, ( j+1 ) ) * ldim_A ], ldim_A );
+                & buff_A[ ( j+1 ) + std::min( n_A-1, ( j+1 ) ) * ldim_A ], ldim_A,
+                n_A22 >= THRESHOLD_FOR_PARALLEL_DOWNDATE );
         }
         if(timing != nullptr) {
             downdating_t_stop = high_resolution_clock::now();
@@ -756,17 +764,6 @@ int64_t NoFLA_QRPmod_WY_unb_var4(
     if(timing != nullptr) {
         gen_T_t_stop = high_resolution_clock::now();
         gen_T_t_dur  = duration_cast<microseconds>(gen_T_t_stop - gen_T_t_start).count();
-        preallocation_t_start = high_resolution_clock::now();
-    }
-
-    // Remove auxiliary vectors.
-    free( buff_d );
-    free( buff_e );
-    free( buff_workspace );
-
-    if(timing != nullptr) {
-        preallocation_t_stop = high_resolution_clock::now();
-        preallocation_t_dur  += duration_cast<microseconds>(preallocation_t_stop - preallocation_t_start).count();
     }
 
     if(timing != nullptr) {
@@ -815,16 +812,134 @@ int64_t NoFLA_QRPmod_WY_unb_var4(
 // panel_pivoting: If panel_pivoting==1, QR with pivoting is applied to 
 //                 factorize the panels of matrix A. Otherwise, QR without 
 //                 pivoting is used. Usual value for panel_pivoting is 1.
+// sketch_qrcp:    Optional QRCP of the sketch, used instead of the built-in
+//                 one to select the pivots of every block. Only its pivots
+//                 are used. nullptr (default) keeps the built-in QRCP.
+// lookahead:      If lookahead > 0, the update of the trailing matrix is split.
+//                 The rows of R12 are computed first, and Y is downdated,
+//                 so that the pivots of the next block can be selected.
+//                 The columns of the next panel are then updated and factored
+//                 on "lookahead" threads, while the rest of A22 is updated on
+//                 the remaining threads. lookahead = 0 (default) keeps the
+//                 panels in sequence, as does running on a single OpenMP thread.
+//                 The results match those of the sequential version, up to
+//                 the rounding in the blocked updates.
+// sketch_nnz:     If sketch_nnz > 0, G is a sparse sign matrix with sketch_nnz
+//                 nonzeros per column (see util::sparse_sign_block), and
+//                 Y = G * A is formed in O(m_A * n_A * sketch_nnz) operations
+//                 instead of a dense gemm. G is still stored as a dense matrix,
+//                 since it is updated along with Y. sketch_nnz = 0 (default)
+//                 uses a dense uniform G.
 // Final comments:
 // ---------------
 // This code has been created from a libflame code. Hence, you can find some
 // commented calls to libflame routines. We have left them to make it easier
 // to interpret the meaning of the C code.
+//
+// Workspace:
+// ----------
+// The overload taking (work, work_bytes) places all auxiliary matrices
+// (Y, V, W, G, R, D), as well as the scratch space of the helper kernels above,
+// into a caller-owned, 64-byte-aligned buffer of at least
+// hqrrp_workspace_query<T>(m_A, n_A, nb_alg, pp, sketch_nnz) bytes, and makes no allocations
+// of its own, irrespective of the number of panels. The one exception is the lookahead,
+// which starts a helper thread for every panel; 'sketch_qrcp' is responsible for its own allocations.
+// The overload without it allocates such a buffer internally.
+
+// Number of scratch entries for the QR and QRCP of the panels and the sketch.
+inline int64_t hqrrp_qr_work_size(
+    int64_t n_A, int64_t nb_alg) {
+    return std::max( 3 * n_A, nb_alg * nb_alg );
+}
+
+// Number of columns of a sparse G generated at a time, and its number of nonzeros per column.
+inline int64_t hqrrp_sketch_block_cols(
+    int64_t m_A, int64_t sketch_nnz) {
+    return sketch_nnz > 0 ? std::min( m_A, util::sparse_sketch_block_cols ) : 0;
+}
+
+// ============================================================================
+template <typename T, typename RNG>
+RandBLAS::RNGState<RNG> NoFLA_Sparse_sketch(
+    int64_t m_G, int64_t sketch_nnz,
+    int64_t m_A, int64_t n_A, const T * buff_A, int64_t ldim_A,
+    T * buff_G, int64_t ldim_G,
+    T * buff_Y, int64_t ldim_Y,
+    int64_t * buff_SR, T * buff_SV,
+    const RandBLAS::RNGState<RNG> &state ) {
+//
+// It generates a sparse sign matrix G, stored as a dense matrix,
+// and computes Y = G * A without a gemm.
+// G is generated in blocks of columns, whose rows and values are kept
+// in "buff_SR" and "buff_SV".
+//
+    int64_t b = hqrrp_sketch_block_cols( m_A, sketch_nnz );
+    auto next_state = state;
+
+    for( int64_t j = 0; j < m_A; j++ )
+        std::fill( & buff_G[ j * ldim_G ], & buff_G[ j * ldim_G + m_G ], (T) 0.0 );
+    for( int64_t j = 0; j < n_A; j++ )
+        std::fill( & buff_Y[ j * ldim_Y ], & buff_Y[ j * ldim_Y + m_G ], (T) 0.0 );
+
+    for( int64_t row_start = 0; row_start < m_A; row_start += b ) {
+        int64_t rows = std::min( b, m_A - row_start );
+        next_state = util::sparse_sign_block( m_G, sketch_nnz, rows, buff_SR, buff_SV, next_state );
+
+        for( int64_t i = 0; i < rows; i++ )
+            for( int64_t p = 0; p < sketch_nnz; p++ )
+                buff_G[ buff_SR[ p + sketch_nnz * i ] + ( row_start + i ) * ldim_G ] += buff_SV[ p + sketch_nnz * i ];
+
+        // Row i of A is scattered into the rows of Y selected by column i of G.
+        // Four columns of Y are updated at a time, for independent updates.
+        #pragma omp parallel for schedule(static)
+        for( int64_t j = 0; j < n_A; j += 4 ) {
+            int64_t n_cols = std::min<int64_t>( 4, n_A - j );
+            const T * buff_Aj = & buff_A[ row_start + j * ldim_A ];
+            T * buff_Yj       = & buff_Y[ j * ldim_Y ];
+            for( int64_t i = 0; i < rows; i++ ) {
+                for( int64_t p = 0; p < sketch_nnz; p++ ) {
+                    int64_t r = buff_SR[ p + sketch_nnz * i ];
+                    T v       = buff_SV[ p + sketch_nnz * i ];
+                    for( int64_t c = 0; c < n_cols; c++ )
+                        buff_Yj[ r + c * ldim_Y ] += v * buff_Aj[ i + c * ldim_A ];
+                }
+            }
+        }
+    }
+    return next_state;
+}
+
+// Returns the size (in bytes) of the workspace required by hqrrp.
+template <typename T>
+int64_t hqrrp_workspace_query(
+    int64_t m_A, int64_t n_A, int64_t nb_alg, int64_t pp, int64_t sketch_nnz = 0) {
+
+    if( std::min( m_A, n_A ) == 0 )
+        return 0;
+
+    int64_t nnz_block = std::min( sketch_nnz, nb_alg + pp ) * hqrrp_sketch_block_cols( m_A, sketch_nnz );
+
+    return 2 * util::workspace_bytes<T>( ( nb_alg + pp ) * n_A )  // Y, V
+            + util::workspace_bytes<T>( nb_alg * n_A )            // W
+            + util::workspace_bytes<T>( ( nb_alg + pp ) * m_A )   // G
+            + util::workspace_bytes<T>( nb_alg * nb_alg )         // R
+            + util::workspace_bytes<T>( nb_alg )                  // D
+            + util::workspace_bytes<T>( nb_alg + pp )             // tau of the sketch
+            + 2 * util::workspace_bytes<int64_t>( n_A )           // pivots of the sketch, scratch
+            + util::workspace_bytes<T>( nb_alg * n_A )            // scratch for updating A
+            + 2 * util::workspace_bytes<T>( ( nb_alg + pp ) * nb_alg )  // scratch for downdating Y
+            + util::workspace_bytes<T>( hqrrp_qr_work_size( n_A, nb_alg ) )   // scratch for the QR of the panels
+            + util::workspace_bytes<T>( nb_alg * nb_alg )         // unit lower triangle of a panel, for lookahead
+            + util::workspace_bytes<int64_t>( nnz_block )         // rows and values of a block of a sparse G
+            + util::workspace_bytes<T>( nnz_block );
+}
+
 template <typename T, typename RNG>
 int64_t hqrrp( 
     int64_t m_A, int64_t n_A, T * buff_A, int64_t ldim_A,
     int64_t * buff_jpvt, T * buff_tau,
-    int64_t nb_alg, int64_t pp, int64_t panel_pivoting, int64_t qr_type, RandBLAS::RNGState<RNG> &state, T* timing) {
+    int64_t nb_alg, int64_t pp, int64_t panel_pivoting, int64_t qr_type, RandBLAS::RNGState<RNG> &state, T* timing,
+    void * work, int64_t work_bytes, SketchQRCP* sketch_qrcp = nullptr, int64_t lookahead = 0, int64_t sketch_nnz = 0) {
 
     //-------TIMING VARS--------/
     high_resolution_clock::time_point preallocation_t_stop;
@@ -852,15 +967,11 @@ int64_t hqrrp(
     long updating_Sketch_t_dur = 0;
     long total_t_dur           = 0;
 
-    // Buffer for QRCP timing.
-    T* timing_QRCP = nullptr;
-    // Buffer for QR timing.
-    T* timing_QR   = nullptr;
-
-    if(timing != nullptr) {
-        timing_QRCP = ( T * ) calloc( 10, sizeof( T ) );
-        timing_QR   = ( T * ) calloc( 10, sizeof( T ) );
-    }
+    // Buffers for QRCP and QR timing.
+    T timing_QRCP_buf[10] = {};
+    T timing_QR_buf[10]   = {};
+    T* timing_QRCP = ( timing != nullptr ) ? timing_QRCP_buf : nullptr;
+    T* timing_QR   = ( timing != nullptr ) ? timing_QR_buf   : nullptr;
 
     if(timing != nullptr) {
         total_t_start = high_resolution_clock::now();
@@ -876,9 +987,13 @@ int64_t hqrrp(
             * buff_AR, * buff_AB1, * buff_A01, * buff_Y1, * buff_T1_T,
             * buff_A11, * buff_A21, * buff_A12,
             * buff_Y2, * buff_G, * buff_G1, * buff_G2, * buff_R, * buff_D;
-    int64_t * buff_p, * buff_pB, * buff_p1;
-    T  d_zero = 0.0;
-    T  d_one  = 1.0;
+    int64_t * buff_p, * buff_pB, * buff_p1, * buff_pS, * buff_pW;
+    T  * buff_tS, * buff_WA, * buff_BY, * buff_WY, * buff_work, * buff_L11, * buff_SV;
+    int64_t * buff_SR;
+    int64_t lwork;
+    T  d_zero      = 0.0;
+    T  d_one       = 1.0;
+    T  d_minus_one = -1.0;
 
     // Executable Statements.
 
@@ -902,30 +1017,60 @@ int64_t hqrrp(
     }
 
     // Create auxiliary objects.
+    // Y and G are fully overwritten before use, the rest is zero-initialized.
+    util::Workspace ws( work, work_bytes );
+
     m_Y     = nb_alg + pp;
     n_Y     = n_A;
-    buff_Y  = ( T * ) calloc( m_Y * n_Y, sizeof( T ) );
+    buff_Y  = ws.take<T>( m_Y * n_Y );
     ldim_Y  = m_Y;
 
     m_V     = nb_alg + pp;
     n_V     = n_A;
-    buff_V  = ( T * ) calloc( m_V * n_V, sizeof( T ) );
+    buff_V  = ws.take<T>( m_V * n_V, true );
     ldim_V  = m_V;
 
     m_W     = nb_alg;
     n_W     = n_A;
-    buff_W  = ( T * ) calloc( m_W * n_W, sizeof( T ) );
+    buff_W  = ws.take<T>( m_W * n_W, true );
     ldim_W  = m_W;
 
     m_G     = nb_alg + pp;
     n_G     = m_A;
-    buff_G  = ( T * ) calloc( m_G * n_G, sizeof( T ) );
+    buff_G  = ws.take<T>( m_G * n_G );
     ldim_G  = m_G;
 
     // Required for CHolesky QR
     ldim_R = nb_alg;
-    buff_R  = ( T * ) calloc( nb_alg * nb_alg, sizeof( T ) );
-    buff_D  = ( T * ) calloc( nb_alg, sizeof( T ) );
+    buff_R  = ws.take<T>( nb_alg * nb_alg, true );
+    buff_D  = ws.take<T>( nb_alg, true );
+
+    // Required for an external QRCP of the sketch
+    buff_tS = ws.take<T>( nb_alg + pp );
+    buff_pS = ws.take<int64_t>( n_A );
+    buff_pW = ws.take<int64_t>( n_A );
+
+    // Scratch space of the helper kernels, reused by every panel
+    buff_WA   = ws.take<T>( nb_alg * n_A );
+    buff_BY   = ws.take<T>( ( nb_alg + pp ) * nb_alg );
+    buff_WY   = ws.take<T>( ( nb_alg + pp ) * nb_alg );
+    lwork     = hqrrp_qr_work_size( n_A, nb_alg );
+    buff_work = ws.take<T>( lwork );
+    buff_L11  = ws.take<T>( nb_alg * nb_alg );
+
+    // Required for a sparse G
+    sketch_nnz = std::min( sketch_nnz, nb_alg + pp );
+    buff_SR   = ws.take<int64_t>( std::max<int64_t>( 0, sketch_nnz ) * hqrrp_sketch_block_cols( m_A, sketch_nnz ) );
+    buff_SV   = ws.take<T>( std::max<int64_t>( 0, sketch_nnz ) * hqrrp_sketch_block_cols( m_A, sketch_nnz ) );
+
+    // Lookahead-related: whether the panel of the current iteration has been factored
+    // at the end of the previous one, and the thread counts for the two sides of the overlap.
+    // With a single thread there is nothing to overlap, and the panels are done in sequence.
+    int64_t panel_factored = 0;
+    int threads_total = util::max_threads();
+    int threads_la    = (int) std::min<int64_t>( std::max<int64_t>( lookahead, 1 ), std::max( threads_total - 1, 1 ) );
+    int threads_upd   = std::max( 1, threads_total - threads_la );
+    bool use_lookahead = lookahead > 0 && threads_total > 1;
 
     if(timing != nullptr) {
         preallocation_t_stop = high_resolution_clock::now();
@@ -934,13 +1079,18 @@ int64_t hqrrp(
     }
 
     // Initialize matrices G and Y.
-    RandBLAS::DenseDist D(nb_alg + pp, m_A, RandBLAS::DenseDistName::Uniform);
-    state = RandBLAS::fill_dense(D, buff_G, state).second;
-    
-    blas::gemm(Layout::ColMajor,
-                Op::NoTrans, Op::NoTrans, m_Y, n_Y, m_A, 
-                d_one, buff_G,  ldim_G, buff_A, ldim_A, 
-                d_zero, buff_Y, ldim_Y );
+    if( sketch_nnz > 0 ) {
+        state = NoFLA_Sparse_sketch( m_G, sketch_nnz, m_A, n_A, buff_A, ldim_A,
+                                     buff_G, ldim_G, buff_Y, ldim_Y, buff_SR, buff_SV, state );
+    } else {
+        RandBLAS::DenseDist D(nb_alg + pp, m_A, RandBLAS::DenseDistName::Uniform);
+        state = RandBLAS::fill_dense(D, buff_G, state).second;
+
+        blas::gemm(Layout::ColMajor,
+                    Op::NoTrans, Op::NoTrans, m_Y, n_Y, m_A, 
+                    d_one, buff_G,  ldim_G, buff_A, ldim_A, 
+                    d_zero, buff_Y, ldim_Y );
+    }
     
     if(timing != nullptr) {
         sketching_t_stop  = high_resolution_clock::now();
@@ -1034,7 +1184,7 @@ int64_t hqrrp(
             downdating_t_dur  += duration_cast<microseconds>(downdating_t_stop - downdating_t_start).count();
         }
 
-        if( !last_iter ) {
+        if( !last_iter && !panel_factored ) {
             // Compute QRP of YR, and apply permutations to matrix AR.
             // A copy of YR is made into VR, and permutations are applied to YR.
             //
@@ -1055,15 +1205,23 @@ int64_t hqrrp(
             if(timing != nullptr)
                 qrcp_t_start    = high_resolution_clock::now();
 
-            NoFLA_QRPmod_WY_unb_var4(0, 1, b,
-                m_V, n_VR,
-                buff_VR, ldim_V,
-                buff_pB, buff_sB,
-                1, m_A, buff_AR, ldim_A,
-                1, m_Y, buff_YR, ldim_Y,
-                0, (T*) nullptr, 0, (T*) nullptr, 0, (T*) nullptr,
-                timing_QRCP 
-            );
+            if( sketch_qrcp != nullptr ) {
+                // Only the pivots are needed; they are applied to AR, YR and the pivot vector.
+                sketch_qrcp->call( m_V, n_VR, buff_VR, ldim_V, buff_pS, buff_tS );
+                util::col_swap( m_A, n_VR, n_VR, buff_AR, ldim_A, buff_pS, buff_pW );
+                util::col_swap( m_Y, n_VR, n_VR, buff_YR, ldim_Y, buff_pS, buff_pW );
+                util::col_swap<T>( n_VR, n_VR, buff_pB, buff_pS, buff_pW );
+            } else {
+                NoFLA_QRPmod_WY_unb_var4(0, 1, b,
+                    m_V, n_VR,
+                    buff_VR, ldim_V,
+                    buff_pB, buff_sB,
+                    1, m_A, buff_AR, ldim_A,
+                    1, m_Y, buff_YR, ldim_Y,
+                    0, (T*) nullptr, 0, (T*) nullptr, 0, (T*) nullptr,
+                    buff_work, lwork, timing_QRCP 
+                );
+            }
 
             if(timing != nullptr) {
                 qrcp_t_stop = high_resolution_clock::now();
@@ -1093,11 +1251,13 @@ int64_t hqrrp(
         if(timing != nullptr)
             qr_t_start = high_resolution_clock::now();
 
-        NoFLA_QRPmod_WY_unb_var4(qr_type, panel_pivoting, -1,
-            m_AB1, n_AB1, buff_AB1, ldim_A, buff_p1, buff_s1,
-            1, j, buff_A01, ldim_A,
-            1, m_Y, buff_Y1, ldim_Y,
-            1, buff_T1_T, ldim_W, buff_R, ldim_R, buff_D, timing_QR);
+        if( !panel_factored ) {
+            NoFLA_QRPmod_WY_unb_var4(qr_type, panel_pivoting, -1,
+                m_AB1, n_AB1, buff_AB1, ldim_A, buff_p1, buff_s1,
+                1, j, buff_A01, ldim_A,
+                1, m_Y, buff_Y1, ldim_Y,
+                1, buff_T1_T, ldim_W, buff_R, ldim_R, buff_D, buff_work, lwork, timing_QR);
+        }
 
         if(timing != nullptr) {
             qr_t_stop = high_resolution_clock::now();
@@ -1108,7 +1268,26 @@ int64_t hqrrp(
         //
         // Update the rest of the matrix.
         //
-        if ( ( j + b ) < n_A ) {
+        if ( use_lookahead && ! last_iter ) {
+            // Only the rows of R12 are updated here, the rest of the update
+            // is overlapped with the next panel below. With QB1 = I - U * T1 * U' and U = [ U11; U21 ]:
+            //   WA  = T1' * U' * | A12 |,   A12 := A12 - U11 * WA,   and later   A22 := A22 - U21 * WA.
+            //                    | A22 |
+            lapack::lacpy( MatrixType::General, b, n_A12, buff_A12, ldim_A, buff_WA, nb_alg );
+            blas::trmm( Layout::ColMajor, Side::Left, Uplo::Lower, Op::Trans, Diag::Unit,
+                        b, n_A12, d_one, buff_A11, ldim_A, buff_WA, nb_alg );
+            blas::gemm( Layout::ColMajor, Op::Trans, Op::NoTrans, b, n_A12, m_A22,
+                        d_one, buff_A21, ldim_A, & buff_A12[ b ], ldim_A, d_one, buff_WA, nb_alg );
+            blas::trmm( Layout::ColMajor, Side::Left, Uplo::Upper, Op::Trans, Diag::NonUnit,
+                        b, n_A12, d_one, buff_T1_T, ldim_W, buff_WA, nb_alg );
+
+            // U11 with its unit diagonal made explicit.
+            lapack::laset( MatrixType::Upper, b, b, d_zero, d_one, buff_L11, nb_alg );
+            if( b > 1 )
+                lapack::lacpy( MatrixType::Lower, b - 1, b - 1, & buff_A11[ 1 ], ldim_A, & buff_L11[ 1 ], nb_alg );
+            blas::gemm( Layout::ColMajor, Op::NoTrans, Op::NoTrans, b, n_A12, b,
+                        d_minus_one, buff_L11, nb_alg, buff_WA, nb_alg, d_one, buff_A12, ldim_A );
+        } else if ( ( j + b ) < n_A ) {
             // Apply the Householder transforms associated with AB1 = [ A11; A21 ] 
             // and T1_T to [ A12; A22 ]:
             //   | A12 | := QB1' | A12 |
@@ -1117,7 +1296,7 @@ int64_t hqrrp(
             NoFLA_Apply_Q_WY_lhfc_blk_var4( 
             n_A11, buff_A11, ldim_A,
             buff_T1_T, ldim_W, m_A12 + m_A22, 
-            n_A12, buff_A12, ldim_A );
+            n_A12, buff_A12, ldim_A, buff_WA );
         }
 
         if(timing != nullptr) {
@@ -1137,13 +1316,112 @@ int64_t hqrrp(
                 buff_T1_T, ldim_T1_T,
                 m_Y, std::max<int64_t>( 0, n_Y - j - b ), buff_Y2, ldim_Y,
                 m_G, b, buff_G1, ldim_G,
-                std::max<int64_t>( 0, n_G - j - b ), buff_G2, ldim_G );
+                std::max<int64_t>( 0, n_G - j - b ), buff_G2, ldim_G,
+                buff_BY, buff_WY );
         }
 
         if(timing != nullptr) {
             updating_Sketch_t_stop = high_resolution_clock::now();
             updating_Sketch_t_dur  += duration_cast<microseconds>(updating_Sketch_t_stop - updating_Sketch_t_start).count();
         }
+
+        panel_factored = 0;
+
+        //
+        // Lookahead: pivots and the panel of the next iteration.
+        //
+        if ( use_lookahead && ! last_iter ) {
+            int64_t j_next    = j + b;
+            int64_t b_next    = std::min( nb_alg, std::min( n_A - j_next, m_A - j_next ) );
+            int64_t last_next = ( ( ( j_next + nb_alg >= m_A )||( j_next + nb_alg >= n_A ) ) ? 1 : 0 );
+            T * buff_A22      = & buff_A12[ b ];
+
+            if(timing != nullptr)
+                qrcp_t_start = high_resolution_clock::now();
+
+            if( ! last_next ) {
+                // The pivots are found as in the sequential version, but they are applied to A through col_swap,
+                // since the columns of WA, which hold the pending update of A22, have to follow them.
+                int64_t n_R       = n_A - j_next;
+                int64_t * buff_pR = & buff_p[ j_next ];
+                T * buff_YN       = & buff_Y[ 0 + j_next * ldim_Y ];
+                T * buff_VN       = & buff_V[ 0 + j_next * ldim_V ];
+                int64_t k_swap;
+
+                lapack::lacpy( MatrixType::General, m_V, n_R, buff_YN, ldim_Y, buff_VN, ldim_V );
+                if( sketch_qrcp != nullptr ) {
+                    sketch_qrcp->call( m_V, n_R, buff_VN, ldim_V, buff_pS, buff_tS );
+                    util::col_swap( m_Y, n_R, n_R, buff_YN, ldim_Y, buff_pS, buff_pW );
+                    k_swap = n_R;
+                } else {
+                    std::iota( buff_pS, & buff_pS[ n_R ], 1 );
+                    NoFLA_QRPmod_WY_unb_var4(0, 1, b_next,
+                        m_V, n_R,
+                        buff_VN, ldim_V,
+                        buff_pS, & buff_s[ j_next ],
+                        0, 0, (T*) nullptr, 0,
+                        1, m_Y, buff_YN, ldim_Y,
+                        0, (T*) nullptr, 0, (T*) nullptr, 0, (T*) nullptr,
+                        buff_work, lwork, timing_QRCP
+                    );
+                    k_swap = b_next;
+                }
+                util::col_swap( m_A, n_R, k_swap, & buff_A[ 0 + j_next * ldim_A ], ldim_A, buff_pS, buff_pW );
+                util::col_swap( b, n_R, k_swap, buff_WA, nb_alg, buff_pS, buff_pW );
+                util::col_swap<T>( n_R, k_swap, buff_pR, buff_pS, buff_pW );
+            }
+
+            if(timing != nullptr) {
+                qrcp_t_stop = high_resolution_clock::now();
+                qrcp_t_dur  += duration_cast<microseconds>(qrcp_t_stop - qrcp_t_start).count();
+                qr_t_start  = high_resolution_clock::now();
+            }
+
+            // A22 minus the columns of the next panel is updated on threads_upd threads,
+            // while the next panel is updated and factored on threads_la threads.
+            auto updating_A = std::async( std::launch::async, [&]() {
+                #if defined(_OPENMP)
+                omp_set_num_threads( threads_upd );
+                #endif
+                blas::gemm( Layout::ColMajor, Op::NoTrans, Op::NoTrans, m_A22, n_A12 - b_next, b,
+                            d_minus_one, buff_A21, ldim_A, & buff_WA[ b_next * nb_alg ], nb_alg,
+                            d_one, & buff_A22[ b_next * ldim_A ], ldim_A );
+            });
+
+            #if defined(_OPENMP)
+            omp_set_num_threads( threads_la );
+            #endif
+
+            blas::gemm( Layout::ColMajor, Op::NoTrans, Op::NoTrans, m_A22, b_next, b,
+                        d_minus_one, buff_A21, ldim_A, buff_WA, nb_alg,
+                        d_one, buff_A22, ldim_A );
+
+            NoFLA_QRPmod_WY_unb_var4(qr_type, panel_pivoting, -1,
+                m_A - j_next, b_next, & buff_A[ j_next + j_next * ldim_A ], ldim_A,
+                & buff_p[ j_next ], & buff_s[ j_next ],
+                1, j_next, & buff_A[ 0 + j_next * ldim_A ], ldim_A,
+                1, m_Y, & buff_Y[ 0 + j_next * ldim_Y ], ldim_Y,
+                1, & buff_W[ 0 + j_next * ldim_W ], ldim_W, buff_R, ldim_R, buff_D, buff_work, lwork, timing_QR);
+
+            #if defined(_OPENMP)
+            omp_set_num_threads( threads_total );
+            #endif
+
+            if(timing != nullptr) {
+                qr_t_stop = high_resolution_clock::now();
+                qr_t_dur  += duration_cast<microseconds>(qr_t_stop - qr_t_start).count();
+                updating_A_t_start = high_resolution_clock::now();
+            }
+
+            // Only the part of updating A22 that did not overlap with the above is timed.
+            updating_A.get();
+            panel_factored = 1;
+
+            if(timing != nullptr) {
+                updating_A_t_stop = high_resolution_clock::now();
+                updating_A_t_dur  += duration_cast<microseconds>(updating_A_t_stop - updating_A_t_start).count();
+            }
+        }
     }
 
     if(timing != nullptr) {
@@ -1168,9 +1446,6 @@ int64_t hqrrp(
         timing[10] = (T) total_t_dur;
         blas::copy(9, timing_QRCP, 1, &timing[11], 1);
         blas::copy(9, timing_QR,   1, &timing[20], 1);
-
-        free( timing_QRCP );
-        free( timing_QR );
         
         printf("\n\n/------------HQRRP TIMING RESULTS BEGIN------------/\n");
         printf("Preallocation time: %25ld μs,\n",                  preallocation_t_dur);
@@ -1194,15 +1469,87 @@ int64_t hqrrp(
         printf("/-------------CQRRP TIMING RESULTS END-------------/\n\n");
     }
 
-    // Remove auxiliary objects.
-    free( buff_G );
-    free( buff_Y );
-    free( buff_V );
-    free( buff_W );
-    free( buff_R );
-    free( buff_D );
-
     return 0;
 }
 
+template <typename T, typename RNG>
+int64_t hqrrp( 
+    int64_t m_A, int64_t n_A, T * buff_A, int64_t ldim_A,
+    int64_t * buff_jpvt, T * buff_tau,
+    int64_t nb_alg, int64_t pp, int64_t panel_pivoting, int64_t qr_type, RandBLAS::RNGState<RNG> &state, T* timing,
+    SketchQRCP* sketch_qrcp = nullptr, int64_t lookahead = 0, int64_t sketch_nnz = 0) {
+
+    int64_t work_bytes = hqrrp_workspace_query<T>( m_A, n_A, nb_alg, pp, sketch_nnz );
+    void * work = util::workspace_alloc( work_bytes );
+
+    int64_t info = hqrrp( m_A, n_A, buff_A, ldim_A, buff_jpvt, buff_tau,
+                            nb_alg, pp, panel_pivoting, qr_type, state, timing,
+                            work, work_bytes, sketch_qrcp, lookahead, sketch_nnz );
+    free( work );
+    return info;
+}
+
+/// QRCP of the sketch with hqrrp, with the sketching operators of hqrrp drawn from 'state'.
+/// The workspace of hqrrp is kept between calls, and only grows.
+template <typename RNG>
+class HQRRP_QRCP : public SketchQRCP {
+    public:
+        HQRRP_QRCP(
+            RandBLAS::RNGState<RNG> st
+        ) : state(st) {
+            nb_alg         = 64;
+            oversampling   = 10;
+            panel_pivoting = 1;
+            qr_type        = 0;
+            work           = nullptr;
+            work_bytes     = 0;
+        }
+
+        ~HQRRP_QRCP() {
+            free(this->work);
+        }
+
+        HQRRP_QRCP(const HQRRP_QRCP &) = delete;
+        HQRRP_QRCP &operator=(const HQRRP_QRCP &) = delete;
+
+        int call(int64_t d, int64_t n, double* A_sk, int64_t lda, int64_t* J, double* tau) override {
+            return this->qrcp(d, n, A_sk, lda, J, tau);
+        }
+
+        int call(int64_t d, int64_t n, float* A_sk, int64_t lda, int64_t* J, float* tau) override {
+            return this->qrcp(d, n, A_sk, lda, J, tau);
+        }
+
+    public:
+        RandBLAS::RNGState<RNG> state;
+        int64_t nb_alg;
+        int64_t oversampling;
+        int64_t panel_pivoting;
+        // Panel QR without panel pivoting: 1 - GEQRF, 2 - Cholesky QR
+        int64_t qr_type;
+
+    private:
+        void* work;
+        int64_t work_bytes;
+
+        template <typename T>
+        int qrcp(
+            int64_t d,
+            int64_t n,
+            T* A_sk,
+            int64_t lda,
+            int64_t* J,
+            T* tau
+        ) {
+            int64_t bytes = hqrrp_workspace_query<T>( d, n, nb_alg, oversampling );
+            if( bytes > this->work_bytes ) {
+                free( this->work );
+                this->work       = util::workspace_alloc( bytes );
+                this->work_bytes = bytes;
+            }
+            std::iota(J, &J[n], 1);
+            return hqrrp( d, n, A_sk, lda, J, tau, nb_alg, oversampling, panel_pivoting, qr_type, state, (T*) nullptr, this->work, this->work_bytes );
+        }
+};
+
 } // end namespace RandLAPACK
@@ -1,9 +1,11 @@
 #pragma once
 
 #include "rl_util.hh"
+#include "rl_lapack_work.hh"
 #include "rl_blaspp.hh"
 #include "rl_lapackpp.hh"
 #include "rl_hqrrp.hh"
+#include "rl_linops.hh"
 
 #include <RandBLAS.hh>
 #include <cstdint>
@@ -17,6 +19,9 @@ using namespace std::chrono;
 
 namespace RandLAPACK {
 
+/// Second Gram-Schmidt pass of RBKI, see RBKI::reorth.
+enum reorth_policy {cgs2, cgs2_fused, cgs2_selective};
+
 template <typename T, typename RNG>
 class RBKIalg {
     public:
@@ -61,6 +66,16 @@ class RBKI : public RBKIalg<T, RNG> {
             timing = time_subroutines;
             tol = ep;
             max_krylov_iters = INT_MAX;
+            init_krylov_iters = 8;
+            two_pass = false;
+            k_target = 0;
+            residual_tol = ep;
+            residual_check_freq = 4;
+            reorth = cgs2;
+            reorth_threshold = 1 / std::sqrt((T) 2.0);
+            num_reorths = 0;
+            replay_tol = std::pow(std::numeric_limits<T>::epsilon(), (T) 0.75);
+            replay_err = 0;
         }
 
         /// Computes an SVD of the form:
@@ -94,16 +109,44 @@ class RBKI : public RBKIalg<T, RNG> {
         ///     RNG state parameter, required for sketching operator generation.
         ///
         /// @param[out] U
-        ///     Stores m by ((num_iters / 2) * k) orthonormal matrix of left singular vectors.
+        ///     Stores m by (((num_iters + 1) / 2) * k) orthonormal matrix of left singular vectors,
+        ///     or only its first k_target columns if k_target > 0.
         ///
         /// @param[out] VT
-        ///     Stores ((num_iters / 2) * k) * n orthonormal matrix of right singular vectors.
+        ///     Stores (((num_iters + 1) / 2) * k) * n orthonormal matrix of right singular vectors,
+        ///     or only its first k_target rows if k_target > 0.
         ///
         /// @param[out] Sigma
-        ///     Stores ((num_iters / 2) * k) singular values. 
+        ///     Stores (((num_iters + 1) / 2) * k) singular values. 
         ///
         /// @return = 0: successful exit
         ///
+        /// @return = 1: (two_pass only) the second pass did not reproduce R and S, see call_two_pass() below;
+        ///              U and VT are not valid. The overloads that allocate their own workspace never return 1:
+        ///              they rerun the algorithm with the full bases stored instead.
+        ///
+        /// The space for the Krylov bases, R and S is reserved for init_krylov_iters iterations at first,
+        /// and doubled every time more iterations are needed, with the used portions copied over.
+        /// The bases are thus moved O(log(num_krylov_iters)) times, rather than at every iteration.
+        ///
+        /// If two_pass is set, only two blocks of each basis are stored; see call_two_pass() below.
+        ///
+        /// If k_target > 0, the algorithm additionally stops once the leading k_target singular triplets have converged:
+        /// every residual_check_freq iterations, the SVD of R or S from the previous iteration is computed, and the residuals
+        ///     ||A' u_i - sigma_i v_i|| (or ||A v_i - sigma_i u_i||), i = 1, ..., k_target,
+        /// are found from the block that the current iteration has appended to S (or R), without touching A.
+        /// The triplets are accepted once all of these are at most residual_tol * sigma_1.
+        /// Only the k_target leading left and right singular vectors are then formed.
+        ///
+        /// Every new block of X_ev and Y_od is orthogonalized against the preceding ones with block classical Gram-Schmidt,
+        /// done twice. The reorth parameter sets how the second pass is done:
+        ///     cgs2           - the two passes follow one another, reading the basis four times.
+        ///     cgs2_fused     - the subtraction of the first pass and the projection of the second pass are done together,
+        ///                      one panel of basis rows at a time, so that the basis is read three times.
+        ///     cgs2_selective - the second pass is skipped unless some column of the new block has lost more than
+        ///                      a factor of reorth_threshold of its norm in the first pass. The norm before the first pass
+        ///                      is found from the norm after it and the new band entries of R or S.
+        /// num_reorths counts the second passes done in the last call.
 
         int call(
             int64_t m,
@@ -116,12 +159,260 @@ class RBKI : public RBKIalg<T, RNG> {
             T* Sigma,
             RandBLAS::RNGState<RNG> &state
         ) override;
+
+        /// Returns the size (in bytes) of the workspace that the call() overload below
+        /// requires for an m by n input and block size k.
+        /// The capacity of the Krylov basis is planned from max_krylov_iters;
+        /// the number of iterations never exceeds 2 * (n / k), as R and S would not fit into their leading dimensions otherwise.
+        int64_t workspace_query(
+            int64_t m,
+            int64_t n,
+            int64_t k
+        );
+
+        /// Same as above, but all internal buffers are placed into a caller-owned workspace
+        /// of at least workspace_query(m, n, k) bytes, aligned to 64 bytes.
+        /// No heap allocations are made by the algorithm itself,
+        /// so repeated calls on same-sized problems can reuse one workspace.
+        int call(
+            int64_t m,
+            int64_t n,
+            T* A,
+            int64_t lda,
+            int64_t k,
+            T* U,
+            T* VT,
+            T* Sigma,
+            RandBLAS::RNGState<RNG> &state,
+            void* work,
+            int64_t work_bytes
+        );
+
+        /// Same as the above two, for an m by n A that is only accessible through its products
+        /// with blocks of vectors, A * Y_i and A' * X_i, and its (estimated) Frobenius norm;
+        /// see LinearOperator in rl_linops.hh.
+        /// The dense versions above are wrappers around these, with A represented by an ExplicitLinOp.
+        /// For a mixed-precision run, A can be a MixedPrecisionLinOp<T, float>: the products with A are then
+        /// done in float, while the Krylov bases, their orthogonalization and QR, and the SVD of R or S stay in T.
+        /// The singular triplets are then only accurate to about eps(float) * ||A||_F.
+        int call(
+            LinearOperator<T> &A,
+            int64_t k,
+            T* U,
+            T* VT,
+            T* Sigma,
+            RandBLAS::RNGState<RNG> &state
+        );
+
+        int call(
+            LinearOperator<T> &A,
+            int64_t k,
+            T* U,
+            T* VT,
+            T* Sigma,
+            RandBLAS::RNGState<RNG> &state,
+            void* work,
+            int64_t work_bytes
+        );
+
+        /// Same as the above two, but with a warm start: the first k_init columns of the n by k starting block
+        /// are copied from Y_init, an n by k_init matrix with leading dimension ldy, and only the remaining
+        /// k - k_init columns are drawn from a Gaussian distribution.
+        /// For a matrix that changed little since a previous call, the leading right singular vectors found then
+        /// (V = VT' from that call) make a good starting block, and fewer iterations are needed for the same accuracy;
+        /// compare num_krylov_iters (and times, if timing is set) against a cold start.
+        /// A few random columns (k_init < k) help when the singular subspace has drifted.
+        int call(
+            LinearOperator<T> &A,
+            int64_t k,
+            T* U,
+            T* VT,
+            T* Sigma,
+            RandBLAS::RNGState<RNG> &state,
+            const T* Y_init,
+            int64_t ldy,
+            int64_t k_init
+        );
+
+        int call(
+            LinearOperator<T> &A,
+            int64_t k,
+            T* U,
+            T* VT,
+            T* Sigma,
+            RandBLAS::RNGState<RNG> &state,
+            const T* Y_init,
+            int64_t ldy,
+            int64_t k_init,
+            void* work,
+            int64_t work_bytes
+        );
+    private:
+        /// Forms the n by k starting block Y of the iterations, see the warm-start call() above.
+        /// With k_init = 0, Y is Gaussian.
+        void starting_block(
+            int64_t n,
+            int64_t k,
+            const T* Y_init,
+            int64_t ldy,
+            int64_t k_init,
+            T* Y,
+            RandBLAS::RNGState<RNG> &state
+        );
+
+        /// Orthogonalizes the p by k block B against the p by cols orthonormal basis Q, given the coefficients of its
+        /// projection onto Q, C = Q' * B (or, if C_trans is set, C' = Q' * B, stored as a k by cols matrix):
+        /// B = B - Q * C, followed by the second pass that reorth calls for.
+        /// The coefficients of the second pass, a cols by k matrix, are placed into orth_buf.
+        /// Returns true if the second pass was done.
+        bool orthogonalize(
+            int64_t p,
+            int64_t k,
+            int64_t cols,
+            const T* Q,
+            int64_t ldq,
+            const T* C,
+            int64_t ldc,
+            bool C_trans,
+            T* B,
+            int64_t ldb,
+            T* orth_buf
+        );
+
+        /// Upper bound on the number of Krylov iterations for an n-column input and block size k.
+        int64_t max_iters_bound(
+            int64_t n,
+            int64_t k
+        );
+
+        /// Residual-based convergence check, see call() above.
+        /// Takes the SVD of R' or S as it was after 'iters' iterations, using the space that remains in ws,
+        /// and bounds the residuals of its leading k_target triplets through the block appended by the next iteration.
+        /// R and S are read with leading dimensions n and n + k.
+        bool triplets_converged(
+            int64_t n,
+            int64_t k,
+            int64_t iters,
+            const T* R,
+            const T* S,
+            util::Workspace ws
+        );
+
+        /// Size of the work array of GEQRF and UNGQR on the m by k and n by k blocks of the bases.
+        int64_t qr_work_size(
+            int64_t m,
+            int64_t n,
+            int64_t k
+        );
+
+        /// Size of the work array of GESDD on R' or S after up to 'iters' iterations.
+        int64_t svd_work_size(
+            int64_t k,
+            int64_t iters
+        );
+
+        /// Size (in bytes) of the scratch space that triplets_converged() needs on top of U_hat and VT_hat,
+        /// for up to 'iters' iterations.
+        int64_t workspace_query_triplets(
+            int64_t n,
+            int64_t k,
+            int64_t iters
+        );
+
+        /// Size (in bytes) of the workspace of call_two_pass() below, with space for dense copies of R and S
+        /// after 'iters' iterations.
+        int64_t workspace_query_two_pass(
+            int64_t m,
+            int64_t n,
+            int64_t k,
+            int64_t iters
+        );
+
+        /// Size (in bytes) of the part of the above that holds the dense copies of R and S,
+        /// the SVD factors and the scratch space of triplets_converged().
+        int64_t workspace_query_two_pass_end(
+            int64_t n,
+            int64_t k,
+            int64_t iters
+        );
+
+        /// Size (in bytes) of a workspace that holds the Krylov bases, R and S for 'iters' iterations.
+        int64_t workspace_query_iters(
+            int64_t m,
+            int64_t n,
+            int64_t k,
+            int64_t iters
+        );
+
+        /// The algorithm itself. The workspace holds 'cap_iters' iterations.
+        /// If 'grow' is set, it is replaced by one twice as large whenever more iterations are needed;
+        /// otherwise, cap_iters must not be smaller than max_iters_bound(n, k).
+        int call_krylov(
+            LinearOperator<T> &A,
+            int64_t k,
+            T* U,
+            T* VT,
+            T* Sigma,
+            RandBLAS::RNGState<RNG> &state,
+            const T* Y_init,
+            int64_t ldy,
+            int64_t k_init,
+            void* work,
+            int64_t work_bytes,
+            int64_t cap_iters,
+            bool grow
+        );
+
+        /// Low-memory version of the algorithm, used when two_pass is set.
+        /// Only the current and the previous blocks of X_ev and Y_od are kept, and every new block
+        /// is orthogonalized against the previous one alone, as in the block Lanczos recurrence
+        /// (R and S are block-bidiagonal in exact arithmetic).
+        /// R and S are thus stored as bands of 2 * k rows: column block j holds the diagonal block j
+        /// and the block under it. Dense copies are only formed for the residual checks and the final SVD,
+        /// in space reserved for 'cap_iters' iterations, which is reallocated twice as large when
+        /// more iterations are needed if 'grow' is set.
+        /// Once the SVD of R or S is known, the recurrence is replayed from the same RNG state,
+        /// and U = X_ev * U_hat and VT = VT_hat * Y_od' are accumulated block by block.
+        /// This costs an extra pass of products with A and A', but the memory does not grow with the
+        /// basis size. The replay relies on BLAS and LAPACK producing the same results for the same inputs,
+        /// which threaded or run-to-run nondeterministic BLAS does not guarantee. Every block of R and S is thus
+        /// regenerated in the replay and compared against the recorded one; replay_err is set to the largest
+        /// Frobenius norm difference. If it exceeds replay_tol * ||A||_F, U and VT do not match Sigma,
+        /// state is reset to its value on entry, and 1 is returned.
+        /// Without the full reorthogonalization, the bases lose orthogonality once singular triplets converge,
+        /// and spurious copies of the converged singular values may appear in Sigma. The mode is thus meant
+        /// for runs that stop well before the leading triplets are resolved to machine precision.
+        int call_two_pass(
+            LinearOperator<T> &A,
+            int64_t k,
+            T* U,
+            T* VT,
+            T* Sigma,
+            RandBLAS::RNGState<RNG> &state,
+            const T* Y_init,
+            int64_t ldy,
+            int64_t k_init,
+            void* work,
+            int64_t work_bytes,
+            int64_t cap_iters,
+            bool grow
+        );
     public:
         bool verbose;
         bool timing;
         T tol;
         int num_krylov_iters;
         int max_krylov_iters;
+        int init_krylov_iters;
+        bool two_pass;
+        int64_t k_target;
+        T residual_tol;
+        int residual_check_freq;
+        reorth_policy reorth;
+        T reorth_threshold;
+        int num_reorths;
+        T replay_tol;
+        T replay_err;
         std::vector<long> times;
         T norm_R_end;
 
@@ -129,6 +420,202 @@ class RBKI : public RBKIalg<T, RNG> {
         int num_threads_rest;
 };
 
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+bool RBKI<T, RNG>::orthogonalize(
+    int64_t p,
+    int64_t k,
+    int64_t cols,
+    const T* Q,
+    int64_t ldq,
+    const T* C,
+    int64_t ldc,
+    bool C_trans,
+    T* B,
+    int64_t ldb,
+    T* orth_buf
+){
+    Op op_C = C_trans ? Op::Trans : Op::NoTrans;
+
+    if (this->reorth == cgs2_fused) {
+        // Panels of Q rows small enough to stay in cache between the two products below.
+        int64_t panel = std::max(k, (int64_t) (1 << 20) / (int64_t) (sizeof(T) * (cols + k)));
+        for (int64_t i = 0; i < p; i += panel) {
+            int64_t rows = std::min(panel, p - i);
+            // B_i = B_i - Q_i * C
+            blas::gemm(Layout::ColMajor, Op::NoTrans, op_C, rows, k, cols, -1.0, &Q[i], ldq, C, ldc, 1.0, &B[i], ldb);
+            // orth_buf += Q_i' * B_i
+            blas::gemm(Layout::ColMajor, Op::Trans, Op::NoTrans, cols, k, rows, 1.0, &Q[i], ldq, &B[i], ldb, (i == 0) ? 0.0 : 1.0, orth_buf, cols);
+        }
+        blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, p, k, cols, -1.0, Q, ldq, orth_buf, cols, 1.0, B, ldb);
+        return true;
+    }
+
+    // B = B - Q * C
+    blas::gemm(Layout::ColMajor, Op::NoTrans, op_C, p, k, cols, -1.0, Q, ldq, C, ldc, 1.0, B, ldb);
+
+    if (this->reorth == cgs2_selective) {
+        // The column norms before the projection are sqrt(||b_j||^2 + ||c_j||^2), as long as Q is orthonormal.
+        bool lost = false;
+        for (int64_t j = 0; j < k && !lost; ++j) {
+            T b_nrm = blas::nrm2(p, &B[ldb * j], 1);
+            T c_nrm = C_trans ? blas::nrm2(cols, &C[j], ldc) : blas::nrm2(cols, &C[ldc * j], 1);
+            lost = b_nrm < this->reorth_threshold * std::hypot(b_nrm, c_nrm);
+        }
+        if (!lost)
+            return false;
+    }
+
+    // Reorthogonalization
+    blas::gemm(Layout::ColMajor, Op::Trans, Op::NoTrans, cols, k, p, 1.0, Q, ldq, B, ldb, 0.0, orth_buf, cols);
+    blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, p, k, cols, -1.0, Q, ldq, orth_buf, cols, 1.0, B, ldb);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int64_t RBKI<T, RNG>::max_iters_bound(
+    int64_t n,
+    int64_t k
+){
+    // Past 2 * (n / k) iterations, R and S would no longer fit into their leading dimensions.
+    return std::max((int64_t) 1, std::min((int64_t) this->max_krylov_iters, 2 * (n / k)));
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int64_t RBKI<T, RNG>::workspace_query(
+    int64_t m,
+    int64_t n,
+    int64_t k
+){
+    if (this->two_pass)
+        return this->workspace_query_two_pass(m, n, k, this->max_iters_bound(n, k));
+    return this->workspace_query_iters(m, n, k, this->max_iters_bound(n, k));
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int64_t RBKI<T, RNG>::qr_work_size(
+    int64_t m,
+    int64_t n,
+    int64_t k
+){
+    return std::max({util::geqrf_work_size<T>(m, k), util::geqrf_work_size<T>(n, k),
+                     util::ungqr_work_size<T>(m, k, k), util::ungqr_work_size<T>(n, k, k)});
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int64_t RBKI<T, RNG>::svd_work_size(
+    int64_t k,
+    int64_t iters
+){
+    // R' is square and S has k more rows than columns.
+    int64_t end_cols = ((iters + 1) / 2) * k;
+    return std::max(util::gesdd_work_size<T>(Job::SomeVec, end_cols + k, end_cols),
+                    util::gesdd_work_size<T>(Job::SomeVec, end_cols, end_cols));
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int64_t RBKI<T, RNG>::workspace_query_two_pass(
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    int64_t iters
+){
+    // The bands of R and S are sized for the largest number of iterations; they take up about 4 * k * n entries.
+    int64_t max_iters = this->max_iters_bound(n, k);
+    int64_t X_cols    = k * (1 + (max_iters + 1) / 2);
+    int64_t Y_cols    = k * (1 + max_iters / 2);
+
+    return util::workspace_bytes<T>(2 * m * k)               // current and previous X_i
+         + util::workspace_bytes<T>(2 * n * k)               // current and previous Y_i
+         + util::workspace_bytes<T>(2 * k * X_cols)          // band of R
+         + util::workspace_bytes<T>(2 * k * Y_cols)          // band of S
+         + util::workspace_bytes<T>(k * k)                   // C_buf
+         + util::workspace_bytes<T>(k * k)                   // orth_buf
+         + util::workspace_bytes<T>(k)                       // tau
+         + util::workspace_bytes<T>(this->qr_work_size(m, n, k))
+         + this->workspace_query_two_pass_end(n, k, std::min(iters, max_iters));
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int64_t RBKI<T, RNG>::workspace_query_two_pass_end(
+    int64_t n,
+    int64_t k,
+    int64_t iters
+){
+    // After 'iters' iterations, R' is at most L by L and S is at most (L + k) by L.
+    int64_t L = k * (1 + iters / 2);
+
+    // A residual check needs both dense copies, U_hat, VT_hat and its own scratch space; the final SVD needs
+    // one dense copy, U_hat, VT_hat and the work array of GESDD.
+    int64_t end_bytes = util::workspace_bytes<T>((L + k) * L)      // copy of R' or S
+                      + util::workspace_bytes<T>((L + k) * L)      // U_hat
+                      + util::workspace_bytes<T>(L * L)            // VT_hat
+                      + util::workspace_bytes<T>(this->svd_work_size(k, iters));
+    if (this->k_target <= 0)
+        return end_bytes;
+    return std::max(end_bytes,
+                    util::workspace_bytes<T>(L * L)                // dense R'
+                  + util::workspace_bytes<T>((L + k) * L)          // dense S
+                  + util::workspace_bytes<T>((L + k) * L)          // U_hat
+                  + util::workspace_bytes<T>(L * L)                // VT_hat
+                  + this->workspace_query_triplets(n, k, iters));
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int64_t RBKI<T, RNG>::workspace_query_triplets(
+    int64_t n,
+    int64_t k,
+    int64_t iters
+){
+    if (this->k_target <= 0)
+        return 0;
+
+    int64_t end_cols  = ((iters + 1) / 2) * k;
+    int64_t end_rows  = end_cols + k;
+
+    // U_hat and VT_hat of the check share the space with the final ones.
+    return util::workspace_bytes<T>(end_rows * end_cols)     // copy of R or S
+         + util::workspace_bytes<T>(end_cols)                // singular values
+         + util::workspace_bytes<T>(k * this->k_target)      // residuals
+         + util::workspace_bytes<T>(this->svd_work_size(k, iters));
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int64_t RBKI<T, RNG>::workspace_query_iters(
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    int64_t iters
+){
+    // Number of columns in X_ev (and R) and in Y_od (and S) after 'iters' iterations.
+    int64_t X_cols    = k * (1 + (iters + 1) / 2);
+    int64_t Y_cols    = k * (1 + iters / 2);
+    // Upper bound on the size of the matrix, SVD of which is computed at the end.
+    int64_t end_cols  = ((iters + 1) / 2) * k;
+    int64_t end_rows  = end_cols + k;
+
+    return util::workspace_bytes<T>(m * X_cols)              // X_ev
+         + util::workspace_bytes<T>(n * Y_cols)              // Y_od
+         + util::workspace_bytes<T>(n * X_cols)              // R
+         + util::workspace_bytes<T>((n + k) * Y_cols)        // S
+         + util::workspace_bytes<T>(k * n)                   // Y_orth_buf
+         + util::workspace_bytes<T>(k * (n + k))             // X_orth_buf
+         + util::workspace_bytes<T>(k)                       // tau
+         + util::workspace_bytes<T>(this->qr_work_size(m, n, k))
+         + util::workspace_bytes<T>(end_rows * end_cols)     // U_hat
+         + util::workspace_bytes<T>(end_cols * end_cols)     // VT_hat
+         + util::workspace_bytes<T>(this->svd_work_size(k, iters))
+         + this->workspace_query_triplets(n, k, iters);
+}
+
 // -----------------------------------------------------------------------------
 template <typename T, typename RNG>
 int RBKI<T, RNG>::call(
@@ -142,6 +629,167 @@ int RBKI<T, RNG>::call(
     T* Sigma,
     RandBLAS::RNGState<RNG> &state
 ){
+    ExplicitLinOp<T> A_linop(m, n, A, lda, Layout::ColMajor);
+    return this->call(A_linop, k, U, VT, Sigma, state);
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int RBKI<T, RNG>::call(
+    int64_t m,
+    int64_t n,
+    T* A,
+    int64_t lda,
+    int64_t k,
+    T* U,
+    T* VT,
+    T* Sigma,
+    RandBLAS::RNGState<RNG> &state,
+    void* work,
+    int64_t work_bytes
+){
+    ExplicitLinOp<T> A_linop(m, n, A, lda, Layout::ColMajor);
+    return this->call(A_linop, k, U, VT, Sigma, state, work, work_bytes);
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int RBKI<T, RNG>::call(
+    LinearOperator<T> &A,
+    int64_t k,
+    T* U,
+    T* VT,
+    T* Sigma,
+    RandBLAS::RNGState<RNG> &state
+){
+    return this->call(A, k, U, VT, Sigma, state, (const T*) nullptr, A.n_cols, 0);
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int RBKI<T, RNG>::call(
+    LinearOperator<T> &A,
+    int64_t k,
+    T* U,
+    T* VT,
+    T* Sigma,
+    RandBLAS::RNGState<RNG> &state,
+    void* work,
+    int64_t work_bytes
+){
+    return this->call(A, k, U, VT, Sigma, state, (const T*) nullptr, A.n_cols, 0, work, work_bytes);
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int RBKI<T, RNG>::call(
+    LinearOperator<T> &A,
+    int64_t k,
+    T* U,
+    T* VT,
+    T* Sigma,
+    RandBLAS::RNGState<RNG> &state,
+    const T* Y_init,
+    int64_t ldy,
+    int64_t k_init
+){
+    int64_t m = A.n_rows;
+    int64_t n = A.n_cols;
+
+    int64_t cap_iters  = std::min(this->max_iters_bound(n, k), (int64_t) std::max(1, this->init_krylov_iters));
+
+    if (this->two_pass) {
+        int64_t work_bytes = this->workspace_query_two_pass(m, n, k, cap_iters);
+        void* work = util::workspace_alloc(work_bytes);
+        int info = this->call_two_pass(A, k, U, VT, Sigma, state, Y_init, ldy, k_init, work, work_bytes, cap_iters, true);
+        free(work);
+        // The replay did not reproduce R and S; fall back to storing the bases.
+        if (info != 1)
+            return info;
+    }
+
+    int64_t work_bytes = this->workspace_query_iters(m, n, k, cap_iters);
+    void* work = util::workspace_alloc(work_bytes);
+
+    int info = this->call_krylov(A, k, U, VT, Sigma, state, Y_init, ldy, k_init, work, work_bytes, cap_iters, true);
+
+    free(work);
+    return info;
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int RBKI<T, RNG>::call(
+    LinearOperator<T> &A,
+    int64_t k,
+    T* U,
+    T* VT,
+    T* Sigma,
+    RandBLAS::RNGState<RNG> &state,
+    const T* Y_init,
+    int64_t ldy,
+    int64_t k_init,
+    void* work,
+    int64_t work_bytes
+){
+    if (this->two_pass)
+        return this->call_two_pass(A, k, U, VT, Sigma, state, Y_init, ldy, k_init, work, work_bytes, this->max_iters_bound(A.n_cols, k), false);
+    return this->call_krylov(A, k, U, VT, Sigma, state, Y_init, ldy, k_init, work, work_bytes, this->max_iters_bound(A.n_cols, k), false);
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+void RBKI<T, RNG>::starting_block(
+    int64_t n,
+    int64_t k,
+    const T* Y_init,
+    int64_t ldy,
+    int64_t k_init,
+    T* Y,
+    RandBLAS::RNGState<RNG> &state
+){
+    if (k_init < 0 || k_init > k)
+        throw std::runtime_error("The number of given starting vectors must be between 0 and the block size.");
+    if (k_init > 0) {
+        if (Y_init == nullptr || ldy < n)
+            throw std::runtime_error("Invalid starting block.");
+        lapack::lacpy(MatrixType::General, n, k_init, Y_init, ldy, Y, n);
+    }
+    if (k_init == k)
+        return;
+
+    // Generate a dense Gaussian random matrx.
+    // OMP_NUM_THREADS=4 seems to be the best option for dense sketch generation.
+#if RandLAPACK_HAS_OpenMP
+    omp_set_num_threads(this->num_threads_some);
+#endif
+    RandBLAS::DenseDist D(n, k - k_init);
+    state = RandBLAS::fill_dense(D, &Y[n * k_init], state).second;
+#if RandLAPACK_HAS_OpenMP
+    omp_set_num_threads(this->num_threads_rest);
+#endif
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int RBKI<T, RNG>::call_krylov(
+    LinearOperator<T> &A,
+    int64_t k,
+    T* U,
+    T* VT,
+    T* Sigma,
+    RandBLAS::RNGState<RNG> &state,
+    const T* Y_init,
+    int64_t ldy,
+    int64_t k_init,
+    void* work,
+    int64_t work_bytes,
+    int64_t cap_iters,
+    bool grow
+){
+    int64_t m = A.n_rows;
+    int64_t n = A.n_cols;
+
     high_resolution_clock::time_point allocation_t_start;
     high_resolution_clock::time_point allocation_t_stop;
     high_resolution_clock::time_point get_factors_t_start;
@@ -186,17 +834,26 @@ int RBKI<T, RNG>::call(
     }
 
     int64_t iter = 0, iter_od = 0, iter_ev = 0, end_rows = 0, end_cols = 0;
+    this->num_reorths = 0;
     T norm_R = 0;
-    int max_iters = this->max_krylov_iters;//std::min(this->max_krylov_iters, (int) (n / (T) k));
+    int max_iters = (int) this->max_iters_bound(n, k);
+    cap_iters = std::min(cap_iters, (int64_t) max_iters);
+    // Number of columns in X_ev (and R) and in Y_od (and S) that the workspace can hold.
+    int64_t X_cols = k * (1 + (cap_iters + 1) / 2);
+    int64_t Y_cols = k * (1 + cap_iters / 2);
+    // Workspace allocated here when growing, if any.
+    void* work_grown = nullptr;
+
+    util::Workspace ws(work, work_bytes);
 
     // We need a full copy of X and Y all the way through the algorithm
     // due to an operation with X_odd and Y_odd happening at the end.
-    // Below pointers stay the same throughout the alg; the space will be alloacted iteratively
+    // Below pointers stay the same until the workspace grows; the space is reserved for cap_iters iterations.
     // Space for Y_i and Y_odd.
-    T* Y_od  = ( T * ) calloc( n * k, sizeof( T ) );
+    T* Y_od  = ws.take<T>(n * Y_cols);
     int64_t curr_Y_cols = k;
     // Space for X_i and X_ev. 
-    T* X_ev  = ( T * ) calloc( m * k, sizeof( T ) );
+    T* X_ev  = ws.take<T>(m * X_cols);
     int64_t curr_X_cols = k;
 
     // While R and S matrices are structured (both band), we cannot make use of this structure through
@@ -207,12 +864,15 @@ int RBKI<T, RNG>::call(
     // At the end, size of R would by d x d and size of S would
     // be (d + 1) x d, where d = numiters_complete * b_sz, d <= n.
     // Note that the total amount of iterations will always be numiters <= n * 2 / block_size
-    T* R    = ( T * ) calloc( n * k, sizeof( T ) );
-    T* S   = ( T * ) calloc( (n + k) * k, sizeof( T ) );
+    // Only the portions of R and S that are in use are zeroed out.
+    T* R    = ws.take<T>(n * X_cols);
+    T* S    = ws.take<T>((n + k) * Y_cols);
+    std::fill(&R[0], &R[n * k], (T) 0.0);
+    std::fill(&S[0], &S[(n + k) * k], (T) 0.0);
 
     // These buffers are of constant size
-    T* Y_orth_buf = ( T * ) calloc( k * n, sizeof( T ) );
-    T* X_orth_buf = ( T * ) calloc( k * (n + k), sizeof( T ) );
+    T* Y_orth_buf = ws.take<T>(k * n);
+    T* X_orth_buf = ws.take<T>(k * (n + k));
 
     // Pointers allocation
     // Below pointers will be offset by (n or m) * k at every even iteration.
@@ -227,7 +887,50 @@ int RBKI<T, RNG>::call(
     T* U_hat = NULL;
     T* VT_hat = NULL;
     // tau space for QR
-    T* tau = ( T * ) calloc( k, sizeof( T ) );
+    T* tau = ws.take<T>(k, true);
+    // Work array of GEQRF and UNGQR.
+    int64_t lwork_qr = this->qr_work_size(m, n, k);
+    T* qr_work       = ws.take<T>(lwork_qr);
+
+    // Moves the used portions of X_ev, Y_od, R and S into a new workspace for twice as many iterations.
+    // The pointers into them keep their offsets.
+    auto grow_workspace = [&]() {
+        cap_iters = std::min(2 * cap_iters, (int64_t) max_iters);
+        X_cols    = k * (1 + (cap_iters + 1) / 2);
+        Y_cols    = k * (1 + cap_iters / 2);
+        int64_t new_bytes = this->workspace_query_iters(m, n, k, cap_iters);
+        void* new_work = util::workspace_alloc(new_bytes);
+        util::Workspace new_ws(new_work, new_bytes);
+
+        T* Y_od_new = new_ws.take<T>(n * Y_cols);
+        T* X_ev_new = new_ws.take<T>(m * X_cols);
+        T* R_new    = new_ws.take<T>(n * X_cols);
+        T* S_new    = new_ws.take<T>((n + k) * Y_cols);
+        std::copy(Y_od, &Y_od[n * curr_Y_cols], Y_od_new);
+        std::copy(X_ev, &X_ev[m * curr_X_cols], X_ev_new);
+        std::copy(R, &R[n * curr_X_cols], R_new);
+        std::copy(S, &S[(n + k) * curr_Y_cols], S_new);
+
+        Y_i  = &Y_od_new[Y_i - Y_od];
+        X_i  = &X_ev_new[X_i - X_ev];
+        R_i  = (R_i == NULL) ? NULL : &R_new[R_i - R];
+        R_ii = &R_new[R_ii - R];
+        S_i  = &S_new[S_i - S];
+        S_ii = &S_new[S_ii - S];
+        Y_od = Y_od_new;
+        X_ev = X_ev_new;
+        R    = R_new;
+        S    = S_new;
+
+        Y_orth_buf = new_ws.take<T>(k * n);
+        X_orth_buf = new_ws.take<T>(k * (n + k));
+        tau        = new_ws.take<T>(k, true);
+        qr_work    = new_ws.take<T>(lwork_qr);
+
+        free(work_grown);
+        work_grown = new_work;
+        ws = new_ws;
+    };
 
     if(this -> timing) {
         allocation_t_stop  = high_resolution_clock::now();
@@ -235,23 +938,15 @@ int RBKI<T, RNG>::call(
     }
 
     // Pre-conpute Fro norm of an input matrix.
-    T norm_A = lapack::lange(Norm::Fro, m, n, A, lda);
+    T norm_A = A.fro_nrm();
     T sq_tol = std::pow(this->tol, 2);
     T threshold =  std::sqrt(1 - sq_tol) * norm_A;
 
     if(this -> timing)
         sketching_t_start  = high_resolution_clock::now();
 
-    // Generate a dense Gaussian random matrx.
-    // OMP_NUM_THREADS=4 seems to be the best option for dense sketch generation.
-#if RandLAPACK_HAS_OpenMP
-    omp_set_num_threads(this->num_threads_some);
-#endif
-    RandBLAS::DenseDist D(n, k);
-    state = RandBLAS::fill_dense(D, Y_i, state).second;
-#if RandLAPACK_HAS_OpenMP
-    omp_set_num_threads(this->num_threads_rest);
-#endif
+    // Starting block; a dense Gaussian random matrix unless a warm start is given.
+    this->starting_block(n, k, Y_init, ldy, k_init, Y_i, state);
 
     if(this -> timing) {
         sketching_t_stop  = high_resolution_clock::now();
@@ -260,7 +955,7 @@ int RBKI<T, RNG>::call(
     }
 
     // [X_ev, ~] = qr(A * Y_i, 0)
-    blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, m, k, n, 1.0, A, m, Y_i, n, 0.0, X_i, m);
+    A(Op::NoTrans, k, (T) 1.0, Y_i, n, (T) 0.0, X_i, m);
 
     if(this -> timing) {
         gemm_A_t_stop = high_resolution_clock::now();
@@ -270,7 +965,7 @@ int RBKI<T, RNG>::call(
     if(this -> timing)
         qr_t_start = high_resolution_clock::now();
 
-    lapack::geqrf(m, k, X_i, m, tau);
+    util::geqrf(m, k, X_i, m, tau, qr_work, lwork_qr);
 
     if(this -> timing) {
         qr_t_stop = high_resolution_clock::now();
@@ -279,7 +974,7 @@ int RBKI<T, RNG>::call(
     }
 
     // Convert X_i into an explicit form. It is now stored in X_ev as it should be.
-    lapack::ungqr(m, k, k, X_i, m, tau);
+    util::ungqr(m, k, k, X_i, m, tau, qr_work, lwork_qr);
 
     if(this -> timing) {
         ungqr_t_stop  = high_resolution_clock::now();
@@ -293,6 +988,18 @@ int RBKI<T, RNG>::call(
 
     // Iterate until in-loop termination criteria is met.
     while(1) {
+        if (grow && iter > cap_iters) {
+            if(this -> timing)
+                allocation_t_start = high_resolution_clock::now();
+
+            grow_workspace();
+
+            if(this -> timing) {
+                allocation_t_stop  = high_resolution_clock::now();
+                allocation_t_dur  += duration_cast<microseconds>(allocation_t_stop - allocation_t_start).count();
+            }
+        }
+
         if(this -> timing)
             main_loop_t_start = high_resolution_clock::now();
 
@@ -300,16 +1007,15 @@ int RBKI<T, RNG>::call(
             if(this -> timing)
                 gemm_A_t_start = high_resolution_clock::now();
             // Y_i = A' * X_i 
-            blas::gemm(Layout::ColMajor, Op::Trans, Op::NoTrans, n, k, m, 1.0, A, m, X_i, m, 0.0, Y_i, n);
+            A(Op::Trans, k, (T) 1.0, X_i, m, (T) 0.0, Y_i, n);
 
             if(this -> timing) {
                 gemm_A_t_stop = high_resolution_clock::now();
                 gemm_A_t_dur  += duration_cast<microseconds>(gemm_A_t_stop - gemm_A_t_start).count();
             }
 
-            // Allocate more spece for Y_od
+            // Advance into the reserved space for X_ev
             curr_X_cols += k;
-            X_ev = ( T * ) realloc(X_ev, m * curr_X_cols * sizeof( T ));
             // Move the X_i pointer;
             X_i = &X_ev[m * (curr_X_cols - k)];
 
@@ -322,12 +1028,8 @@ int RBKI<T, RNG>::call(
                 if(this -> timing)
                     reorth_t_start  = high_resolution_clock::now();                
                 
-                // Y_i = Y_i - Y_od * R_i
-                blas::gemm(Layout::ColMajor, Op::NoTrans, Op::Trans, n, k, iter_ev * k, -1.0, Y_od, n, R_i, n, 1.0, Y_i, n);
-
-                // Reorthogonalization
-                blas::gemm(Layout::ColMajor, Op::Trans, Op::NoTrans, k, iter_ev * k, n, 1.0, Y_i, n, Y_od, n, 0.0, Y_orth_buf, k);
-                blas::gemm(Layout::ColMajor, Op::NoTrans, Op::Trans, n, k, iter_ev * k, -1.0, Y_od, n, Y_orth_buf, k, 1.0, Y_i, n);
+                // Y_i = Y_i - Y_od * R_i, and the reorthogonalization
+                this->num_reorths += this->orthogonalize(n, k, iter_ev * k, Y_od, n, R_i, n, true, Y_i, n, Y_orth_buf);
 
                 if(this -> timing) {
                     reorth_t_stop  = high_resolution_clock::now();
@@ -340,7 +1042,7 @@ int RBKI<T, RNG>::call(
 
             if(this -> timing)
                 qr_t_start = high_resolution_clock::now();
-            lapack::geqrf(n, k, Y_i, n, tau);
+            util::geqrf(n, k, Y_i, n, tau, qr_work, lwork_qr);
 
             if(this -> timing) {
                 qr_t_stop = high_resolution_clock::now();
@@ -364,7 +1066,7 @@ int RBKI<T, RNG>::call(
             }
 
             // Convert Y_i into an explicit form. It is now stored in Y_odd as it should be.
-            lapack::ungqr(n, k, k, Y_i, n, tau);
+            util::ungqr(n, k, k, Y_i, n, tau, qr_work, lwork_qr);
             
             if(this -> timing) {
                 ungqr_t_stop  = high_resolution_clock::now();
@@ -378,9 +1080,8 @@ int RBKI<T, RNG>::call(
                 break;
             }
 
-            // Allocate more space for R
-            R = ( T * ) realloc(R, n * curr_X_cols * sizeof( T ));
-            // Need to make sure the newly-allocated space is empty
+            // Advance into the reserved space for R
+            // Need to make sure the new space is empty
             memset(&R[n * (curr_X_cols - k)], 0.0, n * k * sizeof( T ));
 
             // Advance R pointers
@@ -395,16 +1096,15 @@ int RBKI<T, RNG>::call(
                 gemm_A_t_start = high_resolution_clock::now();
 
             // X_i = A * Y_i
-            blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, m, k, n, 1.0, A, m, Y_i, n, 0.0, X_i, m);
+            A(Op::NoTrans, k, (T) 1.0, Y_i, n, (T) 0.0, X_i, m);
             
             if(this -> timing) {
                 gemm_A_t_stop = high_resolution_clock::now();
                 gemm_A_t_dur  += duration_cast<microseconds>(gemm_A_t_stop - gemm_A_t_start).count();
             }
 
-            // Allocate more spece for Y_od
+            // Advance into the reserved space for Y_od
             curr_Y_cols += k;
-            Y_od = ( T * ) realloc(Y_od, n * curr_Y_cols * sizeof( T ));
             // Move the X_i pointer;
             Y_i = &Y_od[n * (curr_Y_cols - k)];
 
@@ -416,12 +1116,8 @@ int RBKI<T, RNG>::call(
             if(this -> timing)
                 reorth_t_start  = high_resolution_clock::now();
             
-            //X_i = X_i - X_ev * S_i;
-            blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, m, k, iter_od * k, -1.0, X_ev, m, S_i, n + k, 1.0, X_i, m);
-
-            // Reorthogonalization
-            blas::gemm(Layout::ColMajor, Op::Trans, Op::NoTrans, iter_od * k, k, m, 1.0, X_ev, m, X_i, m, 0.0, X_orth_buf, n + k);
-            blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, m, k, iter_od * k, -1.0, X_ev, m, X_orth_buf, n + k, 1.0, X_i, m);
+            //X_i = X_i - X_ev * S_i, and the reorthogonalization
+            this->num_reorths += this->orthogonalize(m, k, iter_od * k, X_ev, m, S_i, n + k, false, X_i, m, X_orth_buf);
             
             if(this -> timing) {
                 reorth_t_stop  = high_resolution_clock::now();
@@ -434,7 +1130,7 @@ int RBKI<T, RNG>::call(
             if(this -> timing)
                 qr_t_start = high_resolution_clock::now();
             
-            lapack::geqrf(m, k, X_i, m, tau);
+            util::geqrf(m, k, X_i, m, tau, qr_work, lwork_qr);
 
             if(this -> timing) {
                 qr_t_stop = high_resolution_clock::now();
@@ -452,7 +1148,7 @@ int RBKI<T, RNG>::call(
             }
 
             // Convert X_i into an explicit form. It is now stored in X_ev as it should be
-            lapack::ungqr(m, k, k, X_i, m, tau);
+            util::ungqr(m, k, k, X_i, m, tau, qr_work, lwork_qr);
 
             if(this -> timing) {
                 ungqr_t_stop  = high_resolution_clock::now();
@@ -466,9 +1162,8 @@ int RBKI<T, RNG>::call(
                 break;
             }
 
-            // Allocate more space for S
-            S = ( T * ) realloc(S, (n + k) * curr_Y_cols * sizeof( T ));
-            // Need to make sure the newly-allocated space is empty
+            // Advance into the reserved space for S
+            // Need to make sure the new space is empty
             memset(&S[(n + k)* (curr_Y_cols - k)], 0.0, (n + k) * k * sizeof( T ));
 
             // Advance S pointers
@@ -485,7 +1180,11 @@ int RBKI<T, RNG>::call(
 
         // This is only changed on odd iters
         if (iter % 2 != 0)
-            norm_R = lapack::lantr(Norm::Fro, Uplo::Upper, Diag::NonUnit, iter_ev * k, iter_ev * k, R, n);
+            norm_R = util::lantr(Norm::Fro, Uplo::Upper, Diag::NonUnit, iter_ev * k, iter_ev * k, R, n, (T*) nullptr);
+
+        // Residual-based termination; the triplets come from the previous iteration.
+        bool converged = this->k_target > 0 && iter > 1 && iter % std::max(1, this->residual_check_freq) == 0
+                         && this->triplets_converged(n, k, iter - 1, R, S, ws);
 
         if(this -> timing) {
             norm_t_stop       = high_resolution_clock::now();
@@ -494,6 +1193,11 @@ int RBKI<T, RNG>::call(
             main_loop_t_dur   += duration_cast<microseconds>(main_loop_t_stop - main_loop_t_start).count();
         }
 
+        if (converged) {
+            --iter;
+            break;
+        }
+
         if (iter >= max_iters) {
             break;
         }
@@ -508,16 +1212,21 @@ int RBKI<T, RNG>::call(
 
     this->norm_R_end = norm_R;
     this->num_krylov_iters = iter;
-    end_cols = num_krylov_iters * k / 2;
+    // There are (num_krylov_iters + 1) / 2 blocks in Y_od, and as many in X_ev plus one after an even iteration.
+    end_cols = ((num_krylov_iters + 1) / 2) * k;
     iter % 2 == 0 ? end_rows = end_cols + k : end_rows = end_cols;
+    // Number of singular vectors to form.
+    int64_t end_vecs = (this->k_target > 0) ? std::min(this->k_target, end_cols) : end_cols;
     
 
     if(this -> timing) {
         allocation_t_start  = high_resolution_clock::now();
     }
 
-    U_hat  = ( T * ) calloc( end_rows * end_cols, sizeof( T ) );
-    VT_hat = ( T * ) calloc( end_cols * end_cols, sizeof( T ) );
+    U_hat  = ws.take<T>(end_rows * end_cols);
+    VT_hat = ws.take<T>(end_cols * end_cols);
+    int64_t lwork_svd = util::gesdd_work_size<T>(Job::SomeVec, end_rows, end_cols);
+    T* svd_work       = ws.take<T>(lwork_svd);
 
     if(this -> timing) {
         allocation_t_stop  = high_resolution_clock::now();
@@ -527,36 +1236,21 @@ int RBKI<T, RNG>::call(
 
     if (iter % 2 != 0) {
         // [U_hat, Sigma, V_hat] = svd(R')
-        lapack::gesdd(Job::SomeVec, end_rows, end_cols, R, n, Sigma, U_hat, end_rows, VT_hat, end_cols);
+        util::gesdd(Job::SomeVec, end_rows, end_cols, R, n, Sigma, U_hat, end_rows, VT_hat, end_cols, svd_work, lwork_svd);
     } else { 
         // [U_hat, Sigma, V_hat] = svd(S)
-        lapack::gesdd(Job::SomeVec, end_rows, end_cols, S, n + k, Sigma, U_hat, end_rows, VT_hat, end_cols);
+        util::gesdd(Job::SomeVec, end_rows, end_cols, S, n + k, Sigma, U_hat, end_rows, VT_hat, end_cols, svd_work, lwork_svd);
     }
 
     // U = X_ev * U_hat
-    blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, m, end_cols, end_rows, 1.0, X_ev, m, U_hat, end_rows, 0.0, U, m);
+    blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, m, end_vecs, end_rows, 1.0, X_ev, m, U_hat, end_rows, 0.0, U, m);
     // V = Y_od * V_hat
     // We actually perform VT = V_hat' * Y_odd'
-    blas::gemm(Layout::ColMajor, Op::NoTrans, Op::Trans, end_cols, n, end_cols, 1.0, VT_hat, end_cols, Y_od, n, 0.0, VT, n);
+    blas::gemm(Layout::ColMajor, Op::NoTrans, Op::Trans, end_vecs, n, end_cols, 1.0, VT_hat, end_cols, Y_od, n, 0.0, VT, n);
 
     if(this -> timing) {
         get_factors_t_stop  = high_resolution_clock::now();
         get_factors_t_dur   = duration_cast<microseconds>(get_factors_t_stop - get_factors_t_start).count();
-        allocation_t_start  = high_resolution_clock::now();
-    }
-    free(Y_od);
-    free(X_ev);
-    free(tau);
-    free(R);
-    free(S);
-    free(U_hat);
-    free(VT_hat);
-    free(Y_orth_buf);
-    free(X_orth_buf);
-
-    if(this -> timing) {
-        allocation_t_stop  = high_resolution_clock::now();
-        allocation_t_dur   += duration_cast<microseconds>(allocation_t_stop - allocation_t_start).count();
     }
 
         if(this -> timing) {
@@ -568,7 +1262,7 @@ int RBKI<T, RNG>::call(
 
             if (this -> verbose) {
                 printf("\n\n/------------RBKI TIMING RESULTS BEGIN------------/\n");
-                printf("Basic info: b_sz=%ld krylov_iters=%d\n",      k, num_krylov_iters);
+                printf("Basic info: b_sz=%ld krylov_iters=%d reorths=%d\n", k, num_krylov_iters, num_reorths);
 
                 printf("Allocate and free time:          %25ld μs,\n", allocation_t_dur);
                 printf("Time to acquire the SVD factors: %25ld μs,\n", get_factors_t_dur);
@@ -597,6 +1291,597 @@ int RBKI<T, RNG>::call(
                 printf("/-------------RBKI TIMING RESULTS END-------------/\n\n");
             }
         }
+
+    free(work_grown);
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+bool RBKI<T, RNG>::triplets_converged(
+    int64_t n,
+    int64_t k,
+    int64_t iters,
+    const T* R,
+    const T* S,
+    util::Workspace ws
+){
+    int64_t k_t  = this->k_target;
+    // Number of blocks in Y_od after 'iters' iterations.
+    int64_t p    = (iters + 1) / 2;
+    int64_t cols = p * k;
+    int64_t rows = (iters % 2 != 0) ? cols : cols + k;
+    if (cols < k_t)
+        return false;
+
+    T* B      = ws.take<T>(rows * cols);
+    T* sigma  = ws.take<T>(cols);
+    T* W      = ws.take<T>(k * k_t);
+    T* U_hat  = ws.take<T>(rows * cols);
+    T* VT_hat = ws.take<T>(cols * cols);
+    int64_t lwork = util::gesdd_work_size<T>(Job::SomeVec, rows, cols);
+    T* svd_work   = ws.take<T>(lwork);
+
+    if (iters % 2 != 0) {
+        // [U_hat, sigma, V_hat] = svd(R')
+        lapack::lacpy(MatrixType::General, rows, cols, R, n, B, rows);
+        util::gesdd(Job::SomeVec, rows, cols, B, rows, sigma, U_hat, rows, VT_hat, cols, svd_work, lwork);
+        // A * Y_od = X_ev * R' + X_i * S_ii * E_p', where S_ii is the block that the next iteration appended to S.
+        // Then A * v_i - sigma_i * u_i = X_i * S_ii * (last k entries of v_i).
+        blas::gemm(Layout::ColMajor, Op::NoTrans, Op::Trans, k, k_t, k, 1.0, &S[(n + k) * k * (p - 1) + p * k], n + k, &VT_hat[cols * (p - 1) * k], cols, 0.0, W, k);
+    } else {
+        // [U_hat, sigma, V_hat] = svd(S)
+        lapack::lacpy(MatrixType::General, rows, cols, S, n + k, B, rows);
+        util::gesdd(Job::SomeVec, rows, cols, B, rows, sigma, U_hat, rows, VT_hat, cols, svd_work, lwork);
+        // A' * X_ev = Y_od * S' + Y_i * R_ii * E_(p + 1)', where R_ii' is the block that the next iteration appended to R.
+        // Then A' * u_i - sigma_i * v_i = Y_i * R_ii * (last k entries of u_i).
+        blas::gemm(Layout::ColMajor, Op::Trans, Op::NoTrans, k, k_t, k, 1.0, &R[n * k * p + k * p], n, &U_hat[p * k], rows, 0.0, W, k);
+    }
+
+    for (int64_t i = 0; i < k_t; ++i) {
+        if (blas::nrm2(k, &W[k * i], 1) > this->residual_tol * sigma[0])
+            return false;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int RBKI<T, RNG>::call_two_pass(
+    LinearOperator<T> &A,
+    int64_t k,
+    T* U,
+    T* VT,
+    T* Sigma,
+    RandBLAS::RNGState<RNG> &state,
+    const T* Y_init,
+    int64_t ldy,
+    int64_t k_init,
+    void* work,
+    int64_t work_bytes,
+    int64_t cap_iters,
+    bool grow
+){
+    int64_t m = A.n_rows;
+    int64_t n = A.n_cols;
+
+    high_resolution_clock::time_point allocation_t_start;
+    high_resolution_clock::time_point allocation_t_stop;
+    high_resolution_clock::time_point get_factors_t_start;
+    high_resolution_clock::time_point get_factors_t_stop;
+    high_resolution_clock::time_point ungqr_t_start;
+    high_resolution_clock::time_point ungqr_t_stop;
+    high_resolution_clock::time_point reorth_t_start;
+    high_resolution_clock::time_point reorth_t_stop;
+    high_resolution_clock::time_point qr_t_start;
+    high_resolution_clock::time_point qr_t_stop;
+    high_resolution_clock::time_point gemm_A_t_start;
+    high_resolution_clock::time_point gemm_A_t_stop;
+    high_resolution_clock::time_point main_loop_t_start;
+    high_resolution_clock::time_point main_loop_t_stop;
+    high_resolution_clock::time_point sketching_t_start;
+    high_resolution_clock::time_point sketching_t_stop;
+    high_resolution_clock::time_point r_cpy_t_start;
+    high_resolution_clock::time_point r_cpy_t_stop;
+    high_resolution_clock::time_point s_cpy_t_start;
+    high_resolution_clock::time_point s_cpy_t_stop;
+    high_resolution_clock::time_point norm_t_start;
+    high_resolution_clock::time_point norm_t_stop;
+    high_resolution_clock::time_point total_t_start;
+    high_resolution_clock::time_point total_t_stop;
+
+    long allocation_t_dur  = 0;
+    long get_factors_t_dur = 0;
+    long ungqr_t_dur       = 0;
+    long reorth_t_dur      = 0;
+    long qr_t_dur          = 0;
+    long gemm_A_t_dur      = 0;
+    long main_loop_t_dur   = 0;
+    long sketching_t_dur   = 0;
+    long r_cpy_t_dur       = 0;
+    long s_cpy_t_dur       = 0;
+    long norm_t_dur        = 0;
+    long total_t_dur       = 0;
+
+    if(this -> timing) {
+        total_t_start = high_resolution_clock::now();
+        allocation_t_start  = high_resolution_clock::now();
+    }
+
+    int64_t iter = 0, iter_od = 0, iter_ev = 0, end_rows = 0, end_cols = 0;
+    this->num_reorths = 0;
+    this->replay_err  = 0;
+    T norm_R = 0;
+    int max_iters = (int) this->max_iters_bound(n, k);
+    cap_iters = std::min(cap_iters, (int64_t) max_iters);
+    int64_t X_cols = k * (1 + (max_iters + 1) / 2);
+    int64_t Y_cols = k * (1 + max_iters / 2);
+    // Workspace for the dense copies of R and S allocated here when growing, if any.
+    void* work_grown = nullptr;
+
+    util::Workspace ws(work, work_bytes);
+
+    // Only the latest block of X_ev and Y_od is kept, plus the space for the next one.
+    T* X_i   = ws.take<T>(m * k);
+    T* X_new = ws.take<T>(m * k);
+    T* Y_i   = ws.take<T>(n * k);
+    T* Y_new = ws.take<T>(n * k);
+
+    // Only the diagonal and first off-diagonal blocks of R (transposed) and S are ever written.
+    // Column block j of R_band holds blocks (j, j) and (j + 1, j) of R', and column block j of S_band
+    // holds blocks (j, j) and (j + 1, j) of S; both have leading dimension 2 * k.
+    // As in call_krylov(), a block column of S that the last iteration did not reach is zero.
+    T* R_band = ws.take<T>(2 * k * X_cols, true);
+    T* S_band = ws.take<T>(2 * k * Y_cols, true);
+
+    // Coefficients of the projection onto the previous block and of the reorthogonalization.
+    T* C_buf    = ws.take<T>(k * k);
+    T* orth_buf = ws.take<T>(k * k);
+    T* tau      = ws.take<T>(k, true);
+    // Work array of GEQRF and UNGQR.
+    int64_t lwork_qr = this->qr_work_size(m, n, k);
+    T* qr_work       = ws.take<T>(lwork_qr);
+    T* U_hat  = NULL;
+    T* VT_hat = NULL;
+
+    // The rest of the workspace holds the dense copies of R and S for cap_iters iterations.
+    util::Workspace ws_end = ws;
+
+    // Space for the dense copies after 'iters' iterations; nothing in it is kept between uses.
+    auto end_space = [&](int64_t iters) -> util::Workspace {
+        if (grow && iters > cap_iters) {
+            cap_iters = std::min(std::max(iters, 2 * cap_iters), (int64_t) max_iters);
+            int64_t new_bytes = this->workspace_query_two_pass_end(n, k, cap_iters);
+            free(work_grown);
+            work_grown = util::workspace_alloc(new_bytes);
+            ws_end = util::Workspace(work_grown, new_bytes);
+        }
+        return ws_end;
+    };
+
+    // Writes the leading R_blocks by R_blocks blocks of R' into R_dense, and the leading S_blocks + 1 by S_blocks
+    // blocks of S into S_dense (either may be null). Blocks outside the band are zero.
+    auto unpack = [&](int64_t R_blocks, T* R_dense, int64_t ldr, int64_t S_blocks, T* S_dense, int64_t lds) {
+        if (R_dense != nullptr) {
+            lapack::laset(MatrixType::General, R_blocks * k, R_blocks * k, 0.0, 0.0, R_dense, ldr);
+            for (int64_t j = 0; j < R_blocks; ++j) {
+                int64_t rows = (j + 1 < R_blocks) ? 2 * k : k;
+                lapack::lacpy(MatrixType::General, rows, k, &R_band[2 * k * k * j], 2 * k, &R_dense[j * k + ldr * k * j], ldr);
+            }
+        }
+        if (S_dense != nullptr) {
+            lapack::laset(MatrixType::General, (S_blocks + 1) * k, S_blocks * k, 0.0, 0.0, S_dense, lds);
+            for (int64_t j = 0; j < S_blocks; ++j)
+                lapack::lacpy(MatrixType::General, 2 * k, k, &S_band[2 * k * k * j], 2 * k, &S_dense[j * k + lds * k * j], lds);
+        }
+    };
+
+    if(this -> timing) {
+        allocation_t_stop  = high_resolution_clock::now();
+        allocation_t_dur   = duration_cast<microseconds>(allocation_t_stop - allocation_t_start).count();
+    }
+
+    // Pre-conpute Fro norm of an input matrix.
+    T norm_A = A.fro_nrm();
+    T sq_tol = std::pow(this->tol, 2);
+    T threshold =  std::sqrt(1 - sq_tol) * norm_A;
+
+    // The state that the second pass starts from.
+    RandBLAS::RNGState<RNG> state_start = state;
+
+    // Below steps are run in both passes. Timings and the entries of R and S are only recorded in the first one;
+    // the second pass repeats the exact same operations, so that it produces the exact same blocks.
+    // The second pass checks this by comparing each block it produces against the recorded one.
+
+    // Adds the k by k block B (its upper triangle only, if 'upper') to replay_err, as its difference from
+    // the recorded block B_rec, or from the transpose of B_rec if 'trans'.
+    auto check_block = [&](const T* B, int64_t ldb, bool upper, bool trans, const T* B_rec, int64_t ldb_rec) {
+        T sq_diff = 0;
+        for (int64_t j = 0; j < k; ++j) {
+            for (int64_t i = 0; i < (upper ? j + 1 : k); ++i) {
+                T rec = trans ? B_rec[j + ldb_rec * i] : B_rec[i + ldb_rec * j];
+                sq_diff += std::pow(B[i + ldb * j] - rec, 2);
+            }
+        }
+        this->replay_err = std::max(this->replay_err, std::sqrt(sq_diff));
+    };
+
+    // [X_i, ~] = qr(A * Y_i, 0), with Y_i the starting block.
+    auto first_step = [&](bool record) {
+        bool timed = this->timing && record;
+        if(timed)
+            sketching_t_start  = high_resolution_clock::now();
+
+        this->starting_block(n, k, Y_init, ldy, k_init, Y_i, state);
+
+        if(timed) {
+            sketching_t_stop  = high_resolution_clock::now();
+            sketching_t_dur   = duration_cast<microseconds>(sketching_t_stop - sketching_t_start).count();
+            gemm_A_t_start = high_resolution_clock::now();
+        }
+
+        A(Op::NoTrans, k, (T) 1.0, Y_i, n, (T) 0.0, X_i, m);
+
+        if(timed) {
+            gemm_A_t_stop = high_resolution_clock::now();
+            gemm_A_t_dur  += duration_cast<microseconds>(gemm_A_t_stop - gemm_A_t_start).count();
+            qr_t_start = high_resolution_clock::now();
+        }
+
+        std::fill(&tau[0], &tau[k], 0.0);
+        util::geqrf(m, k, X_i, m, tau, qr_work, lwork_qr);
+
+        if(timed) {
+            qr_t_stop = high_resolution_clock::now();
+            qr_t_dur  += duration_cast<microseconds>(qr_t_stop - qr_t_start).count();
+            ungqr_t_start  = high_resolution_clock::now();
+        }
+
+        util::ungqr(m, k, k, X_i, m, tau, qr_work, lwork_qr);
+
+        if(timed) {
+            ungqr_t_stop  = high_resolution_clock::now();
+            ungqr_t_dur   += duration_cast<microseconds>(ungqr_t_stop - ungqr_t_start).count();
+        }
+    };
+
+    // [Y_i, R_ii] = qr(A' * X_i - Y_i * R_i, 0), where R_i is the projection onto the previous Y_i only.
+    // Returns the bottom right entry of R_ii.
+    auto odd_step = [&](bool record) -> T {
+        bool timed = this->timing && record;
+        if(timed)
+            gemm_A_t_start = high_resolution_clock::now();
+
+        A(Op::Trans, k, (T) 1.0, X_i, m, (T) 0.0, Y_new, n);
+
+        if(timed) {
+            gemm_A_t_stop = high_resolution_clock::now();
+            gemm_A_t_dur  += duration_cast<microseconds>(gemm_A_t_stop - gemm_A_t_start).count();
+        }
+
+        if (iter_ev != 0) {
+            // C = Y_new' * Y_i
+            blas::gemm(Layout::ColMajor, Op::Trans, Op::NoTrans, k, k, n, 1.0, Y_new, n, Y_i, n, 0.0, C_buf, k);
+
+            if(timed)
+                reorth_t_start  = high_resolution_clock::now();
+
+            // Y_new = Y_new - Y_i * C', and the reorthogonalization
+            bool reorthed = this->orthogonalize(n, k, k, Y_i, n, C_buf, k, true, Y_new, n, orth_buf);
+            if(record)
+                this->num_reorths += reorthed;
+
+            if(timed) {
+                reorth_t_stop  = high_resolution_clock::now();
+                reorth_t_dur   += duration_cast<microseconds>(reorth_t_stop - reorth_t_start).count();
+            }
+
+            // The off-diagonal block of R', under the previous diagonal block.
+            if(record)
+                lapack::lacpy(MatrixType::General, k, k, C_buf, k, &R_band[2 * k * k * (iter_ev - 1) + k], 2 * k);
+            else
+                check_block(C_buf, k, false, false, &R_band[2 * k * k * (iter_ev - 1) + k], 2 * k);
+        }
+
+        std::fill(&tau[0], &tau[k], 0.0);
+
+        if(timed)
+            qr_t_start = high_resolution_clock::now();
+
+        util::geqrf(n, k, Y_new, n, tau, qr_work, lwork_qr);
+
+        if(timed) {
+            qr_t_stop = high_resolution_clock::now();
+            qr_t_dur  += duration_cast<microseconds>(qr_t_stop - qr_t_start).count();
+            r_cpy_t_start = high_resolution_clock::now();
+        }
+
+        // Copy R_ii over to R's (in transposed format).
+        if(record) {
+#if RandLAPACK_HAS_OpenMP
+            omp_set_num_threads(this->num_threads_some);
+#endif
+            util::transposition(0, k, Y_new, n, &R_band[2 * k * k * iter_ev], 2 * k, 1);
+#if RandLAPACK_HAS_OpenMP
+            omp_set_num_threads(this->num_threads_rest);
+#endif
+        } else {
+            check_block(Y_new, n, true, true, &R_band[2 * k * k * iter_ev], 2 * k);
+        }
+        T diag = Y_new[(n + 1) * (k - 1)];
+
+        if(timed) {
+            r_cpy_t_stop  = high_resolution_clock::now();
+            r_cpy_t_dur  += duration_cast<microseconds>(r_cpy_t_stop - r_cpy_t_start).count();
+            ungqr_t_start = high_resolution_clock::now();
+        }
+
+        util::ungqr(n, k, k, Y_new, n, tau, qr_work, lwork_qr);
+
+        if(timed) {
+            ungqr_t_stop  = high_resolution_clock::now();
+            ungqr_t_dur   += duration_cast<microseconds>(ungqr_t_stop - ungqr_t_start).count();
+        }
+
+        std::swap(Y_i, Y_new);
+        return diag;
+    };
+
+    // [X_i, S_ii] = qr(A * Y_i - X_i * S_i, 0), where S_i is the projection onto the previous X_i only.
+    // Returns the bottom right entry of S_ii.
+    auto even_step = [&](bool record) -> T {
+        bool timed = this->timing && record;
+        if(timed)
+            gemm_A_t_start = high_resolution_clock::now();
+
+        A(Op::NoTrans, k, (T) 1.0, Y_i, n, (T) 0.0, X_new, m);
+
+        if(timed) {
+            gemm_A_t_stop = high_resolution_clock::now();
+            gemm_A_t_dur  += duration_cast<microseconds>(gemm_A_t_stop - gemm_A_t_start).count();
+        }
+
+        // C = X_i' * X_new
+        blas::gemm(Layout::ColMajor, Op::Trans, Op::NoTrans, k, k, m, 1.0, X_i, m, X_new, m, 0.0, C_buf, k);
+
+        if(timed)
+            reorth_t_start  = high_resolution_clock::now();
+
+        // X_new = X_new - X_i * C, and the reorthogonalization
+        bool reorthed = this->orthogonalize(m, k, k, X_i, m, C_buf, k, false, X_new, m, orth_buf);
+        if(record)
+            this->num_reorths += reorthed;
+
+        if(timed) {
+            reorth_t_stop  = high_resolution_clock::now();
+            reorth_t_dur   += duration_cast<microseconds>(reorth_t_stop - reorth_t_start).count();
+        }
+
+        std::fill(&tau[0], &tau[k], 0.0);
+
+        if(timed)
+            qr_t_start = high_resolution_clock::now();
+
+        util::geqrf(m, k, X_new, m, tau, qr_work, lwork_qr);
+
+        if(timed) {
+            qr_t_stop = high_resolution_clock::now();
+            qr_t_dur  += duration_cast<microseconds>(qr_t_stop - qr_t_start).count();
+            s_cpy_t_start = high_resolution_clock::now();
+        }
+
+        // The off-diagonal block of S, and S_ii under it.
+        T* S_i = &S_band[2 * k * k * (iter_od - 1)];
+        if(record) {
+            lapack::lacpy(MatrixType::General, k, k, C_buf, k, S_i, 2 * k);
+            lapack::lacpy(MatrixType::Upper, k, k, X_new, m, &S_i[k], 2 * k);
+        } else {
+            check_block(C_buf, k, false, false, S_i, 2 * k);
+            check_block(X_new, m, true, false, &S_i[k], 2 * k);
+        }
+        T diag = X_new[(m + 1) * (k - 1)];
+
+        if(timed) {
+            s_cpy_t_stop  = high_resolution_clock::now();
+            s_cpy_t_dur  += duration_cast<microseconds>(s_cpy_t_stop - s_cpy_t_start).count();
+            ungqr_t_start = high_resolution_clock::now();
+        }
+
+        util::ungqr(m, k, k, X_new, m, tau, qr_work, lwork_qr);
+
+        if(timed) {
+            ungqr_t_stop  = high_resolution_clock::now();
+            ungqr_t_dur   += duration_cast<microseconds>(ungqr_t_stop - ungqr_t_start).count();
+        }
+
+        std::swap(X_i, X_new);
+        return diag;
+    };
+
+    // First pass: build R and S.
+    first_step(true);
+
+    // Advance odd iteration count.
+    ++iter_od;
+    // Advance iteration count.
+    ++iter;
+
+    // Iterate until in-loop termination criteria is met.
+    while(1) {
+        if(this -> timing)
+            main_loop_t_start = high_resolution_clock::now();
+
+        if (iter % 2 != 0) {
+            // Need to make sure the space in R is empty
+            std::fill(&R_band[2 * k * k * iter_ev], &R_band[2 * k * k * (iter_ev + 1)], (T) 0.0);
+
+            // Early termination
+            // if (abs(R(end)) <= sqrt(eps('double')))
+            if(std::abs(odd_step(true)) < std::sqrt(std::numeric_limits<double>::epsilon()))
+                break;
+
+            // Advance even iteration count;
+            ++iter_ev;
+        }
+        else {
+            // Need to make sure the space in S is empty
+            std::fill(&S_band[2 * k * k * (iter_od - 1)], &S_band[2 * k * k * iter_od], (T) 0.0);
+
+            // Early termination
+            // if (abs(S(end)) <= sqrt(eps('double')))
+            if(std::abs(even_step(true)) < std::sqrt(std::numeric_limits<double>::epsilon()))
+                break;
+
+            // Advance odd iteration count;
+            ++iter_od;
+        }
+
+        if(this -> timing)
+            norm_t_start = high_resolution_clock::now();
+
+        // This is only changed on odd iters.
+        // Same as the norm of the upper triangle of R' in call_krylov(), which only meets the diagonal blocks.
+        if (iter % 2 != 0) {
+            T sq_norm_R = 0;
+            for (int64_t j = 0; j < iter_ev; ++j)
+                sq_norm_R += std::pow(util::lantr(Norm::Fro, Uplo::Upper, Diag::NonUnit, k, k, &R_band[2 * k * k * j], 2 * k, (T*) nullptr), 2);
+            norm_R = std::sqrt(sq_norm_R);
+        }
+
+        // Residual-based termination; the triplets come from the previous iteration.
+        bool converged = false;
+        if (this->k_target > 0 && iter > 1 && iter % std::max(1, this->residual_check_freq) == 0) {
+            // R' has iter_ev diagonal blocks and S has iter_od - 1 block columns, all within L by L and (L + k) by L.
+            int64_t L = k * std::max(iter_ev, iter_od);
+            util::Workspace ws_check = end_space(iter);
+            T* R_dense = ws_check.take<T>(L * L);
+            T* S_dense = ws_check.take<T>((L + k) * L);
+            unpack(iter_ev, R_dense, L, iter_od - 1, S_dense, L + k);
+            converged = this->triplets_converged(L, k, iter - 1, R_dense, S_dense, ws_check);
+        }
+
+        if(this -> timing) {
+            norm_t_stop       = high_resolution_clock::now();
+            norm_t_dur        += duration_cast<microseconds>(norm_t_stop - norm_t_start).count();
+            main_loop_t_stop  = high_resolution_clock::now();
+            main_loop_t_dur   += duration_cast<microseconds>(main_loop_t_stop - main_loop_t_start).count();
+        }
+
+        if (converged) {
+            --iter;
+            break;
+        }
+
+        if (iter >= max_iters) {
+            break;
+        }
+
+        ++iter;
+        //norm(R, 'fro') > sqrt(1 - sq_tol) * norm_A
+        if(norm_R > threshold) {
+            break;
+        }
+    }
+
+    this->norm_R_end = norm_R;
+    this->num_krylov_iters = iter;
+    // There are (num_krylov_iters + 1) / 2 blocks in Y_od, and as many in X_ev plus one after an even iteration.
+    end_cols = ((num_krylov_iters + 1) / 2) * k;
+    iter % 2 == 0 ? end_rows = end_cols + k : end_rows = end_cols;
+    // Number of singular vectors to form.
+    int64_t end_vecs = (this->k_target > 0) ? std::min(this->k_target, end_cols) : end_cols;
+
+    if(this -> timing)
+        allocation_t_start  = high_resolution_clock::now();
+
+    // Sized from the actual number of iterations.
+    util::Workspace ws_svd = end_space(num_krylov_iters);
+    T* B   = ws_svd.take<T>(end_rows * end_cols);
+    U_hat  = ws_svd.take<T>(end_rows * end_cols);
+    VT_hat = ws_svd.take<T>(end_cols * end_cols);
+    int64_t lwork_svd = util::gesdd_work_size<T>(Job::SomeVec, end_rows, end_cols);
+    T* svd_work       = ws_svd.take<T>(lwork_svd);
+
+    if(this -> timing) {
+        allocation_t_stop  = high_resolution_clock::now();
+        allocation_t_dur   += duration_cast<microseconds>(allocation_t_stop - allocation_t_start).count();
+        get_factors_t_start  = high_resolution_clock::now();
+    }
+
+    if (iter % 2 != 0) {
+        // [U_hat, Sigma, V_hat] = svd(R')
+        unpack(end_cols / k, B, end_rows, 0, nullptr, 0);
+    } else {
+        // [U_hat, Sigma, V_hat] = svd(S)
+        unpack(0, nullptr, 0, end_cols / k, B, end_rows);
+    }
+    util::gesdd(Job::SomeVec, end_rows, end_cols, B, end_rows, Sigma, U_hat, end_rows, VT_hat, end_cols, svd_work, lwork_svd);
+
+    // Second pass: U = X_ev * U_hat and VT = V_hat' * Y_od' (end_vecs columns and rows of them), one block of X_ev and Y_od at a time.
+    // Block j of X_ev (Y_od) multiplies rows (columns) j * k through (j + 1) * k of U_hat (VT_hat);
+    // only the first end_rows (end_cols) columns of the bases take part.
+    lapack::laset(MatrixType::General, m, end_vecs, 0.0, 0.0, U, m);
+    lapack::laset(MatrixType::General, end_vecs, n, 0.0, 0.0, VT, n);
+
+    auto accumulate_U = [&](int64_t j) {
+        int64_t cols = std::min(k, end_rows - j * k);
+        if (cols > 0)
+            blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, m, end_vecs, cols, 1.0, X_i, m, &U_hat[j * k], end_rows, 1.0, U, m);
+    };
+    auto accumulate_VT = [&](int64_t j) {
+        int64_t cols = std::min(k, end_cols - j * k);
+        if (cols > 0)
+            blas::gemm(Layout::ColMajor, Op::NoTrans, Op::Trans, end_vecs, n, cols, 1.0, &VT_hat[end_cols * j * k], end_cols, Y_i, n, 1.0, VT, n);
+    };
+
+    state  = state_start;
+    iter_od = iter_ev = 0;
+    first_step(false);
+    accumulate_U(iter_od++);
+    for (int64_t i = 1; i <= num_krylov_iters; ++i) {
+        if (i % 2 != 0) {
+            odd_step(false);
+            accumulate_VT(iter_ev++);
+        } else {
+            even_step(false);
+            accumulate_U(iter_od++);
+        }
+    }
+
+    if(this -> timing) {
+        get_factors_t_stop  = high_resolution_clock::now();
+        get_factors_t_dur   = duration_cast<microseconds>(get_factors_t_stop - get_factors_t_start).count();
+        total_t_stop = high_resolution_clock::now();
+        total_t_dur  = duration_cast<microseconds>(total_t_stop - total_t_start).count();
+        long t_rest  = total_t_dur - (allocation_t_dur + get_factors_t_dur + ungqr_t_dur + reorth_t_dur + qr_t_dur + gemm_A_t_dur + sketching_t_dur + r_cpy_t_dur + s_cpy_t_dur + norm_t_dur);
+        this -> times.resize(13);
+        this -> times = {allocation_t_dur, get_factors_t_dur, ungqr_t_dur, reorth_t_dur, qr_t_dur, gemm_A_t_dur, main_loop_t_dur, sketching_t_dur, r_cpy_t_dur, s_cpy_t_dur, norm_t_dur, t_rest, total_t_dur};
+
+        if (this -> verbose) {
+            printf("\n\n/------------RBKI TWO-PASS TIMING RESULTS BEGIN------------/\n");
+            printf("Basic info: b_sz=%ld krylov_iters=%d reorths=%d\n", k, num_krylov_iters, num_reorths);
+
+            printf("Allocate and free time:          %25ld μs,\n", allocation_t_dur);
+            printf("Time to acquire the SVD factors: %25ld μs,\n", get_factors_t_dur);
+            printf("UNGQR time:                      %25ld μs,\n", ungqr_t_dur);
+            printf("Reorthogonalization time:        %25ld μs,\n", reorth_t_dur);
+            printf("QR time:                         %25ld μs,\n", qr_t_dur);
+            printf("GEMM A time:                     %25ld μs,\n", gemm_A_t_dur);
+            printf("Sketching time:                  %25ld μs,\n", sketching_t_dur);
+            printf("R_ii cpy time:                   %25ld μs,\n", r_cpy_t_dur);
+            printf("S_ii cpy time:                   %25ld μs,\n", s_cpy_t_dur);
+            printf("Norm R time:                     %25ld μs,\n", norm_t_dur);
+            printf("/-------------RBKI TWO-PASS TIMING RESULTS END-------------/\n\n");
+        }
+    }
+
+    free(work_grown);
+
+    // The replay diverged from the first pass, so X_ev and Y_od no longer match U_hat and VT_hat.
+    if (this->replay_err > this->replay_tol * norm_A) {
+        state = state_start;
+        return 1;
+    }
     return 0;
 }
 } // end namespace RandLAPACK
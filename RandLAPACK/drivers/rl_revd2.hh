@@ -5,6 +5,7 @@
 #include "rl_blaspp.hh"
 #include "rl_lapackpp.hh"
 #include "rl_util.hh"
+#include "rl_lapack_work.hh"
 #include "rl_linops.hh"
 
 #include <RandBLAS.hh>
@@ -106,6 +107,48 @@ class REVD2 : public REVD2alg<T, RNG> {
             RandBLAS::RNGState<RNG> &state
         ) override;
 
+        /// Returns the size (in bytes) of the workspace that the call() overload below
+        /// requires for an m-by-m matrix and ranks of up to k.
+        int64_t workspace_query(
+            int64_t m,
+            int64_t k
+        );
+
+        /// Same as above, but the internal buffers are placed into a caller-owned workspace
+        /// of at least workspace_query(m, k) bytes, aligned to 64 bytes.
+        /// The rank estimate only grows while the workspace can accommodate it;
+        /// if the tolerance is not met by then, returns 1.
+        /// To avoid reallocations, V and eigvals should be sized for the largest rank.
+        int call(
+            SymmetricLinearOperator<T> &A,
+            int64_t &k,
+            T tol,
+            std::vector<T> &V,
+            std::vector<T> &eigvals,
+            RandBLAS::RNGState<RNG> &state,
+            void* work,
+            int64_t work_bytes
+        );
+
+    private:
+        /// Performs a single pass of the algorithm with a fixed rank k.
+        /// Returns the error estimate, sets nu to the regularization parameter.
+        T call_fixed_rank(
+            SymmetricLinearOperator<T> &A,
+            int64_t k,
+            T* V_dat,
+            T* eigvals,
+            T* Y_dat,
+            T* R_dat,
+            T* S_dat,
+            T* symrf_work_dat,
+            T* svd_work_dat,
+            int64_t lwork_svd,
+            RandBLAS::RNGState<RNG> &state,
+            RandBLAS::RNGState<RNG> &error_est_state,
+            T &nu
+        );
+
     public:
         RandLAPACK::SymmetricRangeFinder<T, RNG> &SYRF_Obj;
         int error_est_p;
@@ -116,6 +159,7 @@ class REVD2 : public REVD2alg<T, RNG> {
         std::vector<T> R;
         std::vector<T> S;
         std::vector<T> symrf_work;
+        std::vector<T> svd_work;
 };
 
 // -----------------------------------------------------------------------------
@@ -174,6 +218,97 @@ T power_error_est(
 }
 
 
+template <typename T, typename RNG>
+T REVD2<T, RNG>::call_fixed_rank(
+        SymmetricLinearOperator<T> &A,
+        int64_t k,
+        T* V_dat,
+        T* eigvals,
+        T* Y_dat,
+        T* R_dat,
+        T* S_dat,
+        T* symrf_work_dat,
+        T* svd_work_dat,
+        int64_t lwork_svd,
+        RandBLAS::RNGState<RNG> &state,
+        RandBLAS::RNGState<RNG> &error_est_state,
+        T &nu
+) {
+    int64_t m = A.m;
+    T* Omega_dat = util::upsize(m * k, this->Omega);
+
+    // Construnct a sketching operator
+    // If CholeskyQR is used for stab/orth here, RF can fail
+    this->SYRF_Obj.call(A, k, this->Omega, state, symrf_work_dat);
+
+    // Y = A * Omega
+    A(Layout::ColMajor, k, 1.0, Omega_dat, m, 0.0, Y_dat, m);
+
+    nu = std::numeric_limits<T>::epsilon() * util::lange(Norm::Fro, m, k, Y_dat, m, (T*) nullptr);
+
+    // We need Y = Y + v Omega
+    // We further need R = chol(Omega' Y)
+    // Solve this as R = chol(Omega' Y + v Omega'Omega)
+    // Compute v Omega' Omega; syrk only computes the lower triangular part. Need full.
+    blas::syrk(Layout::ColMajor, Uplo::Lower, Op::Trans, k, m, nu, Omega_dat, m, 0.0, R_dat, k);
+    for(int i = 1; i < k; ++i)
+        blas::copy(k - i, &R_dat[i + ((i-1) * k)], 1, &R_dat[(i - 1) + (i * k)], k);
+    // Compute Omega' Y + v Omega' Omega
+    blas::gemm(Layout::ColMajor, Op::Trans, Op::NoTrans, k, k, m, 1.0, Omega_dat, m, Y_dat, m, 1.0, R_dat, k);
+
+    // Compute R = chol(Omega' Y + v Omega' Omega)
+    // Looks like if POTRF gets passed a non-triangular matrix, it will also output a non-triangular one
+    if(lapack::potrf(Uplo::Upper, k, R_dat, k))
+        throw std::runtime_error("Cholesky decomposition failed.");
+    RandLAPACK::util::get_U(k, k, R_dat, k);
+
+    // B = Y(R')^-1 - need to transpose R
+    blas::trsm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, m, k, 1.0, R_dat, k, Y_dat, m);
+
+    //[V, S, ~] = SVD(B)
+    // Although we don't need the right singular vectors, we need to give space for those.
+    // Use R as a buffer for that.
+    util::gesdd(Job::SomeVec, m, k, Y_dat, m, S_dat, V_dat, m, R_dat, k, svd_work_dat, lwork_svd);
+
+    // eigvals = diag(S^2)
+    T buf;
+    int64_t r = 0;
+    int i;
+    for(i = 0; i < k; ++i) {
+        buf = std::pow(S_dat[i], 2);
+        eigvals[i] = buf;
+        // r = number of entries in eigvals that are greater than v
+        if(buf > nu)
+            ++r;
+    }
+
+    // Undo regularlization
+    // Need to make sure no eigenvalue is negative
+    for(i = 0; i < r; ++i)
+        (eigvals[i] - nu < 0) ? 0 : eigvals[i] -=nu;
+
+    std::fill(&V_dat[m * r], &V_dat[m * k], 0.0);
+
+    // Error estimation
+    // Using the first column of Omega as a buffer for a random vector
+    // To perform the following safely, need to make sure Omega has at least 4 columns
+    Omega_dat = util::upsize(m * 4, this->Omega);
+    RandBLAS::DenseDist  g(m, 1);
+    error_est_state = RandBLAS::fill_dense(g, Omega_dat, error_est_state).second;
+
+    return power_error_est(A, k, this->error_est_p, Omega_dat, V_dat, Y_dat, eigvals); 
+}
+
+template <typename T, typename RNG>
+int64_t REVD2<T, RNG>::workspace_query(
+        int64_t m,
+        int64_t k
+) {
+    return 2 * util::workspace_bytes<T>(m * k)    // Y, symrf_work
+         + 2 * util::workspace_bytes<T>(k * k)    // R, S
+         + util::workspace_bytes<T>(util::gesdd_work_size<T>(Job::SomeVec, m, k));
+}
+
 template <typename T, typename RNG>
 int REVD2<T, RNG>::call(
         SymmetricLinearOperator<T> &A,
@@ -185,77 +320,20 @@ int REVD2<T, RNG>::call(
 ) {
     int64_t m = A.m;
     T err = 0;
+    T nu = 0;
     RandBLAS::RNGState<RNG> error_est_state(state.counter, state.key);
     error_est_state.key.incr(1);
     while(true) {
-        util::upsize(k, eigvals);
+        T* eigvals_dat = util::upsize(k, eigvals);
         T* V_dat = util::upsize(m * k, V);
         T* Y_dat = util::upsize(m * k, this->Y);
-        T* Omega_dat = util::upsize(m * k, this->Omega);
         T* R_dat = util::upsize(k * k, this->R);
         T* S_dat = util::upsize(k * k, this->S);
         T* symrf_work_dat = util::upsize(m * k, this->symrf_work);
+        int64_t lwork_svd = util::gesdd_work_size<T>(Job::SomeVec, m, k);
+        T* svd_work_dat = util::upsize(lwork_svd, this->svd_work);
 
-        // Construnct a sketching operator
-        // If CholeskyQR is used for stab/orth here, RF can fail
-        this->SYRF_Obj.call(A, k, this->Omega, state, symrf_work_dat);
-
-        // Y = A * Omega
-        A(Layout::ColMajor, k, 1.0, Omega_dat, m, 0.0, Y_dat, m);
-
-        T nu = std::numeric_limits<T>::epsilon() * lapack::lange(Norm::Fro, m, k, Y_dat, m);
-
-        // We need Y = Y + v Omega
-        // We further need R = chol(Omega' Y)
-        // Solve this as R = chol(Omega' Y + v Omega'Omega)
-        // Compute v Omega' Omega; syrk only computes the lower triangular part. Need full.
-        blas::syrk(Layout::ColMajor, Uplo::Lower, Op::Trans, k, m, nu, Omega_dat, m, 0.0, R_dat, k);
-        for(int i = 1; i < k; ++i)
-            blas::copy(k - i, &R_dat[i + ((i-1) * k)], 1, &R_dat[(i - 1) + (i * k)], k);
-        // Compute Omega' Y + v Omega' Omega
-        blas::gemm(Layout::ColMajor, Op::Trans, Op::NoTrans, k, k, m, 1.0, Omega_dat, m, Y_dat, m, 1.0, R_dat, k);
-
-        // Compute R = chol(Omega' Y + v Omega' Omega)
-        // Looks like if POTRF gets passed a non-triangular matrix, it will also output a non-triangular one
-        if(lapack::potrf(Uplo::Upper, k, R_dat, k))
-            throw std::runtime_error("Cholesky decomposition failed.");
-        RandLAPACK::util::get_U(k, k, R_dat, k);
-
-        // B = Y(R')^-1 - need to transpose R
-        blas::trsm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, m, k, 1.0, R_dat, k, Y_dat, m);
-
-        //[V, S, ~] = SVD(B)
-        // Although we don't need the right singular vectors, we need to give space for those.
-        // Use R as a buffer for that.
-        lapack::gesdd(Job::SomeVec, m, k, Y_dat, m, S_dat, V_dat, m, R_dat, k);
-
-        // eigvals = diag(S^2)
-        T buf;
-        int64_t r = 0;
-        int i;
-        for(i = 0; i < k; ++i) {
-            buf = std::pow(S[i], 2);
-            eigvals[i] = buf;
-            // r = number of entries in eigvals that are greater than v
-            if(buf > nu)
-                ++r;
-        }
-
-        // Undo regularlization
-        // Need to make sure no eigenvalue is negative
-        for(i = 0; i < r; ++i)
-            (eigvals[i] - nu < 0) ? 0 : eigvals[i] -=nu;
-
-        std::fill(&V_dat[m * r], &V_dat[m * k], 0.0);
-
-        // Error estimation
-        // Using the first column of Omega as a buffer for a random vector
-        // To perform the following safely, need to make sure Omega has at least 4 columns
-        Omega_dat = util::upsize(m * 4, this->Omega);
-        RandBLAS::DenseDist  g(m, 1);
-        error_est_state = RandBLAS::fill_dense(g, Omega_dat, error_est_state).second;
-
-        err = power_error_est(A, k, this->error_est_p, Omega_dat, V_dat, Y_dat, eigvals.data()); 
+        err = this->call_fixed_rank(A, k, V_dat, eigvals_dat, Y_dat, R_dat, S_dat, symrf_work_dat, svd_work_dat, lwork_svd, state, error_est_state, nu);
 
         if(err <= 5 * std::max(tol, nu) || k == m) {
             break;
@@ -268,6 +346,49 @@ int REVD2<T, RNG>::call(
     return 0;
 }
 
+template <typename T, typename RNG>
+int REVD2<T, RNG>::call(
+        SymmetricLinearOperator<T> &A,
+        int64_t &k,
+        T tol,
+        std::vector<T> &V,
+        std::vector<T> &eigvals,
+        RandBLAS::RNGState<RNG> &state,
+        void* work,
+        int64_t work_bytes
+) {
+    int64_t m = A.m;
+    int64_t k_next;
+    T err = 0;
+    T nu = 0;
+    RandBLAS::RNGState<RNG> error_est_state(state.counter, state.key);
+    error_est_state.key.incr(1);
+    while(true) {
+        // The workspace is re-partitioned for every new rank estimate.
+        util::Workspace ws(work, work_bytes);
+        T* Y_dat = ws.take<T>(m * k);
+        T* R_dat = ws.take<T>(k * k);
+        T* S_dat = ws.take<T>(k * k);
+        T* symrf_work_dat = ws.take<T>(m * k);
+        int64_t lwork_svd = util::gesdd_work_size<T>(Job::SomeVec, m, k);
+        T* svd_work_dat = ws.take<T>(lwork_svd);
+        T* eigvals_dat = util::upsize(k, eigvals);
+        T* V_dat = util::upsize(m * k, V);
+
+        err = this->call_fixed_rank(A, k, V_dat, eigvals_dat, Y_dat, R_dat, S_dat, symrf_work_dat, svd_work_dat, lwork_svd, state, error_est_state, nu);
+
+        if(err <= 5 * std::max(tol, nu) || k == m)
+            break;
+
+        k_next = (2 * k > m) ? m : 2 * k;
+        // Workspace exhausted before reaching the tolerance.
+        if(this->workspace_query(m, k_next) > work_bytes)
+            return 1;
+        k = k_next;
+    }
+    return 0;
+}
+
 template <typename T, typename RNG>
 int REVD2<T, RNG>::call(
         Uplo uplo,
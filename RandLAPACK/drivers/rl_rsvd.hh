@@ -4,6 +4,7 @@
 #include "rl_blaspp.hh"
 #include "rl_lapackpp.hh"
 #include "rl_util.hh"
+#include "rl_lapack_work.hh"
 
 #include <RandBLAS.hh>
 #include <cstdint>
@@ -28,6 +29,26 @@ class RSVDalg {
             T* &V,
             RandBLAS::RNGState<RNG> &state
         ) = 0;
+
+        virtual int64_t workspace_query(
+            int64_t m,
+            int64_t n,
+            int64_t k
+        ) = 0;
+
+        virtual int call(
+            int64_t m,
+            int64_t n,
+            T* A,
+            int64_t &k,
+            T tol,
+            T* U,
+            T* S,
+            T* V,
+            RandBLAS::RNGState<RNG> &state,
+            void* work,
+            int64_t work_bytes
+        ) = 0;
 };
 
 template <typename T, typename RNG>
@@ -103,11 +124,50 @@ class RSVD : public RSVDalg<T, RNG> {
             RandBLAS::RNGState<RNG> &state
         ) override;
 
+        /// Returns the size (in bytes) of the workspace that the call() overload below
+        /// requires for an m by n input and expected rank k.
+        int64_t workspace_query(
+            int64_t m,
+            int64_t n,
+            int64_t k
+        ) override;
+
+        /// Same as above, but U (m by k), S (k) and V (n by k) are caller-owned buffers of full size,
+        /// and all internal buffers (including those of QB) are placed into a caller-owned workspace
+        /// of at least workspace_query(m, n, k) bytes, aligned to 64 bytes.
+        int call(
+            int64_t m,
+            int64_t n,
+            T* A,
+            int64_t &k,
+            T tol,
+            T* U,
+            T* S,
+            T* V,
+            RandBLAS::RNGState<RNG> &state,
+            void* work,
+            int64_t work_bytes
+        ) override;
+
     public:
         RandLAPACK::QBalg<T, RNG> &QB_Obj;
         int64_t block_sz;
 };
 
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int64_t RSVD<T, RNG>::workspace_query(
+    int64_t m,
+    int64_t n,
+    int64_t k
+){
+    return util::workspace_bytes<T>(m * k)      // Q
+         + util::workspace_bytes<T>(n * k)      // BT
+         + util::workspace_bytes<T>(k * k)      // UT_buf
+         + util::workspace_bytes<T>(util::gesdd_work_size<T>(Job::SomeVec, n, k))
+         + this->QB_Obj.workspace_query(m, n, k, this->block_sz);
+}
+
 // -----------------------------------------------------------------------------
 template <typename T, typename RNG>
 int RSVD<T, RNG>::call(
@@ -121,25 +181,52 @@ int RSVD<T, RNG>::call(
     T* &V,
     RandBLAS::RNGState<RNG> &state
 ){
-    T* Q = nullptr;
-    T* BT = nullptr; 
-    // Q and B sizes will be adjusted automatically
-    this->QB_Obj.call(m, n, A, k, this->block_sz, tol, Q, BT, state);
-
-    T* UT_buf  = ( T * ) calloc(k * k, sizeof( T ) );
     // Making sure all vectors are large enough
     U  = ( T * ) calloc(m * k, sizeof( T ) );
     S  = ( T * ) calloc(k,     sizeof( T ) );
     V  = ( T * ) calloc(n * k, sizeof( T ) );
 
+    int64_t work_bytes = this->workspace_query(m, n, k);
+    void* work = util::workspace_alloc(work_bytes);
+
+    int info = this->call(m, n, A, k, tol, U, S, V, state, work, work_bytes);
+
+    free(work);
+    return info;
+}
+
+// -----------------------------------------------------------------------------
+template <typename T, typename RNG>
+int RSVD<T, RNG>::call(
+    int64_t m,
+    int64_t n,
+    T* A,
+    int64_t &k,
+    T tol,
+    T* U,
+    T* S,
+    T* V,
+    RandBLAS::RNGState<RNG> &state,
+    void* work,
+    int64_t work_bytes
+){
+    // Sizes are planned for the expected rank, QB may return a smaller k.
+    int64_t qb_bytes = this->QB_Obj.workspace_query(m, n, k, this->block_sz);
+    util::Workspace ws(work, work_bytes);
+    T* Q      = ws.take<T>(m * k);
+    T* BT     = ws.take<T>(n * k);
+    T* UT_buf = ws.take<T>(k * k);
+    int64_t lwork = util::gesdd_work_size<T>(Job::SomeVec, n, k);
+    T* svd_work   = ws.take<T>(lwork);
+    void* qb_work = (void*) ws.take<char>(qb_bytes);
+
+    this->QB_Obj.call(m, n, A, k, this->block_sz, tol, Q, BT, state, qb_work, qb_bytes);
+
     // SVD of B
-    lapack::gesdd(Job::SomeVec, n, k, BT, n, S, V, n, UT_buf, k);
+    util::gesdd(Job::SomeVec, n, k, BT, n, S, V, n, UT_buf, k, svd_work, lwork);
     // Adjusting U
     blas::gemm(Layout::ColMajor, Op::NoTrans, Op::Trans, m, k, k, 1.0, Q, m, UT_buf, k, 0.0, U, m);
 
-    free(Q);
-    free(BT);
-    free(UT_buf);
     return 0;
 }
 
@@ -0,0 +1,424 @@
+#pragma once
+
+#include "rl_blaspp.hh"
+#include "rl_lapackpp.hh"
+
+#include <lapack/fortran.h>
+#include <lapack/config.h>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+
+/// LAPACK routines called with caller-supplied work arrays.
+///
+/// The LAPACK++ wrappers of the routines below allocate their work arrays (and, if lapack_int is
+/// narrower than int64_t, copies of the pivot vectors) on every call. The versions here take
+/// these from the caller instead: each routine X comes with X_work_size<T>(), the number of entries
+/// of type T that its 'work' argument must hold. Integer arrays that LAPACK needs in its own integer
+/// type are placed at the end of that same array, so one buffer per call is enough.
+/// Drivers take the work arrays from their util::Workspace, and helper objects keep them
+/// in member vectors that are only grown.
+namespace RandLAPACK::util {
+
+/// Number of entries of type T that hold n entries of type lapack_int.
+template <typename T>
+int64_t lapack_int_entries(
+    int64_t n
+) {
+    return (std::max(n, (int64_t) 0) * (int64_t) sizeof(lapack_int) + (int64_t) sizeof(T) - 1) / (int64_t) sizeof(T);
+}
+
+/// Number of entries of type T needed to pass n pivots (stored as int64_t) to LAPACK.
+/// Zero if lapack_int is 64 bits wide, in which case the pivots are passed as they are.
+template <typename T>
+int64_t lapack_pivot_entries(
+    int64_t n
+) {
+    if constexpr (sizeof(lapack_int) == sizeof(int64_t)) {
+        return 0;
+    } else {
+        return lapack_int_entries<T>(n);
+    }
+}
+
+/// Turns the optimal lwork returned by a workspace query into an entry count.
+template <typename T>
+int64_t lapack_lwork(
+    T query
+) {
+    return std::max((int64_t) 1, (int64_t) query);
+}
+
+// -----------------------------------------------------------------------------
+/// Work array size of util::geqrf.
+template <typename T>
+int64_t geqrf_work_size(
+    int64_t m,
+    int64_t n
+) {
+    lapack_int m_ = (lapack_int) m, n_ = (lapack_int) n, lda_ = (lapack_int) std::max(m, (int64_t) 1);
+    lapack_int lwork_ = -1, info_ = 0;
+    T query = 0;
+    if constexpr (std::is_same_v<T, double>) {
+        LAPACK_dgeqrf(&m_, &n_, nullptr, &lda_, nullptr, &query, &lwork_, &info_);
+    } else {
+        LAPACK_sgeqrf(&m_, &n_, nullptr, &lda_, nullptr, &query, &lwork_, &info_);
+    }
+    return lapack_lwork(query);
+}
+
+/// Same as lapack::geqrf, with a work array of lwork >= geqrf_work_size<T>(m, n) entries.
+template <typename T>
+int64_t geqrf(
+    int64_t m,
+    int64_t n,
+    T* A,
+    int64_t lda,
+    T* tau,
+    T* work,
+    int64_t lwork
+) {
+    lapack_int m_ = (lapack_int) m, n_ = (lapack_int) n, lda_ = (lapack_int) lda;
+    lapack_int lwork_ = (lapack_int) lwork, info_ = 0;
+    if constexpr (std::is_same_v<T, double>) {
+        LAPACK_dgeqrf(&m_, &n_, A, &lda_, tau, work, &lwork_, &info_);
+    } else {
+        LAPACK_sgeqrf(&m_, &n_, A, &lda_, tau, work, &lwork_, &info_);
+    }
+    return info_;
+}
+
+// -----------------------------------------------------------------------------
+/// Work array size of util::ungqr.
+template <typename T>
+int64_t ungqr_work_size(
+    int64_t m,
+    int64_t n,
+    int64_t k
+) {
+    lapack_int m_ = (lapack_int) m, n_ = (lapack_int) n, k_ = (lapack_int) k, lda_ = (lapack_int) std::max(m, (int64_t) 1);
+    lapack_int lwork_ = -1, info_ = 0;
+    T query = 0;
+    if constexpr (std::is_same_v<T, double>) {
+        LAPACK_dorgqr(&m_, &n_, &k_, nullptr, &lda_, nullptr, &query, &lwork_, &info_);
+    } else {
+        LAPACK_sorgqr(&m_, &n_, &k_, nullptr, &lda_, nullptr, &query, &lwork_, &info_);
+    }
+    return lapack_lwork(query);
+}
+
+/// Same as lapack::ungqr, with a work array of lwork >= ungqr_work_size<T>(m, n, k) entries.
+template <typename T>
+int64_t ungqr(
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    T* A,
+    int64_t lda,
+    const T* tau,
+    T* work,
+    int64_t lwork
+) {
+    lapack_int m_ = (lapack_int) m, n_ = (lapack_int) n, k_ = (lapack_int) k, lda_ = (lapack_int) lda;
+    lapack_int lwork_ = (lapack_int) lwork, info_ = 0;
+    if constexpr (std::is_same_v<T, double>) {
+        LAPACK_dorgqr(&m_, &n_, &k_, A, &lda_, tau, work, &lwork_, &info_);
+    } else {
+        LAPACK_sorgqr(&m_, &n_, &k_, A, &lda_, tau, work, &lwork_, &info_);
+    }
+    return info_;
+}
+
+// -----------------------------------------------------------------------------
+/// Work array size of util::ormqr.
+template <typename T>
+int64_t ormqr_work_size(
+    Side side,
+    Op trans,
+    int64_t m,
+    int64_t n,
+    int64_t k
+) {
+    char side_ = blas::side2char(side), trans_ = blas::op2char(trans);
+    lapack_int m_ = (lapack_int) m, n_ = (lapack_int) n, k_ = (lapack_int) k;
+    lapack_int lda_ = (lapack_int) std::max(side == Side::Left ? m : n, (int64_t) 1);
+    lapack_int ldc_ = (lapack_int) std::max(m, (int64_t) 1);
+    lapack_int lwork_ = -1, info_ = 0;
+    T query = 0;
+    if constexpr (std::is_same_v<T, double>) {
+        LAPACK_dormqr(&side_, &trans_, &m_, &n_, &k_, nullptr, &lda_, nullptr, nullptr, &ldc_, &query, &lwork_, &info_);
+    } else {
+        LAPACK_sormqr(&side_, &trans_, &m_, &n_, &k_, nullptr, &lda_, nullptr, nullptr, &ldc_, &query, &lwork_, &info_);
+    }
+    return lapack_lwork(query);
+}
+
+/// Same as lapack::ormqr, with a work array of lwork >= ormqr_work_size<T>(side, trans, m, n, k) entries.
+template <typename T>
+int64_t ormqr(
+    Side side,
+    Op trans,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    const T* A,
+    int64_t lda,
+    const T* tau,
+    T* C,
+    int64_t ldc,
+    T* work,
+    int64_t lwork
+) {
+    char side_ = blas::side2char(side), trans_ = blas::op2char(trans);
+    lapack_int m_ = (lapack_int) m, n_ = (lapack_int) n, k_ = (lapack_int) k;
+    lapack_int lda_ = (lapack_int) lda, ldc_ = (lapack_int) ldc;
+    lapack_int lwork_ = (lapack_int) lwork, info_ = 0;
+    if constexpr (std::is_same_v<T, double>) {
+        LAPACK_dormqr(&side_, &trans_, &m_, &n_, &k_, A, &lda_, tau, C, &ldc_, work, &lwork_, &info_);
+    } else {
+        LAPACK_sormqr(&side_, &trans_, &m_, &n_, &k_, A, &lda_, tau, C, &ldc_, work, &lwork_, &info_);
+    }
+    return info_;
+}
+
+// -----------------------------------------------------------------------------
+/// Work array size of util::gemqrt.
+template <typename T>
+int64_t gemqrt_work_size(
+    Side side,
+    int64_t m,
+    int64_t n,
+    int64_t nb
+) {
+    return std::max((int64_t) 1, nb * (side == Side::Left ? n : m));
+}
+
+/// Same as lapack::gemqrt, with a work array of at least gemqrt_work_size<T>(side, m, n, nb) entries.
+template <typename T>
+int64_t gemqrt(
+    Side side,
+    Op trans,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    int64_t nb,
+    const T* V,
+    int64_t ldv,
+    const T* T_dat,
+    int64_t ldt,
+    T* C,
+    int64_t ldc,
+    T* work
+) {
+    char side_ = blas::side2char(side), trans_ = blas::op2char(trans);
+    lapack_int m_ = (lapack_int) m, n_ = (lapack_int) n, k_ = (lapack_int) k, nb_ = (lapack_int) nb;
+    lapack_int ldv_ = (lapack_int) ldv, ldt_ = (lapack_int) ldt, ldc_ = (lapack_int) ldc;
+    lapack_int info_ = 0;
+    if constexpr (std::is_same_v<T, double>) {
+        LAPACK_dgemqrt(&side_, &trans_, &m_, &n_, &k_, &nb_, V, &ldv_, T_dat, &ldt_, C, &ldc_, work, &info_);
+    } else {
+        LAPACK_sgemqrt(&side_, &trans_, &m_, &n_, &k_, &nb_, V, &ldv_, T_dat, &ldt_, C, &ldc_, work, &info_);
+    }
+    return info_;
+}
+
+// -----------------------------------------------------------------------------
+/// Work array size of util::geqp3.
+template <typename T>
+int64_t geqp3_work_size(
+    int64_t m,
+    int64_t n
+) {
+    lapack_int m_ = (lapack_int) m, n_ = (lapack_int) n, lda_ = (lapack_int) std::max(m, (int64_t) 1);
+    lapack_int lwork_ = -1, info_ = 0;
+    T query = 0;
+    if constexpr (std::is_same_v<T, double>) {
+        LAPACK_dgeqp3(&m_, &n_, nullptr, &lda_, nullptr, nullptr, &query, &lwork_, &info_);
+    } else {
+        LAPACK_sgeqp3(&m_, &n_, nullptr, &lda_, nullptr, nullptr, &query, &lwork_, &info_);
+    }
+    return lapack_lwork(query) + lapack_pivot_entries<T>(n);
+}
+
+/// Same as lapack::geqp3, with a work array of lwork >= geqp3_work_size<T>(m, n) entries.
+/// As in geqp3, the nonzero entries of jpvt mark the columns that are moved to the front.
+template <typename T>
+int64_t geqp3(
+    int64_t m,
+    int64_t n,
+    T* A,
+    int64_t lda,
+    int64_t* jpvt,
+    T* tau,
+    T* work,
+    int64_t lwork
+) {
+    lapack_int m_ = (lapack_int) m, n_ = (lapack_int) n, lda_ = (lapack_int) lda;
+    lapack_int info_ = 0;
+    lapack_int* jpvt_;
+    if constexpr (sizeof(lapack_int) == sizeof(int64_t)) {
+        jpvt_ = (lapack_int*) jpvt;
+    } else {
+        lwork -= lapack_pivot_entries<T>(n);
+        jpvt_ = (lapack_int*) &work[lwork];
+        std::copy(jpvt, &jpvt[n], jpvt_);
+    }
+    lapack_int lwork_ = (lapack_int) lwork;
+    if constexpr (std::is_same_v<T, double>) {
+        LAPACK_dgeqp3(&m_, &n_, A, &lda_, jpvt_, tau, work, &lwork_, &info_);
+    } else {
+        LAPACK_sgeqp3(&m_, &n_, A, &lda_, jpvt_, tau, work, &lwork_, &info_);
+    }
+    if constexpr (sizeof(lapack_int) != sizeof(int64_t))
+        std::copy(jpvt_, &jpvt_[n], jpvt);
+    return info_;
+}
+
+// -----------------------------------------------------------------------------
+/// Work array size of util::gesdd.
+template <typename T>
+int64_t gesdd_work_size(
+    Job jobz,
+    int64_t m,
+    int64_t n
+) {
+    char jobz_ = lapack::job2char(jobz);
+    lapack_int m_ = (lapack_int) m, n_ = (lapack_int) n, lda_ = (lapack_int) std::max(m, (int64_t) 1);
+    lapack_int ldu_ = lda_, ldvt_ = (lapack_int) std::max(n, (int64_t) 1);
+    lapack_int lwork_ = -1, info_ = 0;
+    lapack_int iwork_query = 0;
+    T query = 0;
+    if constexpr (std::is_same_v<T, double>) {
+        LAPACK_dgesdd(&jobz_, &m_, &n_, nullptr, &lda_, nullptr, nullptr, &ldu_, nullptr, &ldvt_, &query, &lwork_, &iwork_query, &info_);
+    } else {
+        LAPACK_sgesdd(&jobz_, &m_, &n_, nullptr, &lda_, nullptr, nullptr, &ldu_, nullptr, &ldvt_, &query, &lwork_, &iwork_query, &info_);
+    }
+    return lapack_lwork(query) + lapack_int_entries<T>(8 * std::min(m, n));
+}
+
+/// Same as lapack::gesdd, with a work array of lwork >= gesdd_work_size<T>(jobz, m, n) entries.
+template <typename T>
+int64_t gesdd(
+    Job jobz,
+    int64_t m,
+    int64_t n,
+    T* A,
+    int64_t lda,
+    T* S,
+    T* U,
+    int64_t ldu,
+    T* VT,
+    int64_t ldvt,
+    T* work,
+    int64_t lwork
+) {
+    char jobz_ = lapack::job2char(jobz);
+    lapack_int m_ = (lapack_int) m, n_ = (lapack_int) n, lda_ = (lapack_int) lda;
+    lapack_int ldu_ = (lapack_int) ldu, ldvt_ = (lapack_int) ldvt;
+    lapack_int info_ = 0;
+    // The integer work array of 8 * min(m, n) entries is placed at the end of work.
+    lwork -= lapack_int_entries<T>(8 * std::min(m, n));
+    lapack_int* iwork_ = (lapack_int*) &work[lwork];
+    lapack_int lwork_ = (lapack_int) lwork;
+    if constexpr (std::is_same_v<T, double>) {
+        LAPACK_dgesdd(&jobz_, &m_, &n_, A, &lda_, S, U, &ldu_, VT, &ldvt_, work, &lwork_, iwork_, &info_);
+    } else {
+        LAPACK_sgesdd(&jobz_, &m_, &n_, A, &lda_, S, U, &ldu_, VT, &ldvt_, work, &lwork_, iwork_, &info_);
+    }
+    return info_;
+}
+
+// -----------------------------------------------------------------------------
+/// Same as lapack::getrf, with the pivots kept in LAPACK's integer type,
+/// so that they can be passed to util::laswp without a conversion.
+template <typename T>
+int64_t getrf(
+    int64_t m,
+    int64_t n,
+    T* A,
+    int64_t lda,
+    lapack_int* ipiv
+) {
+    lapack_int m_ = (lapack_int) m, n_ = (lapack_int) n, lda_ = (lapack_int) lda;
+    lapack_int info_ = 0;
+    if constexpr (std::is_same_v<T, double>) {
+        LAPACK_dgetrf(&m_, &n_, A, &lda_, ipiv, &info_);
+    } else {
+        LAPACK_sgetrf(&m_, &n_, A, &lda_, ipiv, &info_);
+    }
+    return info_;
+}
+
+/// Same as lapack::laswp, with the pivots in LAPACK's integer type, as returned by util::getrf.
+template <typename T>
+void laswp(
+    int64_t n,
+    T* A,
+    int64_t lda,
+    int64_t k1,
+    int64_t k2,
+    const lapack_int* ipiv,
+    int64_t incx
+) {
+    lapack_int n_ = (lapack_int) n, lda_ = (lapack_int) lda;
+    lapack_int k1_ = (lapack_int) k1, k2_ = (lapack_int) k2, incx_ = (lapack_int) incx;
+    if constexpr (std::is_same_v<T, double>) {
+        LAPACK_dlaswp(&n_, A, &lda_, &k1_, &k2_, ipiv, &incx_);
+    } else {
+        LAPACK_slaswp(&n_, A, &lda_, &k1_, &k2_, ipiv, &incx_);
+    }
+}
+
+// -----------------------------------------------------------------------------
+/// Work array size of util::lange and util::lantr.
+template <typename T>
+int64_t lange_work_size(
+    Norm norm,
+    int64_t m
+) {
+    return (norm == Norm::Inf) ? std::max(m, (int64_t) 1) : 0;
+}
+
+/// Same as lapack::lange, with a work array of at least lange_work_size<T>(norm, m) entries
+/// (none for any norm other than Norm::Inf, in which case work may be nullptr).
+template <typename T>
+T lange(
+    Norm norm,
+    int64_t m,
+    int64_t n,
+    const T* A,
+    int64_t lda,
+    T* work
+) {
+    char norm_ = lapack::norm2char(norm);
+    lapack_int m_ = (lapack_int) m, n_ = (lapack_int) n, lda_ = (lapack_int) lda;
+    if constexpr (std::is_same_v<T, double>) {
+        return LAPACK_dlange(&norm_, &m_, &n_, A, &lda_, work);
+    } else {
+        return (T) LAPACK_slange(&norm_, &m_, &n_, A, &lda_, work);
+    }
+}
+
+/// Same as lapack::lantr, with a work array of at least lange_work_size<T>(norm, m) entries.
+template <typename T>
+T lantr(
+    Norm norm,
+    Uplo uplo,
+    Diag diag,
+    int64_t m,
+    int64_t n,
+    const T* A,
+    int64_t lda,
+    T* work
+) {
+    char norm_ = lapack::norm2char(norm), uplo_ = blas::uplo2char(uplo), diag_ = blas::diag2char(diag);
+    lapack_int m_ = (lapack_int) m, n_ = (lapack_int) n, lda_ = (lapack_int) lda;
+    if constexpr (std::is_same_v<T, double>) {
+        return LAPACK_dlantr(&norm_, &uplo_, &diag_, &m_, &n_, A, &lda_, work);
+    } else {
+        return (T) LAPACK_slantr(&norm_, &uplo_, &diag_, &m_, &n_, A, &lda_, work);
+    }
+}
+
+} // end namespace RandLAPACK::util
@@ -3,6 +3,8 @@
 #include "rl_blaspp.hh"
 #include "rl_lapackpp.hh"
 #include "rl_util.hh"
+#include "rl_lapack_work.hh"
+#include "rl_sparse.hh"
 
 #include <RandBLAS.hh>
 #include <iostream>
@@ -89,4 +91,263 @@ struct ExplicitSymLinOp : public SymmetricLinearOperator<T> {
 };
 
 
+
+template <typename T>
+struct LinearOperator {
+
+    const int64_t n_rows;
+    const int64_t n_cols;
+
+    LinearOperator(int64_t n_rows, int64_t n_cols) : n_rows(n_rows), n_cols(n_cols) {};
+
+    /* The semantics of this function are similar to blas::gemm.
+        * We compute
+        *      C = alpha * op(A) * B + beta * C
+        * where this LinearOperator object represents the n_rows-by-n_cols "A"
+        * and "B" has "n" columns. B and C are stored in a column-major format.
+        * For op = NoTrans, B has n_cols rows and C has n_rows rows;
+        * for op = Trans, it is the other way around.
+        * If beta is zero, C need not be initialized.
+    */
+    virtual void operator()(
+        Op op,
+        int64_t n,
+        T alpha,
+        const T* B,
+        int64_t ldb,
+        T beta,
+        T* C,
+        int64_t ldc
+    ) = 0;
+
+    // The Frobenius norm of A, or an estimate of it.
+    // Algorithms use it to decide when A has been captured to a given relative accuracy,
+    // so an overestimate delays such a decision, and an underestimate makes it premature.
+    virtual T fro_nrm() = 0;
+
+    virtual ~LinearOperator() {}
+};
+
+template <typename T>
+struct ExplicitLinOp : public LinearOperator<T> {
+
+    const T* A_buff;
+    const int64_t lda;
+    const Layout buff_layout;
+
+    ExplicitLinOp(
+        int64_t m,
+        int64_t n,
+        const T* A_buff,
+        int64_t lda,
+        Layout buff_layout
+    ) : LinearOperator<T>(m, n), A_buff(A_buff), lda(lda), buff_layout(buff_layout) {
+        randblas_require(lda >= ((buff_layout == Layout::ColMajor) ? m : n));
+    };
+
+    // A row-major A_buff is read as its transpose in a column-major format.
+    void operator()(
+        Op op,
+        int64_t n,
+        T alpha,
+        const T* B,
+        int64_t ldb,
+        T beta,
+        T* C,
+        int64_t ldc
+    ) {
+        int64_t rows_C = (op == Op::NoTrans) ? this->n_rows : this->n_cols;
+        int64_t rows_B = (op == Op::NoTrans) ? this->n_cols : this->n_rows;
+        randblas_require(ldb >= rows_B);
+        randblas_require(ldc >= rows_C);
+        Op blas_call_op = op;
+        if (this->buff_layout != Layout::ColMajor)
+            blas_call_op = (op == Op::NoTrans) ? Op::Trans : Op::NoTrans;
+        blas::gemm(
+            Layout::ColMajor, blas_call_op, Op::NoTrans, rows_C, n, rows_B, alpha,
+            this->A_buff, this->lda, B, ldb, beta, C, ldc
+        );
+    };
+
+    T fro_nrm() {
+        if (this->buff_layout == Layout::ColMajor)
+            return util::lange(Norm::Fro, this->n_rows, this->n_cols, this->A_buff, this->lda, (T*) nullptr);
+        return util::lange(Norm::Fro, this->n_cols, this->n_rows, this->A_buff, this->lda, (T*) nullptr);
+    };
+};
+
+// SpMat is either CSRMatrixView<T> or CSCMatrixView<T>.
+// The matrix is referenced, not copied, and needs to outlive this object.
+template <typename T, typename SpMat>
+struct SparseLinOp : public LinearOperator<T> {
+
+    const SpMat &A_sp;
+
+    SparseLinOp(
+        const SpMat &A_sp
+    ) : LinearOperator<T>(A_sp.n_rows, A_sp.n_cols), A_sp(A_sp) {};
+
+    void operator()(
+        Op op,
+        int64_t n,
+        T alpha,
+        const T* B,
+        int64_t ldb,
+        T beta,
+        T* C,
+        int64_t ldc
+    ) {
+        util::sparse_mult(op, this->A_sp, n, alpha, B, ldb, beta, C, ldc);
+    };
+
+    T fro_nrm() {
+        return util::sparse_fro_nrm(this->A_sp);
+    };
+};
+
+// Represents the product A = A1 * A2 of an m-by-p A1 and a p-by-n A2, without forming it.
+// Every application goes through an intermediate block with p rows, which is kept between calls.
+// The factors are referenced, not copied, and need to outlive this object.
+//
+// ||A1 * A2||_F is not available from the factors. Unless a hint is provided,
+// fro_nrm() returns the upper bound ||A1||_F * ||A2||_F.
+template <typename T>
+struct ComposedLinOp : public LinearOperator<T> {
+
+    LinearOperator<T> &A1;
+    LinearOperator<T> &A2;
+    const T fro_nrm_hint;
+    std::vector<T> work;
+
+    ComposedLinOp(
+        LinearOperator<T> &A1,
+        LinearOperator<T> &A2,
+        T fro_nrm_hint = -1.0
+    ) : LinearOperator<T>(A1.n_rows, A2.n_cols), A1(A1), A2(A2), fro_nrm_hint(fro_nrm_hint) {
+        randblas_require(A1.n_cols == A2.n_rows);
+    };
+
+    void operator()(
+        Op op,
+        int64_t n,
+        T alpha,
+        const T* B,
+        int64_t ldb,
+        T beta,
+        T* C,
+        int64_t ldc
+    ) {
+        int64_t p = this->A1.n_cols;
+        T* W = util::upsize(p * n, this->work);
+        if (op == Op::NoTrans) {
+            // C = alpha * A1 * (A2 * B) + beta * C
+            this->A2(Op::NoTrans, n, (T) 1.0, B, ldb, (T) 0.0, W, p);
+            this->A1(Op::NoTrans, n, alpha, W, p, beta, C, ldc);
+        } else {
+            // C = alpha * A2' * (A1' * B) + beta * C
+            this->A1(Op::Trans, n, (T) 1.0, B, ldb, (T) 0.0, W, p);
+            this->A2(Op::Trans, n, alpha, W, p, beta, C, ldc);
+        }
+    };
+
+    T fro_nrm() {
+        if (this->fro_nrm_hint >= 0)
+            return this->fro_nrm_hint;
+        return this->A1.fro_nrm() * this->A2.fro_nrm();
+    };
+};
+
+// Represents an m-by-n A whose entries are held in a lower precision T_low, typically a float A
+// applied to double blocks. Every product is formed by a gemm in T_low: B is rounded to T_low,
+// and op(A) * B is converted back to T, with alpha and beta applied in T.
+// Reading A then takes half the memory traffic, but every product carries a relative error
+// of about eps(T_low) * ||A||_F, which limits the accuracy of anything computed with this operator.
+// The rounded blocks are kept between calls.
+template <typename T, typename T_low>
+struct MixedPrecisionLinOp : public LinearOperator<T> {
+
+    const T_low* A_buff;
+    const int64_t lda;
+    const Layout buff_layout;
+    T A_fro_nrm;
+    std::vector<T_low> A_copy;
+    std::vector<T_low> B_low;
+    std::vector<T_low> C_low;
+
+    // References an A that is stored in T_low; it needs to outlive this object.
+    MixedPrecisionLinOp(
+        int64_t m,
+        int64_t n,
+        const T_low* A_buff,
+        int64_t lda,
+        Layout buff_layout
+    ) : LinearOperator<T>(m, n), A_buff(A_buff), lda(lda), buff_layout(buff_layout) {
+        randblas_require(lda >= ((buff_layout == Layout::ColMajor) ? m : n));
+        if (buff_layout == Layout::ColMajor)
+            this->A_fro_nrm = lapack::lange(Norm::Fro, m, n, A_buff, lda);
+        else
+            this->A_fro_nrm = lapack::lange(Norm::Fro, n, m, A_buff, lda);
+    };
+
+    // Keeps a T_low copy of an A that is stored in T, with the same layout and no padding.
+    // The Frobenius norm is taken from the original. A_buff is not referenced after the construction.
+    MixedPrecisionLinOp(
+        int64_t m,
+        int64_t n,
+        const T* A_buff,
+        int64_t lda,
+        Layout buff_layout
+    ) : LinearOperator<T>(m, n), A_buff(nullptr), lda((buff_layout == Layout::ColMajor) ? m : n), buff_layout(buff_layout) {
+        randblas_require(lda >= this->lda);
+        int64_t rows = this->lda;
+        int64_t cols = (buff_layout == Layout::ColMajor) ? n : m;
+        this->A_copy.resize(rows * cols);
+        for (int64_t j = 0; j < cols; ++j)
+            std::copy(&A_buff[lda * j], &A_buff[lda * j + rows], &this->A_copy[rows * j]);
+        this->A_buff    = this->A_copy.data();
+        this->A_fro_nrm = lapack::lange(Norm::Fro, rows, cols, A_buff, lda);
+    };
+
+    // A row-major A_buff is read as its transpose in a column-major format.
+    void operator()(
+        Op op,
+        int64_t n,
+        T alpha,
+        const T* B,
+        int64_t ldb,
+        T beta,
+        T* C,
+        int64_t ldc
+    ) {
+        int64_t rows_C = (op == Op::NoTrans) ? this->n_rows : this->n_cols;
+        int64_t rows_B = (op == Op::NoTrans) ? this->n_cols : this->n_rows;
+        randblas_require(ldb >= rows_B);
+        randblas_require(ldc >= rows_C);
+        T_low* B_l = util::upsize(rows_B * n, this->B_low);
+        T_low* C_l = util::upsize(rows_C * n, this->C_low);
+        for (int64_t j = 0; j < n; ++j)
+            std::copy(&B[ldb * j], &B[ldb * j + rows_B], &B_l[rows_B * j]);
+
+        Op blas_call_op = op;
+        if (this->buff_layout != Layout::ColMajor)
+            blas_call_op = (op == Op::NoTrans) ? Op::Trans : Op::NoTrans;
+        blas::gemm(
+            Layout::ColMajor, blas_call_op, Op::NoTrans, rows_C, n, rows_B, (T_low) 1.0,
+            this->A_buff, this->lda, B_l, rows_B, (T_low) 0.0, C_l, rows_C
+        );
+
+        // C = alpha * C_l + beta * C; C is not read if beta is zero.
+        for (int64_t j = 0; j < n; ++j) {
+            for (int64_t i = 0; i < rows_C; ++i) {
+                T c = alpha * (T) C_l[i + rows_C * j];
+                C[i + ldc * j] = (beta == (T) 0.0) ? c : c + beta * C[i + ldc * j];
+            }
+        }
+    };
+
+    T fro_nrm() {
+        return this->A_fro_nrm;
+    };
+};
+
 } // end namespace RandLAPACK
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "rl_blaspp.hh"
+#include "rl_lapackpp.hh"
+
+#include <cstdint>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define RandLAPACK_HAS_MMAP
+#endif
+
+namespace RandLAPACK {
+
+/// Provides access to an m-by-n matrix one block of rows at a time.
+/// Used by the algorithms that stream their input instead of holding it in memory.
+///
+/// The algorithms may read one panel while writing another from a different thread,
+/// so implementations must support concurrent calls on disjoint row ranges.
+template <typename T>
+struct RowPanelReader {
+
+    const int64_t m;
+    const int64_t n;
+
+    RowPanelReader(int64_t m, int64_t n) : m(m), n(n) {};
+
+    /// Copies rows [row_start, row_start + num_rows) of the matrix
+    /// into a column-major buffer with leading dimension ldb >= num_rows.
+    virtual void read(
+        int64_t row_start,
+        int64_t num_rows,
+        T* buf,
+        int64_t ldb
+    ) = 0;
+
+    /// Overwrites the leading num_cols columns of rows [row_start, row_start + num_rows)
+    /// with the contents of a column-major buffer. Read-only sources throw.
+    virtual void write(
+        int64_t /*row_start*/,
+        int64_t /*num_rows*/,
+        int64_t /*num_cols*/,
+        const T* /*buf*/,
+        int64_t /*ldb*/
+    ) {
+        throw std::runtime_error("This row panel source does not support writing.");
+    }
+
+    virtual ~RowPanelReader() {}
+};
+
+/// Row panels of a column-major matrix that resides in memory.
+template <typename T>
+struct DenseRowPanels : public RowPanelReader<T> {
+
+    T* A_buff;
+    const int64_t lda;
+
+    DenseRowPanels(
+        int64_t m,
+        int64_t n,
+        T* A_buff,
+        int64_t lda
+    ) : RowPanelReader<T>(m, n), A_buff(A_buff), lda(lda) {};
+
+    void read(
+        int64_t row_start,
+        int64_t num_rows,
+        T* buf,
+        int64_t ldb
+    ) override {
+        lapack::lacpy(MatrixType::General, num_rows, this->n, &A_buff[row_start], lda, buf, ldb);
+    }
+
+    void write(
+        int64_t row_start,
+        int64_t num_rows,
+        int64_t num_cols,
+        const T* buf,
+        int64_t ldb
+    ) override {
+        lapack::lacpy(MatrixType::General, num_rows, num_cols, buf, ldb, &A_buff[row_start], lda);
+    }
+};
+
+#if defined(RandLAPACK_HAS_MMAP)
+/// Row panels of an m-by-n matrix stored in a raw binary file of m * n values of type T,
+/// in either column-major or row-major order. The file is memory-mapped, so only the pages
+/// touched by the current panels need to be resident.
+template <typename T>
+struct MMapRowPanels : public RowPanelReader<T> {
+
+    const Layout file_layout;
+    int fd;
+    size_t map_bytes;
+    T* data;
+
+    MMapRowPanels(
+        const std::string &path,
+        int64_t m,
+        int64_t n,
+        Layout file_layout,
+        bool writable
+    ) : RowPanelReader<T>(m, n), file_layout(file_layout) {
+        map_bytes = (size_t) m * n * sizeof(T);
+        fd = open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Could not open " + path + ".");
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t) st.st_size < map_bytes) {
+            close(fd);
+            throw std::runtime_error(path + " is smaller than the requested matrix.");
+        }
+
+        void* addr = mmap(nullptr, map_bytes, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Could not map " + path + ".");
+        }
+        data = (T*) addr;
+        // Panels are visited from top to bottom.
+        if (file_layout == Layout::RowMajor)
+            madvise(addr, map_bytes, MADV_SEQUENTIAL);
+    }
+
+    MMapRowPanels(const MMapRowPanels &) = delete;
+    MMapRowPanels &operator=(const MMapRowPanels &) = delete;
+
+    ~MMapRowPanels() {
+        munmap((void*) data, map_bytes);
+        close(fd);
+    }
+
+    void read(
+        int64_t row_start,
+        int64_t num_rows,
+        T* buf,
+        int64_t ldb
+    ) override {
+        int64_t m = this->m;
+        int64_t n = this->n;
+        if (file_layout == Layout::ColMajor) {
+            lapack::lacpy(MatrixType::General, num_rows, n, &data[row_start], m, buf, ldb);
+        } else {
+            // Transposing copy, one panel row at a time.
+            for (int64_t i = 0; i < num_rows; ++i)
+                blas::copy(n, &data[(row_start + i) * n], 1, &buf[i], ldb);
+        }
+    }
+
+    void write(
+        int64_t row_start,
+        int64_t num_rows,
+        int64_t num_cols,
+        const T* buf,
+        int64_t ldb
+    ) override {
+        int64_t m = this->m;
+        int64_t n = this->n;
+        if (file_layout == Layout::ColMajor) {
+            lapack::lacpy(MatrixType::General, num_rows, num_cols, buf, ldb, &data[row_start], m);
+        } else {
+            for (int64_t i = 0; i < num_rows; ++i)
+                blas::copy(num_cols, &buf[i], ldb, &data[(row_start + i) * n], 1);
+        }
+    }
+};
+#endif
+
+} // end namespace RandLAPACK
@@ -0,0 +1,423 @@
+#pragma once
+
+#include "rl_blaspp.hh"
+#include "rl_lapackpp.hh"
+#include "rl_util.hh"
+
+#include <RandBLAS.hh>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace RandLAPACK {
+
+/// Non-owning view of an m-by-n sparse matrix in the compressed sparse row format.
+/// The zero-based column indices of the nonzeros in row i are colidxs[rowptr[i] : rowptr[i + 1]],
+/// and their values are stored at the same positions in vals.
+template <typename T>
+struct CSRMatrixView {
+
+    const int64_t n_rows;
+    const int64_t n_cols;
+    const int64_t* rowptr;
+    const int64_t* colidxs;
+    const T* vals;
+
+    CSRMatrixView(
+        int64_t n_rows,
+        int64_t n_cols,
+        const int64_t* rowptr,
+        const int64_t* colidxs,
+        const T* vals
+    ) : n_rows(n_rows), n_cols(n_cols), rowptr(rowptr), colidxs(colidxs), vals(vals) {};
+};
+
+/// Non-owning view of an m-by-n sparse matrix in the compressed sparse column format.
+/// The zero-based row indices of the nonzeros in column j are rowidxs[colptr[j] : colptr[j + 1]],
+/// and their values are stored at the same positions in vals.
+/// Row indices within each column must be sorted in increasing order.
+template <typename T>
+struct CSCMatrixView {
+
+    const int64_t n_rows;
+    const int64_t n_cols;
+    const int64_t* colptr;
+    const int64_t* rowidxs;
+    const T* vals;
+
+    CSCMatrixView(
+        int64_t n_rows,
+        int64_t n_cols,
+        const int64_t* colptr,
+        const int64_t* rowidxs,
+        const T* vals
+    ) : n_rows(n_rows), n_cols(n_cols), colptr(colptr), rowidxs(rowidxs), vals(vals) {};
+};
+
+namespace util {
+
+/// Number of columns of a sparse sketching operator generated at a time.
+inline constexpr int64_t sparse_sketch_block_cols = 4096;
+
+/// Generates the next 'cols' columns of a d-by-m sparse sign sketching operator.
+/// Each column has vec_nnz entries of +-1, placed in rows drawn uniformly with replacement;
+/// the entry (S_rows[i + vec_nnz * j], j) of the block has value S_vals[i + vec_nnz * j].
+/// Columns are independent, so generating S one block at a time gives the same operator
+/// regardless of the block size.
+template <typename T, typename RNG>
+RandBLAS::RNGState<RNG> sparse_sign_block(
+    int64_t d,
+    int64_t vec_nnz,
+    int64_t cols,
+    int64_t* S_rows,
+    T* S_vals,
+    const RandBLAS::RNGState<RNG> &state
+) {
+    RandBLAS::DenseDist D(vec_nnz, cols, RandBLAS::DenseDistName::Uniform);
+    auto next_state = RandBLAS::fill_dense(D, S_vals, state).second;
+    // A uniform value on (-1, 1) gives both the row and the sign of an entry.
+    for (int64_t i = 0; i < vec_nnz * cols; ++i) {
+        T u = S_vals[i];
+        S_rows[i] = std::min(d - 1, (int64_t) (std::abs(u) * d));
+        S_vals[i] = (u < 0) ? (T) -1.0 : (T) 1.0;
+    }
+    return next_state;
+}
+
+/// Computes A_hat = S * A, where A_hat is d-by-n and S is a d-by-m sparse sign sketching operator
+/// with vec_nnz nonzeros per column (see sparse_sign_block), in O(nnz(A) * vec_nnz) operations.
+/// Returns the RNG state following the one used to generate S.
+template <typename T, typename RNG>
+RandBLAS::RNGState<RNG> sparse_sign_sketch(
+    const CSRMatrixView<T> &A,
+    int64_t d,
+    int64_t vec_nnz,
+    T* A_hat,
+    const RandBLAS::RNGState<RNG> &state
+) {
+    int64_t m = A.n_rows;
+    int64_t b = std::min(m, sparse_sketch_block_cols);
+    std::vector<int64_t> S_rows(vec_nnz * b);
+    std::vector<T> S_vals(vec_nnz * b);
+    auto next_state = state;
+
+    std::fill(A_hat, &A_hat[d * A.n_cols], (T) 0.0);
+    for (int64_t row_start = 0; row_start < m; row_start += b) {
+        int64_t rows = std::min(b, m - row_start);
+        next_state = sparse_sign_block(d, vec_nnz, rows, S_rows.data(), S_vals.data(), next_state);
+        // Row i of A is scattered into the rows of A_hat selected by column i of S.
+        for (int64_t i = 0; i < rows; ++i) {
+            for (int64_t a = A.rowptr[row_start + i]; a < A.rowptr[row_start + i + 1]; ++a) {
+                T* A_hat_col = &A_hat[d * A.colidxs[a]];
+                for (int64_t p = 0; p < vec_nnz; ++p)
+                    A_hat_col[S_rows[p + vec_nnz * i]] += S_vals[p + vec_nnz * i] * A.vals[a];
+            }
+        }
+    }
+    return next_state;
+}
+
+/// Same as above, for a matrix in the CSC format. Columns of A_hat are computed in parallel.
+template <typename T, typename RNG>
+RandBLAS::RNGState<RNG> sparse_sign_sketch(
+    const CSCMatrixView<T> &A,
+    int64_t d,
+    int64_t vec_nnz,
+    T* A_hat,
+    const RandBLAS::RNGState<RNG> &state
+) {
+    int64_t m = A.n_rows;
+    int64_t n = A.n_cols;
+    int64_t b = std::min(m, sparse_sketch_block_cols);
+    std::vector<int64_t> S_rows(vec_nnz * b);
+    std::vector<T> S_vals(vec_nnz * b);
+    // Position of the first nonzero of every column that has not been processed yet.
+    std::vector<int64_t> cursors(A.colptr, &A.colptr[n]);
+    auto next_state = state;
+
+    std::fill(A_hat, &A_hat[d * n], (T) 0.0);
+    for (int64_t row_start = 0; row_start < m; row_start += b) {
+        int64_t rows = std::min(b, m - row_start);
+        next_state = sparse_sign_block(d, vec_nnz, rows, S_rows.data(), S_vals.data(), next_state);
+        #pragma omp parallel for schedule(dynamic, 16)
+        for (int64_t j = 0; j < n; ++j) {
+            int64_t a = cursors[j];
+            for (; a < A.colptr[j + 1] && A.rowidxs[a] < row_start + rows; ++a) {
+                int64_t i = A.rowidxs[a] - row_start;
+                for (int64_t p = 0; p < vec_nnz; ++p)
+                    A_hat[S_rows[p + vec_nnz * i] + d * j] += S_vals[p + vec_nnz * i] * A.vals[a];
+            }
+            cursors[j] = a;
+        }
+    }
+    return next_state;
+}
+
+/// Same as above, for a dense m-by-n matrix A, with the d-by-n A_hat stored with leading dimension ldah.
+/// The entries of A are converted to the precision of A_hat as they are read.
+/// S is generated b columns at a time into the caller's S_rows and S_vals, of vec_nnz * b entries each,
+/// so no allocations are made. Columns of A_hat are computed in parallel.
+template <typename T, typename T_A, typename RNG>
+RandBLAS::RNGState<RNG> sparse_sign_sketch(
+    int64_t m,
+    int64_t n,
+    const T_A* A,
+    int64_t lda,
+    int64_t d,
+    int64_t vec_nnz,
+    T* A_hat,
+    int64_t ldah,
+    int64_t b,
+    int64_t* S_rows,
+    T* S_vals,
+    const RandBLAS::RNGState<RNG> &state
+) {
+    auto next_state = state;
+
+    for (int64_t j = 0; j < n; ++j)
+        std::fill(&A_hat[ldah * j], &A_hat[ldah * j + d], (T) 0.0);
+    for (int64_t row_start = 0; row_start < m; row_start += b) {
+        int64_t rows = std::min(b, m - row_start);
+        next_state = sparse_sign_block(d, vec_nnz, rows, S_rows, S_vals, next_state);
+        // Row i of A is scattered into the rows of A_hat selected by column i of S.
+        #pragma omp parallel for schedule(static)
+        for (int64_t j = 0; j < n; ++j) {
+            const T_A* A_j = &A[row_start + lda * j];
+            T* A_hat_j     = &A_hat[ldah * j];
+            for (int64_t i = 0; i < rows; ++i) {
+                T a_ij = (T) A_j[i];
+                for (int64_t p = 0; p < vec_nnz; ++p)
+                    A_hat_j[S_rows[p + vec_nnz * i]] += S_vals[p + vec_nnz * i] * a_ij;
+            }
+        }
+    }
+    return next_state;
+}
+
+/// Copies rows [row_start, row_start + rows) of A[:, J[0:k]] into the dense rows-by-k panel P.
+/// J_inv is the inverse of the column permutation: column c of A is column J_inv[c] of A[:, J],
+/// and is skipped if J_inv[c] >= k.
+template <typename T>
+void sparse_row_panel(
+    const CSRMatrixView<T> &A,
+    int64_t row_start,
+    int64_t rows,
+    int64_t k,
+    const int64_t* J_inv,
+    T* P,
+    int64_t ldp
+) {
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int64_t i = 0; i < rows; ++i) {
+        for (int64_t j = 0; j < k; ++j)
+            P[i + ldp * j] = 0.0;
+        for (int64_t a = A.rowptr[row_start + i]; a < A.rowptr[row_start + i + 1]; ++a) {
+            int64_t j = J_inv[A.colidxs[a]];
+            if (j < k)
+                P[i + ldp * j] = A.vals[a];
+        }
+    }
+}
+
+/// Same as above, for a matrix in the CSC format. Here J holds the 1-based column pivots.
+/// The rows of every column that fall into the panel are found by a binary search.
+template <typename T>
+void sparse_row_panel(
+    const CSCMatrixView<T> &A,
+    int64_t row_start,
+    int64_t rows,
+    int64_t k,
+    const int64_t* J,
+    T* P,
+    int64_t ldp
+) {
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (int64_t j = 0; j < k; ++j) {
+        int64_t col = J[j] - 1;
+        std::fill(&P[ldp * j], &P[ldp * j + rows], (T) 0.0);
+        const int64_t* begin = &A.rowidxs[A.colptr[col]];
+        const int64_t* end   = &A.rowidxs[A.colptr[col + 1]];
+        for (const int64_t* r = std::lower_bound(begin, end, row_start); r < end && *r < row_start + rows; ++r)
+            P[*r - row_start + ldp * j] = A.vals[r - A.rowidxs];
+    }
+}
+
+/// Computes C = alpha * op(A) * B + beta * C, where B and C have c columns.
+/// For op = NoTrans, B is n-by-c and C is m-by-c; for op = Trans, B is m-by-c and C is n-by-c.
+/// If beta is zero, C need not be initialized.
+template <typename T>
+void sparse_mult(
+    Op op,
+    const CSRMatrixView<T> &A,
+    int64_t c,
+    T alpha,
+    const T* B,
+    int64_t ldb,
+    T beta,
+    T* C,
+    int64_t ldc
+) {
+    if (op == Op::NoTrans) {
+        #pragma omp parallel for schedule(dynamic, 256)
+        for (int64_t i = 0; i < A.n_rows; ++i) {
+            for (int64_t l = 0; l < c; ++l) {
+                T dot = 0.0;
+                for (int64_t a = A.rowptr[i]; a < A.rowptr[i + 1]; ++a)
+                    dot += A.vals[a] * B[A.colidxs[a] + ldb * l];
+                C[i + ldc * l] = (beta == (T) 0.0) ? alpha * dot : alpha * dot + beta * C[i + ldc * l];
+            }
+        }
+    } else {
+        #pragma omp parallel for
+        for (int64_t l = 0; l < c; ++l) {
+            if (beta == (T) 0.0) {
+                std::fill(&C[ldc * l], &C[ldc * l + A.n_cols], (T) 0.0);
+            } else {
+                blas::scal(A.n_cols, beta, &C[ldc * l], 1);
+            }
+            for (int64_t i = 0; i < A.n_rows; ++i) {
+                T b_il = alpha * B[i + ldb * l];
+                for (int64_t a = A.rowptr[i]; a < A.rowptr[i + 1]; ++a)
+                    C[A.colidxs[a] + ldc * l] += A.vals[a] * b_il;
+            }
+        }
+    }
+}
+
+/// Same as above, for a matrix in the CSC format.
+template <typename T>
+void sparse_mult(
+    Op op,
+    const CSCMatrixView<T> &A,
+    int64_t c,
+    T alpha,
+    const T* B,
+    int64_t ldb,
+    T beta,
+    T* C,
+    int64_t ldc
+) {
+    if (op == Op::NoTrans) {
+        #pragma omp parallel for
+        for (int64_t l = 0; l < c; ++l) {
+            if (beta == (T) 0.0) {
+                std::fill(&C[ldc * l], &C[ldc * l + A.n_rows], (T) 0.0);
+            } else {
+                blas::scal(A.n_rows, beta, &C[ldc * l], 1);
+            }
+            for (int64_t j = 0; j < A.n_cols; ++j) {
+                T b_jl = alpha * B[j + ldb * l];
+                for (int64_t a = A.colptr[j]; a < A.colptr[j + 1]; ++a)
+                    C[A.rowidxs[a] + ldc * l] += A.vals[a] * b_jl;
+            }
+        }
+    } else {
+        #pragma omp parallel for schedule(dynamic, 16)
+        for (int64_t j = 0; j < A.n_cols; ++j) {
+            for (int64_t l = 0; l < c; ++l) {
+                T dot = 0.0;
+                for (int64_t a = A.colptr[j]; a < A.colptr[j + 1]; ++a)
+                    dot += A.vals[a] * B[A.rowidxs[a] + ldb * l];
+                C[j + ldc * l] = (beta == (T) 0.0) ? alpha * dot : alpha * dot + beta * C[j + ldc * l];
+            }
+        }
+    }
+}
+
+/// Frobenius norm of a sparse matrix.
+template <typename T>
+T sparse_fro_nrm(const CSRMatrixView<T> &A) {
+    return blas::nrm2(A.rowptr[A.n_rows], A.vals, 1);
+}
+
+template <typename T>
+T sparse_fro_nrm(const CSCMatrixView<T> &A) {
+    return blas::nrm2(A.colptr[A.n_cols], A.vals, 1);
+}
+
+/// Column permutation argument expected by the sparse kernels above:
+/// the inverse permutation for CSR, and the pivots themselves for CSC.
+template <typename T>
+const int64_t* sparse_perm_arg(const CSRMatrixView<T> &, const int64_t*, const int64_t* J_inv) {
+    return J_inv;
+}
+
+template <typename T>
+const int64_t* sparse_perm_arg(const CSCMatrixView<T> &, const int64_t* J, const int64_t*) {
+    return J;
+}
+
+} // end namespace util
+
+/// The m-by-k orthonormal factor Q = A[:, J[0:k]] * inv(R_sp) * inv(R_chol) of a QR factorization
+/// of a sparse matrix A, as computed by the sparse-input CQRRPT; R_sp is the preconditioner from the sketch
+/// and R_chol is the Cholesky factor of the Gram matrix of A[:, J[0:k]] * inv(R_sp).
+/// Q is applied through A, J, R_sp and R_chol, without ever being formed. The preconditioning is done
+/// one dense row panel of A[:, J[0:k]] at a time, exactly as in the factorization, so that Q stays
+/// orthonormal to working precision regardless of cond(A).
+/// A, J, R_sp and R_chol are referenced, not copied, and need to outlive this object.
+template <typename T, typename SpMat>
+struct SparseImplicitQ {
+
+    const SpMat &A;
+    const int64_t k;
+    const int64_t* J;
+    const T* R_sp;
+    const T* R_chol;
+    const int64_t ldr;
+    // Inverse of the column permutation, J_inv[J[j] - 1] = j.
+    std::vector<int64_t> J_inv;
+    // Number of rows in a dense panel of A[:, J[0:k]].
+    int64_t panel_rows;
+
+    SparseImplicitQ(
+        const SpMat &A,
+        int64_t k,
+        const int64_t* J,
+        const T* R_sp,
+        const T* R_chol,
+        int64_t ldr
+    ) : A(A), k(k), J(J), R_sp(R_sp), R_chol(R_chol), ldr(ldr), J_inv(A.n_cols) {
+        for (int64_t j = 0; j < A.n_cols; ++j)
+            J_inv[J[j] - 1] = j;
+        panel_rows = std::min(A.n_rows, util::cache_panel_rows<T>(k));
+    };
+
+    /// Computes C = op(Q) * B, where B has c columns.
+    /// For op = NoTrans, B is k-by-c and C is m-by-c; for op = Trans, B is m-by-c and C is k-by-c.
+    void apply(
+        Op op,
+        int64_t c,
+        const T* B,
+        int64_t ldb,
+        T* C,
+        int64_t ldc
+    ) {
+        int64_t m = A.n_rows;
+        int64_t b = panel_rows;
+        const int64_t* perm = util::sparse_perm_arg(A, J, J_inv.data());
+        std::vector<T> P(b * k);
+        if (op == Op::NoTrans) {
+            std::vector<T> W(k * c);
+            lapack::lacpy(MatrixType::General, k, c, B, ldb, W.data(), k);
+            blas::trsm(Layout::ColMajor, Side::Left, Uplo::Upper, Op::NoTrans, Diag::NonUnit, k, c, (T) 1.0, R_chol, ldr, W.data(), k);
+            for (int64_t row_start = 0; row_start < m; row_start += b) {
+                int64_t rows = std::min(b, m - row_start);
+                util::sparse_row_panel(A, row_start, rows, k, perm, P.data(), b);
+                blas::trsm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, rows, k, (T) 1.0, R_sp, ldr, P.data(), b);
+                blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, rows, c, k, (T) 1.0, P.data(), b, W.data(), k, (T) 0.0, &C[row_start], ldc);
+            }
+        } else {
+            for (int64_t row_start = 0; row_start < m; row_start += b) {
+                int64_t rows = std::min(b, m - row_start);
+                util::sparse_row_panel(A, row_start, rows, k, perm, P.data(), b);
+                blas::trsm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, rows, k, (T) 1.0, R_sp, ldr, P.data(), b);
+                blas::gemm(Layout::ColMajor, Op::Trans, Op::NoTrans, k, c, rows, (T) 1.0, P.data(), b, &B[row_start], ldb, (T) (row_start > 0), C, ldc);
+            }
+            blas::trsm(Layout::ColMajor, Side::Left, Uplo::Upper, Op::Trans, Diag::NonUnit, k, c, (T) 1.0, R_chol, ldr, C, ldc);
+        }
+    }
+};
+
+} // end namespace RandLAPACK
@@ -7,8 +7,17 @@
 #include <iostream>
 #include <cmath>
 #include <algorithm>
+#include <numeric>
 #include <vector>
 #include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
 
 namespace RandLAPACK::util {
 
@@ -114,8 +123,58 @@ void get_U(
     }
 }
 
+/// Turns the pivot vector idx of length k into a full permutation of n columns, stored in perm.
+/// On exit, the column that is to be placed at position i is found at position perm[i], decoded as
+/// (perm[i] < 0 ? ~perm[i] : perm[i]). Exactly one entry per cycle (its leader) is stored as is;
+/// the other entries of the cycle are stored bitwise-negated.
+///
+/// The leading k positions receive the columns idx[0] - 1, ..., idx[k - 1] - 1; the columns that these
+/// displace fill the vacated trailing positions in the same order that sequential pairwise swapping would give.
+/// Runs in O(n) time; idx and perm must not alias.
+inline void col_perm_cycles(
+    int64_t n,
+    int64_t k,
+    const int64_t* idx,
+    int64_t* perm
+) {
+    int64_t i, p, q;
+    for (i = 0; i < k; ++i)
+        perm[i] = idx[i] - 1;
+    for (i = k; i < n; ++i)
+        perm[i] = i;
+
+    // Mark leading positions that some pivot pulls from.
+    for (i = 0; i < k; ++i)
+        if (idx[i] - 1 < k)
+            perm[idx[i] - 1] = ~perm[idx[i] - 1];
+
+    // Unmarked leading positions start chains that end in a vacated trailing position;
+    // the displaced column goes there.
+    for (i = 0; i < k; ++i) {
+        if (perm[i] < 0)
+            continue;
+        for (p = i; p < k; p = (perm[p] < 0) ? ~perm[p] : perm[p]);
+        perm[p] = i;
+    }
+    for (i = 0; i < k; ++i)
+        if (perm[i] < 0)
+            perm[i] = ~perm[i];
+
+    // Mark every non-leader element of each cycle.
+    for (i = 0; i < n; ++i) {
+        if (perm[i] < 0)
+            continue;
+        for (q = perm[i]; q != i; q = ~perm[q])
+            perm[q] = ~perm[q];
+    }
+}
+
 /// Positions columns of A in accordance with idx vector of length k.
-/// idx array modified ONLY within the scope of this function.
+/// idx is left unmodified; idx_work (of length n, may not alias idx) is used as scratch.
+///
+/// The permutation is split into cycles once, then applied in place.
+/// Columns are moved in tiles of rows small enough to stay in L1 cache, and the tiles are
+/// processed in parallel.
 template <typename T>
 void col_swap(
     int64_t m,
@@ -123,48 +182,87 @@ void col_swap(
     int64_t k,
     T* A,
     int64_t lda,
-    std::vector<int64_t> idx
+    const int64_t* idx,
+    int64_t* idx_work
 ) {
     if(k > n) 
         throw std::runtime_error("Invalid rank parameter.");
 
-    int64_t i, j; //, l;
-    for (i = 0, j = 0; i < k; ++i) {
-        j = idx[i] - 1;
-        blas::swap(m, &A[i * lda], 1, &A[j * lda], 1);
-
-        // swap idx array elements
-        // Find idx element with value i and assign it to j
-        auto it = std::find(idx.begin() + i, idx.begin() + k, i + 1);
-        idx[it - (idx.begin())] = j + 1;
+    col_perm_cycles(n, k, idx, idx_work);
+
+    const int64_t tile_rows = std::max((int64_t) (4096 / sizeof(T)), (int64_t) 1);
+    const int64_t num_tiles = (m + tile_rows - 1) / tile_rows;
+
+    #pragma omp parallel for schedule(static)
+    for (int64_t t = 0; t < num_tiles; ++t) {
+        T tile[4096 / sizeof(T) + 1];
+        int64_t r0   = t * tile_rows;
+        int64_t rows = std::min(tile_rows, m - r0);
+        int64_t q, src;
+        for (int64_t i = 0; i < n; ++i) {
+            // Only cycle leaders that are not fixed points start a traversal.
+            if (idx_work[i] < 0 || idx_work[i] == i)
+                continue;
+            std::copy(&A[r0 + i * lda], &A[r0 + i * lda + rows], tile);
+            for (q = i, src = idx_work[i]; src != i; q = src, src = ~idx_work[src])
+                std::copy(&A[r0 + src * lda], &A[r0 + src * lda + rows], &A[r0 + q * lda]);
+            std::copy(tile, &tile[rows], &A[r0 + q * lda]);
+        }
     }
 }
 
-/// A version of the above function to be used on a vector of integers
+/// Positions columns of A in accordance with idx vector of length k.
+template <typename T>
+void col_swap(
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    T* A,
+    int64_t lda,
+    const std::vector<int64_t> &idx
+) {
+    std::vector<int64_t> idx_work(n);
+    col_swap(m, n, k, A, lda, idx.data(), idx_work.data());
+}
+
+/// A version of the above function to be used on a vector of integers.
+/// idx_work is of length n and may not alias idx.
 template <typename T>
 void col_swap(
     int64_t n,
     int64_t k,
     int64_t* A,
-    std::vector<int64_t> idx
+    const int64_t* idx,
+    int64_t* idx_work
 ) {
     if(k > n) 
         throw std::runtime_error("Incorrect rank parameter.");
 
-    int64_t* idx_dat = idx.data();
+    col_perm_cycles(n, k, idx, idx_work);
 
-    int64_t i, j;
-    for (i = 0, j = 0; i < k; ++i) {
-        j = idx_dat[i] - 1;
-        std::swap(A[i], A[j]);
-
-        // swap idx array elements
-        // Find idx element with value i and assign it to j
-        auto it = std::find(idx.begin() + i, idx.begin() + k, i + 1);
-        idx[it - (idx.begin())] = j + 1;
+    int64_t i, q, src, tmp;
+    for (i = 0; i < n; ++i) {
+        if (idx_work[i] < 0 || idx_work[i] == i)
+            continue;
+        tmp = A[i];
+        for (q = i, src = idx_work[i]; src != i; q = src, src = ~idx_work[src])
+            A[q] = A[src];
+        A[q] = tmp;
     }
 }
 
+/// A version of the above function to be used on a vector of integers
+template <typename T>
+void col_swap(
+    int64_t n,
+    int64_t k,
+    int64_t* A,
+    const std::vector<int64_t> &idx
+) {
+    std::vector<int64_t> idx_work(n);
+    col_swap<T>(n, k, A, idx.data(), idx_work.data());
+}
+
 /// Checks if the given size is larger than available. 
 /// If so, resizes the vector.
 template <typename T>
@@ -178,6 +276,206 @@ T* upsize(
     return A.data();
 }
 
+/// Alignment (in bytes) of every buffer placed into a caller-supplied workspace.
+inline constexpr int64_t workspace_alignment = 64;
+
+/// Number of bytes that a buffer of n entries of type T occupies inside a workspace.
+/// The size is rounded up so that the buffer that follows it stays aligned.
+template <typename T>
+int64_t workspace_bytes(
+    int64_t n
+) {
+    int64_t bytes = std::max(n, (int64_t) 0) * (int64_t) sizeof(T);
+    return ((bytes + workspace_alignment - 1) / workspace_alignment) * workspace_alignment;
+}
+
+/// Allocates a workspace of a given size (as reported by a driver's workspace_query()).
+/// The returned memory is aligned to workspace_alignment and must be released with free().
+inline void* workspace_alloc(
+    int64_t bytes
+) {
+    bytes = std::max(bytes, workspace_alignment);
+    bytes = ((bytes + workspace_alignment - 1) / workspace_alignment) * workspace_alignment;
+    void* work = std::aligned_alloc(workspace_alignment, bytes);
+    if (work == nullptr)
+        throw std::bad_alloc();
+    return work;
+}
+
+/// Hands out consecutive buffers from a caller-owned, 64-byte-aligned block of memory.
+/// Drivers use this in their workspace-taking call() overloads in place of calloc/free,
+/// so that repeated calls on same-sized problems perform no heap allocations.
+/// Buffers are never released individually; the arena is simply discarded when the call returns.
+class Workspace {
+    public:
+        Workspace(
+            void* work,
+            int64_t work_bytes
+        ) {
+            if (work_bytes > 0 && work == nullptr)
+                throw std::runtime_error("Workspace pointer is null.");
+            if (reinterpret_cast<std::uintptr_t>(work) % workspace_alignment != 0)
+                throw std::runtime_error("Workspace is not 64-byte aligned.");
+            base = (char*) work;
+            capacity = work_bytes;
+            used = 0;
+        }
+
+        /// Returns a buffer of n entries of type T.
+        /// If zero is set, the buffer is zero-initialized (matching the calloc it replaces).
+        template <typename T>
+        T* take(
+            int64_t n,
+            bool zero = false
+        ) {
+            int64_t bytes = workspace_bytes<T>(n);
+            if (used + bytes > capacity)
+                throw std::runtime_error("Workspace is too small, see workspace_query().");
+            T* buf = (T*) &base[used];
+            used += bytes;
+            if (zero)
+                std::fill(buf, &buf[n], (T) 0);
+            return buf;
+        }
+
+    public:
+        char* base;
+        int64_t capacity;
+        int64_t used;
+};
+
+/// Number of threads that an OpenMP parallel region would use (1 without OpenMP).
+inline int64_t max_threads() {
+    #if defined(_OPENMP)
+    return omp_get_max_threads();
+    #else
+    return 1;
+    #endif
+}
+
+/// Number of rows in a panel with k columns that takes up about 256 KiB, i.e.
+/// stays in cache between consecutive operations on it (at least 64 rows).
+template <typename T>
+int64_t cache_panel_rows(
+    int64_t k
+) {
+    return std::max((int64_t) 64, (int64_t) (262144 / (std::max(k, (int64_t) 1) * sizeof(T))));
+}
+
+/// Copies an m-by-n matrix A (or its upper triangle) into B, converting the entries
+/// from T_in to T_out. Same as lapack::lacpy if the types coincide.
+template <typename T_in, typename T_out>
+void lacpy_convert(
+    MatrixType type,
+    int64_t m,
+    int64_t n,
+    const T_in* A,
+    int64_t lda,
+    T_out* B,
+    int64_t ldb
+) {
+    if constexpr (std::is_same_v<T_in, T_out>) {
+        lapack::lacpy(type, m, n, A, lda, B, ldb);
+    } else {
+        for (int64_t j = 0; j < n; ++j) {
+            int64_t rows = (type == MatrixType::Upper) ? std::min(j + 1, m) : m;
+            for (int64_t i = 0; i < rows; ++i)
+                B[i + j * ldb] = (T_out) A[i + j * lda];
+        }
+    }
+}
+
+/// Generates columns [col_start, col_start + cols) of the d-by-m Gaussian matrix that
+///     RandBLAS::fill_dense(RandBLAS::DenseDist(d, m), S, state)
+/// writes into S, with S read as a column-major matrix, without generating the rest of it.
+/// The result is bit-identical, since RandBLAS's counter-based generator determines every entry
+/// by its position in the buffer alone; this tile is the contiguous slice [d * col_start, d * (col_start + cols)).
+///
+/// Returns the state that follows the tile. For the tile that ends at column m, this is the same state
+/// as the one returned by filling all of S.
+template <typename T, typename RNG>
+RandBLAS::RNGState<RNG> fill_dense_cols(
+    int64_t d,
+    int64_t m,
+    int64_t col_start,
+    int64_t cols,
+    T* S_tile,
+    const RandBLAS::RNGState<RNG> &state
+) {
+    RandBLAS::DenseDist D(d * m, 1);
+    return RandBLAS::fill_dense(D, d * cols, 1, d * col_start, 0, S_tile, state).second;
+}
+
+/// Fused preconditioning and Gram matrix kernel. Computes
+///     A := A * inv(R),
+///     G := A' * A (upper triangle only),
+/// where A is m-by-k and R is k-by-k upper-triangular, reading A from memory only once
+/// (as opposed to three passes for a separate trsm and syrk).
+///
+/// A is processed in panels of panel_rows rows. Each thread applies inv(R) to a panel and
+/// immediately adds its contribution to a private k-by-k partial Gram matrix, while the panel
+/// is still in cache. The partial Gram matrices are summed up at the end.
+///
+/// @param[in] num_partials
+///     Number of partial Gram matrices that fit into G_work; also bounds the number of threads used.
+///
+/// @param[in] G_work
+///     Buffer of size num_partials * k * k.
+///
+/// G may coincide with R, since it is only written after all panels have been processed.
+template <typename T>
+void trsm_gram(
+    int64_t m,
+    int64_t k,
+    const T* R,
+    int64_t ldr,
+    T* A,
+    int64_t lda,
+    T* G,
+    int64_t ldg,
+    int64_t panel_rows,
+    int64_t num_partials,
+    T* G_work
+) {
+    int64_t num_panels = (m + panel_rows - 1) / panel_rows;
+    num_partials = std::max((int64_t) 1, std::min(num_partials, num_panels));
+    // The team may have fewer threads than requested, in which case some of
+    // the partial Gram matrices are never touched, yet they are all summed up below.
+    std::fill(G_work, &G_work[num_partials * k * k], (T) 0.0);
+
+    #pragma omp parallel num_threads(num_partials)
+    {
+        #if defined(_OPENMP)
+        int64_t t = omp_get_thread_num();
+        // Panels are already distributed over the team, so BLAS runs on one thread per panel.
+        omp_set_num_threads(1);
+        #else
+        int64_t t = 0;
+        #endif
+        T* G_t = &G_work[t * k * k];
+
+        #pragma omp for schedule(static)
+        for (int64_t p = 0; p < num_panels; ++p) {
+            int64_t row_start = p * panel_rows;
+            int64_t rows      = std::min(panel_rows, m - row_start);
+            T* A_p = &A[row_start];
+            blas::trsm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, rows, k, (T) 1.0, R, ldr, A_p, lda);
+            blas::syrk(Layout::ColMajor, Uplo::Upper, Op::Trans, k, rows, (T) 1.0, A_p, lda, (T) 1.0, G_t, k);
+        }
+    }
+
+    // Reduce the upper triangles of the partial Gram matrices.
+    #pragma omp parallel for schedule(static)
+    for (int64_t j = 0; j < k; ++j) {
+        for (int64_t i = 0; i <= j; ++i) {
+            T sum = G_work[i + j * k];
+            for (int64_t t = 1; t < num_partials; ++t)
+                sum += G_work[t * k * k + i + j * k];
+            G[i + j * ldg] = sum;
+        }
+    }
+}
+
 /// Find the condition number of a given matrix A.
 template <typename T>
 T cond_num_check(
@@ -287,6 +585,77 @@ T estimate_spectral_norm(
     return std::sqrt(blas::nrm2(n, buf.data(), 1));
 }
 
+/// Estimates the l2 condition number of a preconditioned matrix A * inv(R), where A is m-by-k
+/// and R is k-by-k upper-triangular, without forming the product.
+/// Does so with p steps of the Lanczos process (with full reorthogonalization) on inv(R)' * A' * A * inv(R),
+/// taking the ratio of the extreme eigenvalues of the resulting tridiagonal matrix.
+/// The Ritz values approach the spectrum from the inside, so the estimate is a lower bound,
+/// which becomes exact for p = k.
+///
+/// The work buffer has to hold at least m + (p + 2) * (k + 3) entries.
+template <typename T, typename RNG>
+T estimate_precond_cond(
+    int64_t m,
+    int64_t k,
+    const T* A,
+    int64_t lda,
+    const T* R,
+    int64_t ldr,
+    int64_t p,
+    RandBLAS::RNGState<RNG>& state,
+    T* work
+) {
+    p = std::min(p, k);
+    if(p <= 0)
+        return 1.0;
+
+    // Lanczos vectors are stored in V, the tridiagonal matrix in (alpha, beta).
+    T* z     = work;
+    T* V     = &z[m];
+    T* w     = &V[k * (p + 1)];
+    T* coef  = &w[k];
+    T* alpha = &coef[p + 1];
+    T* beta  = &alpha[p];
+
+    RandBLAS::DenseDist DV(k, 1);
+    state = RandBLAS::fill_dense(DV, V, state).second;
+    blas::scal(k, 1 / blas::nrm2(k, V, 1), V, 1);
+
+    int64_t steps = 0;
+    while(steps < p) {
+        T* v = &V[k * steps];
+        // w = inv(R)' * A' * A * inv(R) * v
+        blas::copy(k, v, 1, w, 1);
+        blas::trsv(Layout::ColMajor, Uplo::Upper, Op::NoTrans, Diag::NonUnit, k, R, ldr, w, 1);
+        blas::gemv(Layout::ColMajor, Op::NoTrans, m, k, (T) 1.0, A, lda, w, 1, (T) 0.0, z, 1);
+        blas::gemv(Layout::ColMajor, Op::Trans, m, k, (T) 1.0, A, lda, z, 1, (T) 0.0, w, 1);
+        blas::trsv(Layout::ColMajor, Uplo::Upper, Op::Trans, Diag::NonUnit, k, R, ldr, w, 1);
+
+        alpha[steps] = blas::dot(k, v, 1, w, 1);
+        // Orthogonalizing against all previous vectors, twice.
+        for(int pass = 0; pass < 2; ++pass) {
+            blas::gemv(Layout::ColMajor, Op::Trans, k, steps + 1, (T) 1.0, V, k, w, 1, (T) 0.0, coef, 1);
+            blas::gemv(Layout::ColMajor, Op::NoTrans, k, steps + 1, (T) -1.0, V, k, coef, 1, (T) 1.0, w, 1);
+        }
+        ++steps;
+        if(steps == p)
+            break;
+
+        beta[steps - 1] = blas::nrm2(k, w, 1);
+        // An invariant subspace has been found.
+        if(beta[steps - 1] <= std::numeric_limits<T>::epsilon() * std::abs(alpha[0]))
+            break;
+        blas::copy(k, w, 1, &V[k * steps], 1);
+        blas::scal(k, 1 / beta[steps - 1], &V[k * steps], 1);
+    }
+
+    // Eigenvalues of the tridiagonal matrix, in ascending order.
+    lapack::sterf(steps, alpha, beta);
+    if(alpha[0] <= 0)
+        return std::numeric_limits<T>::infinity();
+    return std::sqrt(alpha[steps - 1] / alpha[0]);
+}
+
 /// Uses recursion to find the rank of the matrix pointed to by A_dat.
 /// Does so by attempting to find the smallest k such that 
 /// ||A[k:, k:]||_F <= tau_trunk * ||A||.
@@ -410,6 +779,54 @@ void transposition(
     }
 }
 
+/// Pivoted LU factorization of an m-by-n matrix A with column pivots,
+///     A[:, J] = L * U,
+/// where L is m-by-k lower-triangular and U is k-by-n unit upper-triangular, with k = min(m, n).
+/// Makes the same pivoting decisions as a row-pivoted lapack::getrf on A', but works on A directly,
+/// so no transposed copy of A is needed. On exit, L and U (without its unit diagonal) overwrite A.
+///
+/// J, of length n, receives the column permutation in the format used by geqp3 (1-based column indices).
+///
+/// Rows are factored nb at a time. Within a block of rows, the pivot is the largest entry of the
+/// current row, and whole columns are swapped, so the rows below the block are permuted along.
+/// The rows below the block are then updated with a trsm and a gemm.
+template <typename T>
+void getrf_col_piv(
+    int64_t m,
+    int64_t n,
+    T* A,
+    int64_t lda,
+    int64_t* J,
+    int64_t nb = 64
+) {
+    int64_t k = std::min(m, n);
+    std::iota(J, &J[n], 1);
+
+    for(int64_t r0 = 0; r0 < k; r0 += nb) {
+        int64_t r1 = std::min(r0 + nb, k);
+        for(int64_t i = r0; i < r1; ++i) {
+            int64_t p = i + blas::iamax(n - i, &A[i + lda * i], lda);
+            if(p != i) {
+                blas::swap(m, &A[lda * i], 1, &A[lda * p], 1);
+                std::swap(J[i], J[p]);
+            }
+            // A zero pivot means the rest of the row is zero, nothing to scale.
+            if(A[i + lda * i] != (T) 0.0)
+                blas::scal(n - i - 1, (T) 1.0 / A[i + lda * i], &A[i + lda * (i + 1)], lda);
+            // Rank-1 update of the remaining rows of the block.
+            if(i + 1 < r1)
+                blas::ger(Layout::ColMajor, r1 - i - 1, n - i - 1, (T) -1.0, &A[(i + 1) + lda * i], 1, &A[i + lda * (i + 1)], lda, &A[(i + 1) + lda * (i + 1)], lda);
+        }
+        if(r1 < m) {
+            // L21 = A21 * inv(U11)
+            blas::trsm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::Unit, m - r1, r1 - r0, (T) 1.0, &A[r0 + lda * r0], lda, &A[r1 + lda * r0], lda);
+            // A22 = A22 - L21 * U12
+            if(r1 < n)
+                blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, m - r1, n - r1, r1 - r0, (T) -1.0, &A[r1 + lda * r0], lda, &A[r0 + lda * r1], lda, (T) 1.0, &A[r1 + lda * r1], lda);
+        }
+    }
+}
+
 // Custom implementation of orhr_col.
 // Allows to choose whether to output T or tau.
 template <typename T>
@@ -4,6 +4,8 @@ int main() {return 0;}
 /*
 This benchmarks compares single-precision ICQRRP with double-precision GETRF and GEQRF.
 We anticipate that single-precision ICQRRP can be used as part of the linear system solving process.
+Also included is the mixed-precision ICQRRP, which keeps the sketch and its QRCP in single precision
+and the rest of the algorithm in double precision.
 */
 #include "RandLAPACK.hh"
 #include "rl_blaspp.hh"
@@ -67,11 +69,15 @@ static std::vector<long> call_all_algs(
 
     // Additional params setup.
     RandLAPACK::CQRRP_blocked<float, r123::Philox4x32> CQRRP_blocked(false, tol, b_sz);
+    RandLAPACK::CQRRP_blocked<double, r123::Philox4x32> CQRRP_blocked_mixed(false, (double) tol, b_sz);
+    CQRRP_blocked_mixed.use_mixed_precision = true;
     // We are nbot using panel pivoting in performance testing.
     // timing vars
     long dur_cqrrp    = 0;
     long dur_geqrf    = 0;
     long dur_getrf    = 0;
+    long dur_cqrrp_mixed    = 0;
+    long t_cqrrp_mixed_best = 0;
     long t_cqrrp_best = 0;
     long t_geqrf_best = 0;
     long t_getrf_best = 0;
@@ -120,9 +126,23 @@ static std::vector<long> call_all_algs(
         data_regen(m_info_cqrrp, all_data_cqrrp, state_gen, 1);
         state_gen = state;
         state_alg = state;
+
+        // Testing CQRRP - mixed precision
+        auto start_cqrrp_mixed = high_resolution_clock::now();
+        CQRRP_blocked_mixed.call(m, n, all_data_rest.A.data(), m, (double) d_factor, all_data_rest.tau.data(), all_data_rest.J.data(), state_alg);
+        auto stop_cqrrp_mixed = high_resolution_clock::now();
+        dur_cqrrp_mixed = duration_cast<microseconds>(stop_cqrrp_mixed - start_cqrrp_mixed).count();
+        printf("TOTAL TIME FOR MIXED-PRECISION CQRRP %ld\n", dur_cqrrp_mixed);
+        // Update best timing
+        i == 0 ? t_cqrrp_mixed_best = dur_cqrrp_mixed : (dur_cqrrp_mixed < t_cqrrp_mixed_best) ? t_cqrrp_mixed_best = dur_cqrrp_mixed : NULL;
+
+        // Clear and re-generate data
+        data_regen(m_info_rest, all_data_rest, state_gen, 0);
+        state_gen = state;
+        state_alg = state;
     }
 
-    std::vector<long> res{t_cqrrp_best, t_geqrf_best, t_getrf_best};
+    std::vector<long> res{t_cqrrp_best, t_geqrf_best, t_getrf_best, t_cqrrp_mixed_best};
 
     return res;
 }
@@ -164,7 +184,7 @@ int main() {
                                     + ".dat", std::fstream::app);
     for (;b_sz_start <= b_sz_end; b_sz_start *= 2) {
         res = call_all_algs(m_info_f, m_info_d, numruns, b_sz_start, all_data_f, all_data_d, state_constant);
-        file << res[0]  << ",  " << res[1]  << ",  " << res[2] << ",\n";
+        file << res[0]  << ",  " << res[1]  << ",  " << res[2] << ",  " << res[3] << ",\n";
     }
 }
 #endif
@@ -0,0 +1,103 @@
+/*
+HQRRP column norm benchmark - runs:
+    1. Column norms through a loop of nrm2 calls (the former implementation)
+    2. NoFLA_QRP_compute_norms, single-threaded
+    3. NoFLA_QRP_compute_norms, multithreaded
+    4. NoFLA_QRP_downdate_partial_norms, single-threaded
+    5. NoFLA_QRP_downdate_partial_norms, multithreaded
+for a matrix with a fixed number of rows and a varying number of columns (panel width).
+Records the best time over numruns for every kernel, saves them into a file.
+*/
+
+#include "RandLAPACK.hh"
+#include "rl_blaspp.hh"
+#include "rl_lapackpp.hh"
+#include "rl_gen.hh"
+
+#include <RandBLAS.hh>
+#include <fstream>
+#include <functional>
+
+static long time_min(
+    int64_t numruns,
+    std::function<void()> kernel) {
+
+    long dur_min = std::numeric_limits<long>::max();
+    for (int i = 0; i < numruns; ++i) {
+        auto start = high_resolution_clock::now();
+        kernel();
+        auto stop  = high_resolution_clock::now();
+        dur_min = std::min(dur_min, (long) duration_cast<nanoseconds>(stop - start).count());
+    }
+    return dur_min;
+}
+
+template <typename T, typename RNG>
+static void call_all_algs(
+    int64_t numruns,
+    int64_t m,
+    int64_t n,
+    RandBLAS::RNGState<RNG> &state,
+    std::string output_filename) {
+
+    std::vector<T> A(m * n, 0.0);
+    std::vector<T> d(n, 0.0);
+    std::vector<T> e(n, 0.0);
+    std::vector<T> d_init(n, 0.0);
+
+    RandLAPACK::gen::mat_gen_info<T> m_info(m, n, RandLAPACK::gen::gaussian);
+    RandLAPACK::gen::mat_gen(m_info, A.data(), state);
+
+    long dur_nrm2 = time_min(numruns, [&]() {
+        for (int64_t j = 0; j < n; ++j) {
+            d[j] = blas::nrm2(m, &A[m * j], 1);
+            e[j] = d[j];
+        }
+    });
+    long dur_simd     = time_min(numruns, [&]() { RandLAPACK::NoFLA_QRP_compute_norms(m, n, A.data(), m, d.data(), e.data(), false); });
+    long dur_simd_par = time_min(numruns, [&]() { RandLAPACK::NoFLA_QRP_compute_norms(m, n, A.data(), m, d.data(), e.data(), true); });
+
+    // Downdating the norms of the trailing columns after the reflector of the first row,
+    // as in the panel QRCP. The norms are reset before every run.
+    d_init = d;
+    long dur_down = time_min(numruns, [&]() {
+        std::copy(d_init.begin(), d_init.end(), d.begin());
+        RandLAPACK::NoFLA_QRP_downdate_partial_norms(m - 1, n, d.data(), 1, e.data(), 1, A.data(), m, &A[1], m, false);
+    });
+    long dur_down_par = time_min(numruns, [&]() {
+        std::copy(d_init.begin(), d_init.end(), d.begin());
+        RandLAPACK::NoFLA_QRP_downdate_partial_norms(m - 1, n, d.data(), 1, e.data(), 1, A.data(), m, &A[1], m, true);
+    });
+
+    printf("COLS %ld: NRM2 %ld ns, SIMD %ld ns, SIMD PARALLEL %ld ns, DOWNDATE %ld ns, DOWNDATE PARALLEL %ld ns\n",
+            n, dur_nrm2, dur_simd, dur_simd_par, dur_down, dur_down_par);
+
+    std::ofstream file(output_filename, std::ios::app);
+    file << n << ",  " << dur_nrm2 << ",  " << dur_simd << ",  " << dur_simd_par << ",  " << dur_down << ",  " << dur_down_par << ",\n";
+}
+
+int main(int argc, char *argv[]) {
+
+    if(argc <= 1) {
+        printf("No input provided\n");
+        return 0;
+    }
+
+    // Number of rows; the sketch in HQRRP has nb_alg + pp rows, the panels have up to m.
+    int64_t m          = std::stol(argv[1]);
+    int64_t n_start    = 32;
+    int64_t n_end      = argc > 2 ? std::stol(argv[2]) : 16384;
+    auto state         = RandBLAS::RNGState<r123::Philox4x32>();
+    // Number of kernel runs. We record the best time.
+    int64_t numruns    = 20;
+
+    // Declare a data file
+    std::string output_filename = "HQRRP_norms_time_raw_rows_"   + std::to_string(m)
+                                    + "_cols_start_"   + std::to_string(n_start)
+                                    + "_cols_end_"     + std::to_string(n_end)
+                                    + ".dat";
+
+    for (int64_t n = n_start; n <= n_end; n *= 2) {
+        call_all_algs<double>(numruns, m, n, state, output_filename);
+    }
+}
@@ -11,6 +11,17 @@ There are 7 things that we time:
                 5. QR time.
                 6. Updating A time.
                 7. Updating Sketch time.
+Every configuration is run three times:
+                1. With a dense G and no lookahead.
+                2. With a dense G and a lookahead on the number of threads given as the second argument
+                   (a quarter of the threads by default). The QR time then includes the part of
+                   updating A that overlaps with the next panel.
+                3. With a sparse G with the number of nonzeros per column given as the fourth argument
+                   (4 by default), and no lookahead. This affects the sketching time only.
+The number of rows can be set with the third argument, the matrix is square by default;
+the sparse G pays off for m much larger than n.
+Every line of the output file starts with the number of lookahead threads and the number of nonzeros
+per column of G (0 for a dense G), followed by the timing array of HQRRP.
 */
 
 #include "RandLAPACK.hh"
@@ -59,6 +70,8 @@ static void call_all_algs(
     RandLAPACK::gen::mat_gen_info<T> m_info,
     int64_t numruns,
     int64_t b_sz,
+    int64_t lookahead,
+    int64_t sketch_nnz,
     QR_speed_benchmark_data<T> &all_data,
     RandBLAS::RNGState<RNG> &state,
     std::string output_filename) {
@@ -78,18 +91,21 @@ static void call_all_algs(
     for (int i = 0; i < numruns; ++i) {
         printf("Iteration %d start.\n", i);
 
-        // Testing HQRRP
-        // No CholQR
-        RandLAPACK::hqrrp(m, n, all_data.A.data(), m, all_data.J.data(), all_data.tau.data(), b_sz, (d_factor - 1) * b_sz, panel_pivoting, 0, state_alg, times);
-
-        std::ofstream file(output_filename, std::ios::app);
-        std::copy(times, times + 29, std::ostream_iterator<T>(file, ", "));
-        file << "\n";
-
-        // Clear and re-generate data
-        data_regen(m_info, all_data, state_gen);
-        state_gen = state;
-        state_alg = state;
+        for (auto [la, nnz] : {std::pair<int64_t, int64_t>{0, 0}, {lookahead, 0}, {0, sketch_nnz}}) {
+            // Testing HQRRP
+            // No CholQR
+            RandLAPACK::hqrrp(m, n, all_data.A.data(), m, all_data.J.data(), all_data.tau.data(), b_sz, (d_factor - 1) * b_sz, panel_pivoting, 0, state_alg, times, (RandLAPACK::SketchQRCP*) nullptr, la, nnz);
+
+            std::ofstream file(output_filename, std::ios::app);
+            file << la << ", " << nnz << ", ";
+            std::copy(times, times + 29, std::ostream_iterator<T>(file, ", "));
+            file << "\n";
+
+            // Clear and re-generate data
+            data_regen(m_info, all_data, state_gen);
+            state_gen = state;
+            state_alg = state;
+        }
     }
 
     free(times);
@@ -103,9 +119,13 @@ int main(int argc, char *argv[]) {
     }
 
     auto size = argv[1];
+    // Number of threads that factor the next panel while the trailing matrix is updated.
+    int64_t lookahead  = argc > 2 ? std::stol(argv[2]) : std::max<int64_t>(1, RandLAPACK::util::max_threads() / 4);
+    // Number of nonzeros per column of a sparse G.
+    int64_t sketch_nnz = argc > 4 ? std::stol(argv[4]) : 4;
 
     // Declare parameters
-    int64_t m          = std::stol(size);
+    int64_t m          = argc > 3 ? std::stol(argv[3]) : std::stol(size);
     int64_t n          = std::stol(size);
     double  d_factor   = 1.0;
     int64_t b_sz_start = 256;
@@ -130,10 +150,12 @@ int main(int argc, char *argv[]) {
                                     + "_b_sz_start_" + std::to_string(b_sz_start)
                                     + "_b_sz_end_"   + std::to_string(b_sz_end)
                                     + "_d_factor_"   + std::to_string(d_factor)
+                                    + "_lookahead_"  + std::to_string(lookahead)
+                                    + "_sketch_nnz_" + std::to_string(sketch_nnz)
                                     + ".dat";
 
     for (;b_sz_start <= b_sz_end; b_sz_start *= 2) {
-        call_all_algs(m_info, numruns, b_sz_start, all_data, state_constant, file);
+        call_all_algs(m_info, numruns, b_sz_start, lookahead, sketch_nnz, all_data, state_constant, file);
     }
 }
 #endif
\ No newline at end of file
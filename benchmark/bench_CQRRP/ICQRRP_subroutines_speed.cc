@@ -145,9 +145,13 @@ static void call_wide_qrcp(
     CQRRPT.nnz = 4;
     CQRRPT.num_threads = 4;
 
+    RandLAPACK::Tournament_QRCP QRCP_tournament;
+
     // timing vars
     long dur_geqp3  = 0;
     long dur_luqr   = 0;
+    long dur_luqr_nt = 0;
+    long dur_tournament = 0;
     long dur_cqrrpt = 0;
  
     // Making sure the states are unchanged
@@ -196,9 +200,34 @@ static void call_wide_qrcp(
         auto stop_luqr = high_resolution_clock::now();
         dur_luqr = duration_cast<microseconds>(stop_luqr - start_luqr).count();
         data_regen(m_info, all_data, state, state, 1);
+
+        // Testing transpose-free LUQR
+        auto start_luqr_nt = high_resolution_clock::now();
+            // Perform pivoted LU on A_sk with column pivots, A_sk[:, J] = L * U.
+            RandLAPACK::util::getrf_col_piv(n, m, all_data.A.data(), n, all_data.J.data());
+            // Move L out of A_sk, make U explicit.
+            for (j = 0; j < n; ++j) {
+                std::fill(&(all_data.R)[n * j], &(all_data.R)[n * j + j], 0.0);
+                blas::copy(n - j, &(all_data.A)[n * j + j], 1, &(all_data.R)[n * j + j], 1);
+                std::fill(&(all_data.A)[n * j + j + 1], &(all_data.A)[n * j + n], 0.0);
+                all_data.A[n * j + j] = 1.0;
+            }
+            // R = R_L * U, where L = Q * R_L
+            lapack::geqrf(n, n, all_data.R.data(), n, all_data.tau.data());
+            blas::trmm(Layout::ColMajor, Side::Left, Uplo::Upper, Op::NoTrans, Diag::NonUnit, n, m, (T) 1.0, all_data.R.data(), n, all_data.A.data(), n);
+        auto stop_luqr_nt = high_resolution_clock::now();
+        dur_luqr_nt = duration_cast<microseconds>(stop_luqr_nt - start_luqr_nt).count();
+        data_regen(m_info, all_data, state, state, 1);
+
+        // Testing tournament pivoting
+        auto start_tournament = high_resolution_clock::now();
+        QRCP_tournament.call(n, m, all_data.A.data(), n, all_data.J.data(), all_data.tau.data());
+        auto stop_tournament = high_resolution_clock::now();
+        dur_tournament = duration_cast<microseconds>(stop_tournament - start_tournament).count();
+        data_regen(m_info, all_data, state, state, 1);
     
         std::ofstream file(output_filename, std::ios::app);
-        file << m << ",  " << n << ",  " << dur_geqp3 << ",  " << dur_luqr << ",  " << dur_cqrrpt << ",\n";
+        file << m << ",  " << n << ",  " << dur_geqp3 << ",  " << dur_luqr << ",  " << dur_luqr_nt << ",  " << dur_tournament << ",  " << dur_cqrrpt << ",\n";
     }
 }
 
@@ -358,7 +387,7 @@ int main(int argc, char *argv[]) {
                                       + ".dat"; 
     std::ofstream file(output_filename, std::ios::app);
 
-    file << "\nWIDE QRCP: m n GEQP3  LUQR  CQRRPT\n";
+    file << "\nWIDE QRCP: m n GEQP3  LUQR  LUQR_NT  TOURNAMENT  CQRRPT\n";
     for (i = n_start; i <= n_stop; i *= 2)
         call_wide_qrcp(m_info, numruns, i, all_data, state, output_filename);
 
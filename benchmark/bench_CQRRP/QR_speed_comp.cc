@@ -4,6 +4,8 @@ QR speed comparison benchmark - runs:
     2. GEQR
     3. GEQR+UNGQR
     4. CholQR
+    5. CQRRP_blocked
+    6. CQRRP_recursive
 for a matrix with fixed number of rows and a varying number of columns.
 */
 #include "RandLAPACK.hh"
@@ -28,6 +30,7 @@ struct QR_benchmark_data {
     std::vector<T> tau;
     std::vector<T> T_mat;
     std::vector<T> D;
+    std::vector<int64_t> J;
 
     QR_benchmark_data(int64_t m, int64_t n) :
     A(m * n, 0.0),
@@ -37,7 +40,8 @@ struct QR_benchmark_data {
     QR(m * n, 0.0),
     tau(n, 0.0),
     T_mat(n * n, 0.0),
-    D(n, 0.0)
+    D(n, 0.0),
+    J(n, 0)
     {
         row = m;
         col = n;
@@ -66,6 +70,7 @@ static void call_all_algs(
     RandLAPACK::gen::mat_gen_info<T> m_info,
     int64_t numruns,
     int64_t n,
+    int64_t b_sz,
     QR_benchmark_data<T> &all_data,
     RandBLAS::RNGState<RNG> &state,
     std::string output_filename) {
@@ -73,6 +78,14 @@ static void call_all_algs(
     auto m        = all_data.row;
 
     int64_t tsize = 0;
+    // GEQR stores its T factor in a buffer of its own, sized by a workspace query;
+    // it is kept at least n long, as UNGQR reads n entries of it.
+    std::vector<T> T_geqr(5, 0.0);
+    T d_factor    = 1.25;
+    T tol         = std::pow(std::numeric_limits<T>::epsilon(), 0.85);
+
+    RandLAPACK::CQRRP_blocked<T, r123::Philox4x32> CQRRP_blocked(false, tol, b_sz);
+    RandLAPACK::CQRRP_recursive<T, r123::Philox4x32> CQRRP_recursive(false, tol, b_sz);
 
     // timing vars
     long dur_geqrf       = 0;
@@ -80,6 +93,8 @@ static void call_all_algs(
     long dur_geqr_ungqr  = 0;
     long dur_cholqr      = 0;
     long dur_cholqr_orhr = 0;
+    long dur_cqrrp       = 0;
+    long dur_cqrrp_rec   = 0;
     
     // Making sure the states are unchanged
     auto state_gen = state;
@@ -98,10 +113,10 @@ static void call_all_algs(
 #if !defined(__APPLE__)
         // Testing GEQR
         auto start_geqr = high_resolution_clock::now();
-        lapack::geqr(m, n, all_data.A.data(), m,  all_data.tau.data(), -1);
-        tsize = (int64_t) all_data.tau[0]; 
-        all_data.tau.resize(tsize);
-        lapack::geqr(m, n, all_data.A.data(), m, all_data.tau.data(), tsize);
+        lapack::geqr(m, n, all_data.A.data(), m,  T_geqr.data(), -1);
+        tsize = (int64_t) T_geqr[0]; 
+        T_geqr.resize(std::max(tsize, n));
+        lapack::geqr(m, n, all_data.A.data(), m, T_geqr.data(), tsize);
         auto stop_geqr = high_resolution_clock::now();
         dur_geqr = duration_cast<microseconds>(stop_geqr - start_geqr).count();
 
@@ -110,11 +125,11 @@ static void call_all_algs(
 
         // Testing GEQR + UNGQR
         auto start_geqr_ungqr = high_resolution_clock::now();
-        lapack::geqr(m, n, all_data.A.data(), m,  all_data.tau.data(), -1);
-        tsize = (int64_t) all_data.tau[0]; 
-        all_data.tau.resize(tsize);
-        lapack::geqr(m, n, all_data.A.data(), m, all_data.tau.data(), tsize);
-        lapack::ungqr(m, n, n, all_data.A.data(), m, all_data.tau.data());
+        lapack::geqr(m, n, all_data.A.data(), m,  T_geqr.data(), -1);
+        tsize = (int64_t) T_geqr[0]; 
+        T_geqr.resize(std::max(tsize, n));
+        lapack::geqr(m, n, all_data.A.data(), m, T_geqr.data(), tsize);
+        lapack::ungqr(m, n, n, all_data.A.data(), m, T_geqr.data());
 
         auto stop_geqr_ungqr = high_resolution_clock::now();
         dur_geqr_ungqr = duration_cast<microseconds>(stop_geqr_ungqr - start_geqr_ungqr).count();
@@ -133,12 +148,32 @@ static void call_all_algs(
         lapack::orhr_col(m, n, n, all_data.A.data(), m, all_data.T_mat.data(), n, all_data.D.data());
         auto stop_cholqr_orhr = high_resolution_clock::now();
         dur_cholqr_orhr = duration_cast<microseconds>(stop_cholqr_orhr - start_cholqr).count();
+
+        state_gen = state;
+        data_regen(m_info, all_data, state_gen, 0);
+
+        // Testing CQRRP_blocked
+        auto state_alg = state;
+        auto start_cqrrp = high_resolution_clock::now();
+        CQRRP_blocked.call(m, n, all_data.A.data(), m, d_factor, all_data.tau.data(), all_data.J.data(), state_alg);
+        auto stop_cqrrp = high_resolution_clock::now();
+        dur_cqrrp = duration_cast<microseconds>(stop_cqrrp - start_cqrrp).count();
+
+        state_gen = state;
+        data_regen(m_info, all_data, state_gen, 0);
+
+        // Testing CQRRP_recursive
+        state_alg = state;
+        auto start_cqrrp_rec = high_resolution_clock::now();
+        CQRRP_recursive.call(m, n, all_data.A.data(), m, d_factor, all_data.tau.data(), all_data.J.data(), state_alg);
+        auto stop_cqrrp_rec = high_resolution_clock::now();
+        dur_cqrrp_rec = duration_cast<microseconds>(stop_cqrrp_rec - start_cqrrp_rec).count();
 #endif
         state_gen = state;
         data_regen(m_info, all_data, state_gen, 1);
     
         std::ofstream file(output_filename, std::ios::app);
-        file << n << ",  " << dur_geqrf << ",  " << dur_geqr << ",  " << dur_geqr_ungqr << ",  " << dur_cholqr <<  ",  " << dur_cholqr_orhr << ",\n";
+        file << n << ",  " << dur_geqrf << ",  " << dur_geqr << ",  " << dur_geqr_ungqr << ",  " << dur_cholqr <<  ",  " << dur_cholqr_orhr << ",  " << dur_cqrrp << ",  " << dur_cqrrp_rec << ",\n";
     }
 }
 
@@ -147,6 +182,8 @@ int main() {
     int64_t m           = std::pow(2, 17);
     int64_t n_start     = std::pow(2, 9);
     int64_t n_stop      = std::pow(2, 13);
+    // Block size of both CQRRP versions.
+    int64_t b_sz        = 256;
     auto state          = RandBLAS::RNGState();
     auto state_constant = state;
     // Timing results
@@ -169,6 +206,6 @@ int main() {
                                       + ".dat"; 
 
     for (;n_start <= n_stop; n_start *= 2) {
-        call_all_algs(m_info, numruns, n_start, all_data, state_constant, output_filename);
+        call_all_algs(m_info, numruns, n_start, b_sz, all_data, state_constant, output_filename);
     }
 }
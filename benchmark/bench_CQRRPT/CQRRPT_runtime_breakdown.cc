@@ -7,6 +7,10 @@ There are 6 things that we time:
                 4. piv(A).
                 5. TRSM(A).
                 6. Time to perform Cholesky QR.
+Every run is done twice: with the separate trsm + syrk, and with the fused trsm + Gram kernel
+(in which case the fused kernel is reported as TRSM(A), and Cholesky QR excludes the Gram matrix).
+For the fused runs, we additionally report the DRAM traffic avoided (one full read of the m by k matrix A)
+and the bandwidth that this saves, relative to the best unfused time spent on TRSM(A) and Cholesky QR.
 */
 #include "RandLAPACK.hh"
 #include "rl_blaspp.hh"
@@ -73,25 +77,45 @@ static void call_all_algs(
     // Making sure the states are unchanged
     auto state_alg = state;
     auto state_gen = state;
+    // Best time of the unfused trsm + Cholesky QR
+    long best_unfused_t = 0;
 
-    for (int i = 0; i < numruns; ++i) {
-        printf("Iteration %d start.\n", i);
-        CQRRPT.call(m, n, all_data.A.data(), m, all_data.R.data(), n, all_data.J.data(), d_factor, state_alg);
-        
-        std::ofstream file(output_filename, std::ios::app);
-        file << CQRRPT.times[0] << ",  " << CQRRPT.times[1] << ",  " << CQRRPT.times[2] << ",  " 
-             << CQRRPT.times[3] << ",  " << CQRRPT.times[4] << ",  " << CQRRPT.times[5] << ",  " 
-             << CQRRPT.times[6] << ",  " << CQRRPT.times[7] << ",\n";
+    for (int fused = 0; fused < 2; ++fused) {
+        CQRRPT.use_fused_gram = fused;
+        for (int i = 0; i < numruns; ++i) {
+            printf("Iteration %d start, fused Gram %d.\n", i, fused);
+            CQRRPT.call(m, n, all_data.A.data(), m, all_data.R.data(), n, all_data.J.data(), d_factor, state_alg);
 
-        // Making sure the states are unchanged
-        state_alg = state;
-        state_gen = state;
-        // Clear and re-generate data
-        data_regen(m_info, all_data, state_gen);
+            // TRSM(A) + Cholesky QR
+            long precond_gram_t = CQRRPT.times[5] + CQRRPT.times[3];
+            // Fused kernel saves one pass over A
+            double bytes_saved = (double) m * CQRRPT.rank * sizeof(T);
+            double bandwidth_saved = 0;
+            if (!fused) {
+                best_unfused_t = (i == 0) ? precond_gram_t : std::min(best_unfused_t, precond_gram_t);
+            } else if (precond_gram_t < best_unfused_t) {
+                // GB/s
+                bandwidth_saved = bytes_saved / (best_unfused_t - precond_gram_t) / 1e3;
+            }
+            if (fused)
+                printf("Fused Gram kernel: %e bytes of traffic avoided, %f GB/s saved.\n", bytes_saved, bandwidth_saved);
+            
+            std::ofstream file(output_filename, std::ios::app);
+            file << fused << ",  "
+                 << CQRRPT.times[0] << ",  " << CQRRPT.times[1] << ",  " << CQRRPT.times[2] << ",  " 
+                 << CQRRPT.times[3] << ",  " << CQRRPT.times[4] << ",  " << CQRRPT.times[5] << ",  " 
+                 << CQRRPT.times[6] << ",  " << CQRRPT.times[7] << ",  "
+                 << bytes_saved * fused << ",  " << bandwidth_saved << ",\n";
+
+            // Making sure the states are unchanged
+            state_alg = state;
+            state_gen = state;
+            // Clear and re-generate data
+            data_regen(m_info, all_data, state_gen);
+        }
     }
 }
 
-
 int main() {
     // Declare parameters
     int64_t m           = std::pow(2, 12);
@@ -12,6 +12,8 @@ There are 10 things that we time:
                 8.R_ii cpy time.
                 9.S_ii cpy time.
                 10.Norm R time.
+Every configuration is run with each of the reorthogonalization policies (cgs2, cgs2_fused, cgs2_selective),
+recorded as 0, 1, 2 in the first column, followed by the number of second Gram-Schmidt passes done.
 */
 #include "RandLAPACK.hh"
 #include "rl_blaspp.hh"
@@ -90,24 +92,31 @@ static void call_all_algs(
     // Timing vars
     std::vector<long> inner_timing;
 
-    for (int i = 0; i < numruns; ++i) {
-        printf("Iteration %d start.\n", i);
-        RBKI.call(m, n, all_data.A.data(), m, k, all_data.U.data(), all_data.V.data(), all_data.Sigma.data(), state_alg);
-        
-        // Update timing vector
-        inner_timing = RBKI.times;
-        // Add info about the run
-        inner_timing.insert (inner_timing.begin(), k);
-        inner_timing.insert (inner_timing.begin(), num_krylov_iters);
-
-        std::ofstream file(output_filename, std::ios::app);
-        std::copy(inner_timing.begin(), inner_timing.end(), std::ostream_iterator<long>(file, ", "));
-        file << "\n";
-
-        // Clear and re-generate data
-        data_regen(m_info, all_data, state_gen, 0);
-        state_gen = state;
-        state_alg = state;
+    for (auto reorth : {RandLAPACK::cgs2, RandLAPACK::cgs2_fused, RandLAPACK::cgs2_selective}) {
+        RBKI.reorth = reorth;
+        for (int i = 0; i < numruns; ++i) {
+            printf("Iteration %d start.\n", i);
+            RBKI.call(m, n, all_data.A.data(), m, k, all_data.U.data(), all_data.V.data(), all_data.Sigma.data(), state_alg);
+
+            printf("Reorth policy %d: %d second passes, reorth takes %.2f%% of runtime.\n", (int) reorth, RBKI.num_reorths, 100 * ((T) RBKI.times[3] / (T) RBKI.times[12]));
+
+            // Update timing vector
+            inner_timing = RBKI.times;
+            // Add info about the run
+            inner_timing.insert (inner_timing.begin(), k);
+            inner_timing.insert (inner_timing.begin(), num_krylov_iters);
+            inner_timing.insert (inner_timing.begin(), RBKI.num_reorths);
+            inner_timing.insert (inner_timing.begin(), (long) reorth);
+
+            std::ofstream file(output_filename, std::ios::app);
+            std::copy(inner_timing.begin(), inner_timing.end(), std::ostream_iterator<long>(file, ", "));
+            file << "\n";
+
+            // Clear and re-generate data
+            data_regen(m_info, all_data, state_gen, 0);
+            state_gen = state;
+            state_alg = state;
+        }
     }
 }
 
@@ -4,6 +4,9 @@ The user is required to provide a matrix file to be read, set min and max number
 furthermore, the user is to provide a 'custom rank' parameter (number of singular vectors to approximate by RBKI). 
 The benchmark outputs the basic data of a given run, as well as the RBKI runtime and singular vector residual error, 
 which is computed as "sqrt(||AV - SU||^2_F + ||A'U - VS||^2_F / sqrt(custom_rank)" (for "custom rank" singular vectors and values).
+Every configuration is also run in mixed precision, with the products with A done on a float copy of A;
+the runtime, the residual error and the largest relative difference of the leading custom_rank singular values 
+from the all-double run are recorded as well.
 */
 
 #include "RandLAPACK.hh"
@@ -24,6 +27,7 @@ struct RBKI_benchmark_data {
     std::vector<T> U;
     std::vector<T> VT; // RBKI returns V'
     std::vector<T> Sigma;
+    std::vector<T> Sigma_cpy;
     std::vector<T> U_cpy;
     std::vector<T> VT_cpy;
 
@@ -31,7 +35,8 @@ struct RBKI_benchmark_data {
     A(m * n, 0.0),
     U(m * n, 0.0),
     VT(n * n, 0.0),
-    Sigma(n, 0.0)
+    Sigma(n, 0.0),
+    Sigma_cpy(n, 0.0)
     {
         row = m;
         col = n;
@@ -127,8 +132,12 @@ static void call_all_algs(
     RBKI.max_krylov_iters = (int) num_matmuls;
     int64_t target_rank = b_sz * num_matmuls / 2;
 
+    // Float copy of A for the mixed-precision runs.
+    RandLAPACK::MixedPrecisionLinOp<T, float> A_mixed(m, n, all_data.A.data(), m, Layout::ColMajor);
+
     // timing vars
-    long dur_rbki    = 0;
+    long dur_rbki       = 0;
+    long dur_rbki_mixed = 0;
 
     // Making sure the states are unchanged
     auto state_gen = state;
@@ -145,13 +154,33 @@ static void call_all_algs(
 
         T residual_err_custom = residual_error_comp<T>(all_data, custom_rank);
         T residual_err_target = residual_error_comp<T>(all_data, target_rank);
+        // Keep the all-double singular values for comparison.
+        std::copy(all_data.Sigma.begin(), all_data.Sigma.end(), all_data.Sigma_cpy.begin());
+
+        // Testing mixed-precision RBKI
+        state_alg = state;
+        data_regen(m_info, all_data, state_gen, 0);
+        auto start_rbki_mixed = high_resolution_clock::now();
+        RBKI.call(A_mixed, b_sz, all_data.U.data(), all_data.VT.data(), all_data.Sigma.data(), state_alg);
+        auto stop_rbki_mixed = high_resolution_clock::now();
+        dur_rbki_mixed = duration_cast<microseconds>(stop_rbki_mixed - start_rbki_mixed).count();
+
+        T residual_err_custom_mixed = residual_error_comp<T>(all_data, custom_rank);
+        // Largest relative difference of the leading singular values from the all-double run.
+        T sigma_err_mixed = 0;
+        for (int64_t j = 0; j < custom_rank; ++j)
+            sigma_err_mixed = std::max(sigma_err_mixed, std::abs(all_data.Sigma[j] - all_data.Sigma_cpy[j]) / all_data.Sigma_cpy[j]);
 
         // Print accuracy info
         printf("sqrt(||AV - SU||^2_F + ||A'U - VS||^2_F) / sqrt(custom_rank): %.16e\n", residual_err_custom);
         printf("sqrt(||AV - SU||^2_F + ||A'U - VS||^2_F) / sqrt(traget_rank): %.16e\n", residual_err_target);
+        printf("Mixed precision, sqrt(||AV - SU||^2_F + ||A'U - VS||^2_F) / sqrt(custom_rank): %.16e\n", residual_err_custom_mixed);
+        printf("Mixed precision, max relative error of the leading singular values: %.16e\n", sigma_err_mixed);
+        printf("RBKI %ld μs, mixed-precision RBKI %ld μs\n", dur_rbki, dur_rbki_mixed);
         
         std::ofstream file(output_filename, std::ios::app);
-        file << b_sz << ",  " << RBKI.max_krylov_iters <<  ",  " << target_rank << ",  " << custom_rank << ",  " << residual_err_target << ",  " << residual_err_custom <<  ",  " << dur_rbki  << ",  " << dur_svd << ",\n";
+        file << b_sz << ",  " << RBKI.max_krylov_iters <<  ",  " << target_rank << ",  " << custom_rank << ",  " << residual_err_target << ",  " << residual_err_custom <<  ",  " << dur_rbki  << ",  " << dur_svd 
+             << ",  " << residual_err_custom_mixed << ",  " << sigma_err_mixed << ",  " << dur_rbki_mixed << ",\n";
         state_gen = state;
         state_alg = state;
         data_regen(m_info, all_data, state_gen, 0);
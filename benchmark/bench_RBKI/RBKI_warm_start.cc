@@ -0,0 +1,103 @@
+/*
+RBKI warm start benchmark - emulates recomputing the leading singular triplets of a slowly drifting matrix.
+The input matrix is read from a file; at every step, it is perturbed by a Gaussian matrix scaled by 'drift' * ||A||_F / sqrt(m * n),
+and RBKI is run on it twice:
+    1. From a Gaussian starting block (cold start).
+    2. From the right singular vectors found at the previous step (warm start),
+       with the last 'num_random' columns of the starting block being Gaussian.
+Both runs stop once the leading k_target triplets have converged to a relative tolerance.
+Records the number of Krylov iterations and the runtime of both runs at every step.
+*/
+#include "RandLAPACK.hh"
+#include "rl_blaspp.hh"
+#include "rl_lapackpp.hh"
+#include "rl_gen.hh"
+
+#include <RandBLAS.hh>
+#include <fstream>
+
+int main(int argc, char *argv[]) {
+
+    printf("Function begin\n");
+
+    if(argc <= 1) {
+        printf("No input provided\n");
+        return 0;
+    }
+
+    int64_t m            = 0;
+    int64_t n            = 0;
+    int64_t b_sz         = argc > 2 ? std::stol(argv[2]) : 16;
+    int64_t k_target     = argc > 3 ? std::stol(argv[3]) : b_sz;
+    double drift         = argc > 4 ? std::stod(argv[4]) : 1e-6;
+    int64_t num_random   = argc > 5 ? std::stol(argv[5]) : 0;
+    double tol           = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    double residual_tol  = 1e-10;
+    auto state           = RandBLAS::RNGState<r123::Philox4x32>();
+    int numsteps         = 10;
+
+    // Generate the input matrix.
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::custom_input);
+    m_info.filename = argv[1];
+    m_info.workspace_query_mod = 1;
+    // Workspace query;
+    RandLAPACK::gen::mat_gen<double>(m_info, NULL, state);
+
+    // Update basic params.
+    m = m_info.rows;
+    n = m_info.cols;
+    num_random = std::min(num_random, b_sz);
+
+    std::vector<double> A(m * n, 0.0);
+    std::vector<double> E(m * n, 0.0);
+    std::vector<double> U(m * n, 0.0);
+    std::vector<double> VT(n * n, 0.0);
+    std::vector<double> Sigma(n, 0.0);
+    std::vector<double> Y_init(n * b_sz, 0.0);
+
+    // Fill the data matrix;
+    RandLAPACK::gen::mat_gen(m_info, A.data(), state);
+    double scale = drift * lapack::lange(Norm::Fro, m, n, A.data(), m) / std::sqrt((double) m * n);
+    RandLAPACK::gen::mat_gen_info<double> e_info(m, n, RandLAPACK::gen::gaussian);
+
+    printf("Finished data preparation\n");
+
+    RandLAPACK::RBKI<double, r123::Philox4x32> RBKI(false, true, tol);
+    RBKI.num_threads_some = 4;
+    RBKI.num_threads_rest = 48;
+    RBKI.k_target = k_target;
+    RBKI.residual_tol = residual_tol;
+    RBKI.residual_check_freq = 2;
+    RandLAPACK::ExplicitLinOp<double> A_linop(m, n, A.data(), m, Layout::ColMajor);
+
+    // Declare a data file
+    std::string output_filename = "RBKI_warm_start_m_"   + std::to_string(m)
+                                      + "_n_"            + std::to_string(n)
+                                      + "_b_sz_"         + std::to_string(b_sz)
+                                      + "_k_target_"     + std::to_string(k_target)
+                                      + "_num_random_"   + std::to_string(num_random)
+                                      + ".dat";
+
+    // Initial cold run, which provides the first starting block.
+    RBKI.call(A_linop, b_sz, U.data(), VT.data(), Sigma.data(), state);
+
+    for (int i = 0; i < numsteps; ++i) {
+        RandLAPACK::util::transposition(b_sz - num_random, n, VT.data(), n, Y_init.data(), n, 0);
+
+        RandLAPACK::gen::mat_gen(e_info, E.data(), state);
+        blas::axpy(m * n, scale, E.data(), 1, A.data(), 1);
+
+        RBKI.call(A_linop, b_sz, U.data(), VT.data(), Sigma.data(), state);
+        int iters_cold = RBKI.num_krylov_iters;
+        long dur_cold  = RBKI.times[12];
+
+        RBKI.call(A_linop, b_sz, U.data(), VT.data(), Sigma.data(), state, Y_init.data(), n, b_sz - num_random);
+        int iters_warm = RBKI.num_krylov_iters;
+        long dur_warm  = RBKI.times[12];
+
+        printf("Step %d: cold start %d iterations, %ld μs; warm start %d iterations, %ld μs\n", i, iters_cold, dur_cold, iters_warm, dur_warm);
+
+        std::ofstream file(output_filename, std::ios::app);
+        file << i << ",  " << iters_cold << ",  " << dur_cold << ",  " << iters_warm << ",  " << dur_warm << ",\n";
+    }
+}
@@ -0,0 +1,120 @@
+#include "RandLAPACK.hh"
+#include "rl_blaspp.hh"
+#include "rl_lapackpp.hh"
+#include "rl_gen.hh"
+
+#include <RandBLAS.hh>
+
+#include <math.h>
+#include <numeric>
+#include <gtest/gtest.h>
+
+
+class TestSketchQRCP : public ::testing::Test
+{
+    protected:
+
+    virtual void SetUp() {};
+
+    virtual void TearDown() {};
+
+    /// Factors a d-by-n Gaussian sketch whose columns have varying norms, and checks that:
+    ///     J is a permutation, A_sk[:, J] = QR, Q has orthonormal columns,
+    /// and, if 'norm_pivot' is set, that the leading pivot is the column of the largest norm.
+    template <typename T, typename RNG>
+    static void test_sketch_qrcp_general(
+        int64_t d,
+        int64_t n,
+        bool norm_pivot,
+        RandLAPACK::SketchQRCP &QRCP,
+        RandBLAS::RNGState<RNG> &state
+    ) {
+        int64_t k = std::min(d, n);
+        std::vector<T> A(d * n, 0.0);
+        std::vector<T> tau(n, 0.0);
+        std::vector<int64_t> J(n, 0);
+
+        RandBLAS::DenseDist D(d, n);
+        state = RandBLAS::fill_dense(D, A.data(), state).second;
+        for(int64_t j = 0; j < n; ++j)
+            blas::scal(d, (T) (1.0 + (j * 7919) % n), &A[d * j], 1);
+        std::vector<T> A_cpy(A);
+
+        T norm_max = 0;
+        for(int64_t j = 0; j < n; ++j)
+            norm_max = std::max(norm_max, blas::nrm2(d, &A[d * j], 1));
+
+        QRCP.call(d, n, A.data(), d, J.data(), tau.data());
+
+        std::vector<int64_t> J_sorted(J);
+        std::sort(J_sorted.begin(), J_sorted.end());
+        for(int64_t j = 0; j < n; ++j)
+            ASSERT_EQ(J_sorted[j], j + 1);
+
+        T atol = std::pow(std::numeric_limits<T>::epsilon(), 0.75);
+        if(norm_pivot) {
+            ASSERT_NEAR(std::abs(A[0]), norm_max, atol * norm_max);
+        }
+
+        // A_sk[:, J] - QR
+        std::vector<T> R(k * n, 0.0);
+        lapack::lacpy(MatrixType::Upper, k, n, A.data(), d, R.data(), k);
+        lapack::ungqr(d, k, k, A.data(), d, tau.data());
+        RandLAPACK::util::col_swap(d, n, n, A_cpy.data(), d, J);
+        T norm_A = lapack::lange(Norm::Fro, d, n, A_cpy.data(), d);
+        blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, d, n, k, (T) -1.0, A.data(), d, R.data(), k, (T) 1.0, A_cpy.data(), d);
+        T norm_AQR = lapack::lange(Norm::Fro, d, n, A_cpy.data(), d);
+
+        // Q'Q - I
+        std::vector<T> I_ref(k * k, 0.0);
+        RandLAPACK::util::eye(k, k, I_ref.data());
+        blas::syrk(Layout::ColMajor, Uplo::Upper, Op::Trans, k, d, (T) 1.0, A.data(), d, (T) -1.0, I_ref.data(), k);
+        T norm_0 = lapack::lansy(lapack::Norm::Fro, Uplo::Upper, k, I_ref.data(), k);
+
+        printf("REL NORM OF AP - QR:    %14e\n", norm_AQR / norm_A);
+        printf("FRO NORM OF (Q'Q - I):  %14e\n\n", norm_0 / std::sqrt((T) k));
+
+        ASSERT_LE(norm_AQR, atol * norm_A);
+        ASSERT_LE(norm_0, atol * std::sqrt((T) k));
+    }
+};
+
+TEST_F(TestSketchQRCP, geqp3) {
+    auto state = RandBLAS::RNGState();
+    RandLAPACK::GEQP3_QRCP QRCP;
+    test_sketch_qrcp_general<double>(40, 2000, true, QRCP, state);
+}
+
+TEST_F(TestSketchQRCP, luqr) {
+    auto state = RandBLAS::RNGState();
+    RandLAPACK::LUQR_QRCP QRCP;
+    test_sketch_qrcp_general<double>(40, 2000, false, QRCP, state);
+    // Tall sketch, as in CQRRPT
+    test_sketch_qrcp_general<double>(250, 200, false, QRCP, state);
+}
+
+TEST_F(TestSketchQRCP, hqrrp) {
+    auto state = RandBLAS::RNGState();
+    RandLAPACK::HQRRP_QRCP<r123::Philox4x32> QRCP(state);
+    QRCP.nb_alg = 16;
+    QRCP.oversampling = 4;
+    test_sketch_qrcp_general<double>(40, 2000, false, QRCP, state);
+}
+
+TEST_F(TestSketchQRCP, tournament) {
+    auto state = RandBLAS::RNGState();
+    RandLAPACK::Tournament_QRCP QRCP;
+    test_sketch_qrcp_general<double>(40, 2000, true, QRCP, state);
+    // Uneven groups, several levels of the tournament
+    QRCP.group_cols = 50;
+    test_sketch_qrcp_general<double>(40, 2013, true, QRCP, state);
+    // Fewer pivots than rows
+    QRCP.num_pivots = 10;
+    test_sketch_qrcp_general<double>(40, 2000, true, QRCP, state);
+}
+
+TEST_F(TestSketchQRCP, tournament_float) {
+    auto state = RandBLAS::RNGState();
+    RandLAPACK::Tournament_QRCP QRCP;
+    test_sketch_qrcp_general<float>(40, 2000, true, QRCP, state);
+}
@@ -6,6 +6,8 @@
 #include <RandBLAS/test/comparison.hh>
 
 #include <math.h>
+#include <numeric>
+#include <random>
 #include <chrono>
 #include <gtest/gtest.h>
 /*
@@ -187,6 +189,40 @@ class TestUtil : public ::testing::Test
         ASSERT_NEAR(norm, 0.0, std::pow(std::numeric_limits<T>::epsilon(), 0.625));
     }
 
+    /// Compares col_swap with a partial pivot vector (k < n) against sequential pairwise swapping.
+    /// Both the matrix and the integer versions are checked.
+    template <typename T>
+    static void 
+    test_col_swp_partial(ColSwpTestData<T> &all_data, int64_t k) {
+
+        auto m = all_data.row;
+        auto n = all_data.col;
+        std::vector<int64_t> J_ref(n, 0);
+        std::vector<int64_t> J_out(n, 0);
+        std::vector<int64_t> idx(all_data.J.begin(), all_data.J.begin() + k);
+        std::iota(J_ref.begin(), J_ref.end(), 1);
+        std::iota(J_out.begin(), J_out.end(), 1);
+
+        // Reference: one swap per pivot, in order
+        std::vector<int64_t> idx_ref(idx);
+        for (int64_t i = 0, j = 0; i < k; ++i) {
+            j = idx_ref[i] - 1;
+            blas::swap(m, &all_data.A[i * m], 1, &all_data.A[j * m], 1);
+            std::swap(J_ref[i], J_ref[j]);
+            auto it = std::find(&idx_ref[i], &idx_ref[k], i + 1);
+            if (it != &idx_ref[k])
+                *it = j + 1;
+        }
+
+        RandLAPACK::util::col_swap(m, n, k, all_data.A_cpy.data(), m, idx);
+        RandLAPACK::util::col_swap<T>(n, k, J_out.data(), idx);
+
+        for(int i = 0; i < m * n; ++i)
+            ASSERT_EQ(all_data.A[i], all_data.A_cpy[i]);
+        for(int i = 0; i < n; ++i)
+            ASSERT_EQ(J_ref[i], J_out[i]);
+    }
+
     template <typename T>
     static void 
     test_orhr_col(OrhrColTestData<T> &all_data) {
@@ -392,6 +428,103 @@ TEST_F(TestUtil, test_col_swp) {
     test_col_swp<double>(all_data);
 }
 
+TEST_F(TestUtil, test_col_swp_partial) {
+    
+    int64_t m = 3000;
+    int64_t n = 500;
+    int64_t k = 200;
+    auto state = RandBLAS::RNGState();
+    ColSwpTestData<double> all_data(m, n);
+
+    RandBLAS::DenseDist D(m, n);
+    state = RandBLAS::fill_dense(D, all_data.A.data(), state).second;
+    lapack::lacpy(MatrixType::General, m, n, all_data.A.data(), m, all_data.A_cpy.data(), m);
+
+    // Random permutation, only the first k entries of which are used
+    std::iota(all_data.J.begin(), all_data.J.end(), 1);
+    std::mt19937 gen(0);
+    std::shuffle(all_data.J.begin(), all_data.J.end(), gen);
+
+    test_col_swp_partial<double>(all_data, k);
+}
+
+// Tiles of the sketching operator must be bit-identical to the full operator,
+// and the state after the last tile must match the state after the full operator.
+TEST_F(TestUtil, test_fill_dense_cols) {
+    int64_t d = 60;
+    int64_t m = 1001;
+    int64_t tile_cols = 128;
+    auto state = RandBLAS::RNGState();
+
+    std::vector<double> S(d * m, 0.0);
+    RandBLAS::DenseDist D(d, m);
+    auto state_full = RandBLAS::fill_dense(D, S.data(), state).second;
+
+    std::vector<double> S_tile(d * tile_cols, 0.0);
+    auto state_tiles = state;
+    for(int64_t col_start = 0; col_start < m; col_start += tile_cols) {
+        int64_t cols = std::min(tile_cols, m - col_start);
+        state_tiles = RandLAPACK::util::fill_dense_cols(d, m, col_start, cols, S_tile.data(), state);
+        for(int64_t i = 0; i < d * cols; ++i)
+            ASSERT_EQ(S_tile[i], S[d * col_start + i]);
+    }
+
+    std::vector<double> next_full(100, 0.0);
+    std::vector<double> next_tiles(100, 0.0);
+    RandBLAS::DenseDist D_next(10, 10);
+    RandBLAS::fill_dense(D_next, next_full.data(), state_full);
+    RandBLAS::fill_dense(D_next, next_tiles.data(), state_tiles);
+    for(int64_t i = 0; i < 100; ++i)
+        ASSERT_EQ(next_full[i], next_tiles[i]);
+}
+
+// Column-pivoted LU on A must make the same pivoting decisions as row-pivoted getrf on A',
+// and A[:, J] must be reconstructed from its factors.
+TEST_F(TestUtil, test_getrf_col_piv) {
+    int64_t m = 150;
+    int64_t n = 1000;
+    int64_t lda = m + 7;
+    int64_t k = std::min(m, n);
+    auto state = RandBLAS::RNGState();
+
+    std::vector<double> A(lda * n, 0.0);
+    RandBLAS::DenseDist D(lda, n);
+    state = RandBLAS::fill_dense(D, A.data(), state).second;
+    std::vector<double> A_cpy(A);
+    double norm_A = lapack::lange(Norm::Fro, m, n, A.data(), lda);
+
+    // Reference pivots, from getrf on an explicit transpose
+    std::vector<double> A_trans(n * m, 0.0);
+    RandLAPACK::util::transposition(m, n, A.data(), lda, A_trans.data(), n, 0);
+    std::vector<int64_t> J_lu(k, 0);
+    lapack::getrf(n, m, A_trans.data(), n, J_lu.data());
+    std::vector<int64_t> J_ref(n, 0);
+    std::iota(J_ref.begin(), J_ref.end(), 1);
+    for(int64_t i = 0; i < k; ++i)
+        std::swap(J_ref[J_lu[i] - 1], J_ref[i]);
+
+    std::vector<int64_t> J(n, 0);
+    RandLAPACK::util::getrf_col_piv(m, n, A.data(), lda, J.data(), 32);
+    for(int64_t i = 0; i < k; ++i)
+        ASSERT_EQ(J[i], J_ref[i]);
+
+    // L * U - A[:, J]
+    std::vector<double> L(m * k, 0.0);
+    std::vector<double> U(k * n, 0.0);
+    for(int64_t j = 0; j < k; ++j)
+        blas::copy(m - j, &A[lda * j + j], 1, &L[m * j + j], 1);
+    for(int64_t j = 0; j < n; ++j) {
+        blas::copy(std::min(j, k), &A[lda * j], 1, &U[k * j], 1);
+        if(j < k)
+            U[k * j + j] = 1.0;
+    }
+    RandLAPACK::util::col_swap(m, n, n, A_cpy.data(), lda, J);
+    blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, m, n, k, 1.0, L.data(), m, U.data(), k, -1.0, A_cpy.data(), lda);
+
+    double norm_diff = lapack::lange(Norm::Fro, m, n, A_cpy.data(), lda);
+    ASSERT_LE(norm_diff / norm_A, std::pow(std::numeric_limits<double>::epsilon(), 0.75));
+}
+
 #if !defined(__APPLE__)
 TEST_F(TestUtil, test_orhr_col) {
     
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Sparse test matrices shared by the driver tests.
+
+template <typename T>
+struct SparseTestMatrix {
+    std::vector<int64_t> rowptr;
+    std::vector<int64_t> colidxs;
+    std::vector<T> csr_vals;
+    std::vector<int64_t> colptr;
+    std::vector<int64_t> rowidxs;
+    std::vector<T> csc_vals;
+};
+
+/// Stores the CSR and CSC representations of the nonzeros of the m by n column-major matrix A.
+template <typename T>
+void sparse_from_dense(int64_t m, int64_t n, const T* A, SparseTestMatrix<T> &A_sp) {
+    A_sp.rowptr.assign(1, 0);
+    A_sp.colidxs.clear();
+    A_sp.csr_vals.clear();
+    for(int64_t i = 0; i < m; ++i) {
+        for(int64_t j = 0; j < n; ++j) {
+            if(A[i + m * j] != 0.0) {
+                A_sp.colidxs.push_back(j);
+                A_sp.csr_vals.push_back(A[i + m * j]);
+            }
+        }
+        A_sp.rowptr.push_back(A_sp.colidxs.size());
+    }
+    A_sp.colptr.assign(1, 0);
+    A_sp.rowidxs.clear();
+    A_sp.csc_vals.clear();
+    for(int64_t j = 0; j < n; ++j) {
+        for(int64_t i = 0; i < m; ++i) {
+            if(A[i + m * j] != 0.0) {
+                A_sp.rowidxs.push_back(i);
+                A_sp.csc_vals.push_back(A[i + m * j]);
+            }
+        }
+        A_sp.colptr.push_back(A_sp.rowidxs.size());
+    }
+}
+
+/// Fills the m by n column-major A with a random sparse matrix with Gaussian nonzeros, each entry being
+/// nonzero with probability 'density', and stores its CSR and CSC representations.
+template <typename T>
+void sparse_gen(int64_t m, int64_t n, T density, uint64_t seed, T* A, SparseTestMatrix<T> &A_sp) {
+    std::mt19937_64 gen(seed);
+    std::bernoulli_distribution is_nonzero(density);
+    std::normal_distribution<T> value(0.0, 1.0);
+    for(int64_t i = 0; i < m * n; ++i)
+        A[i] = is_nonzero(gen) ? value(gen) : 0.0;
+    sparse_from_dense(m, n, A, A_sp);
+}
@@ -93,7 +93,7 @@ class TestCQRRP : public ::testing::Test
                 max_idx = i;
             }
         }
-        T col_norm_A = blas::nrm2(n, &A_cpy_dat[m * max_idx], 1);
+        T col_norm_A = blas::nrm2(m, &A_cpy_dat[m * max_idx], 1);
         T norm_AQR = lapack::lange(Norm::Fro, m, n, A_dat, m);
         
         printf("REL NORM OF AP - QR:    %14e\n", norm_AQR / norm_A);
@@ -144,6 +144,51 @@ class TestCQRRP : public ::testing::Test
         }
     }
 
+
+    /// Test for the truncated mode of CQRRP:
+    /// Only the leading CQRRP.rank columns of Q and rows of R are formed;
+    /// ||A[:, J] - QR||_F is then expected to be below rel_tol * ||A||_F.
+    template <typename T, typename RNG, typename alg_type>
+    static void test_CQRRP_truncated(
+        T d_factor, 
+        T norm_A,
+        T rel_tol,
+        CQRRPTestData<T> &all_data,
+        alg_type &CQRRP,
+        RandBLAS::RNGState<RNG> &state) {
+
+        auto m = all_data.row;
+        auto n = all_data.col;
+        T atol = std::pow(std::numeric_limits<T>::epsilon(), 0.75);
+
+        CQRRP.call(m, n, all_data.A.data(), m, d_factor, all_data.tau.data(), all_data.J.data(), state);
+
+        auto k = CQRRP.rank;
+        printf("RANK AS RETURNED BY CQRRP %4ld\n", k);
+        ASSERT_GT(k, 0);
+
+        RandLAPACK::util::upsize(k * n, all_data.R);
+        lapack::lacpy(MatrixType::Upper, k, n, all_data.A.data(), m, all_data.R.data(), k);
+        lapack::ungqr(m, k, k, all_data.A.data(), m, all_data.tau.data());
+        lapack::lacpy(MatrixType::General, m, k, all_data.A.data(), m, all_data.Q.data(), m);
+
+        // Q' * Q - I = 0
+        RandLAPACK::util::upsize(k * k, all_data.I_ref);
+        RandLAPACK::util::eye(k, k, all_data.I_ref);
+        blas::syrk(Layout::ColMajor, Uplo::Upper, Op::Trans, k, m, 1.0, all_data.Q.data(), m, -1.0, all_data.I_ref.data(), k);
+        T norm_0 = lapack::lansy(lapack::Norm::Fro, Uplo::Upper, k, all_data.I_ref.data(), k);
+
+        // A[:, J] - QR
+        RandLAPACK::util::col_swap(m, n, n, all_data.A_cpy1.data(), m, all_data.J);
+        blas::gemm(Layout::ColMajor, Op::NoTrans, Op::NoTrans, m, n, k, 1.0, all_data.Q.data(), m, all_data.R.data(), k, -1.0, all_data.A_cpy1.data(), m);
+        T norm_AQR = lapack::lange(Norm::Fro, m, n, all_data.A_cpy1.data(), m);
+
+        printf("REL NORM OF AP - QR:    %14e\n", norm_AQR / norm_A);
+        printf("FRO NORM OF (Q'Q - I):  %14e\n\n", norm_0 / std::sqrt((T) k));
+
+        ASSERT_LE(norm_AQR, rel_tol * norm_A);
+        ASSERT_LE(norm_0, atol * std::sqrt((T) k));
+    }
 };
 
 #if !defined(__APPLE__)
@@ -214,6 +259,232 @@ TEST_F(TestCQRRP, CQRRP_blocked_low_rank) {
     test_CQRRP_general(d_factor, norm_A, all_data, CQRRP_blocked, state);
 }
 
+// Note: If Subprocess killed exception -> reload vscode
+TEST_F(TestCQRRP, CQRRP_blocked_mixed_precision) {
+    int64_t m = 5000;
+    int64_t n = 2000;
+    int64_t k = 2000;
+    double d_factor = 1.25;
+    int64_t b_sz = 500;
+    double norm_A = 0;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    CQRRPTestData<double> all_data(m, n, k);
+    RandLAPACK::CQRRP_blocked<double, r123::Philox4x32> CQRRP_blocked(true, tol, b_sz);
+    CQRRP_blocked.use_mixed_precision = true;
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::gaussian);
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+
+    norm_and_copy_computational_helper(norm_A, all_data);
+    test_CQRRP_general(d_factor, norm_A, all_data, CQRRP_blocked, state);
+}
+
+// Note: If Subprocess killed exception -> reload vscode
+TEST_F(TestCQRRP, CQRRP_blocked_lookahead) {
+    int64_t m = 5000;
+    int64_t n = 2000;
+    int64_t k = 2000;
+    double d_factor = 1.25;
+    int64_t b_sz = 300;
+    double norm_A = 0;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    CQRRPTestData<double> all_data(m, n, k);
+    RandLAPACK::CQRRP_blocked<double, r123::Philox4x32> CQRRP_blocked(true, tol, b_sz);
+    CQRRP_blocked.use_lookahead = true;
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::gaussian);
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+
+    norm_and_copy_computational_helper(norm_A, all_data);
+    test_CQRRP_general(d_factor, norm_A, all_data, CQRRP_blocked, state);
+}
+
+// Note: If Subprocess killed exception -> reload vscode
+TEST_F(TestCQRRP, CQRRP_blocked_lookahead_low_rank) {
+    int64_t m = 5000;
+    int64_t n = 2000;
+    int64_t k = 100;
+    double d_factor = 2.0;
+    int64_t b_sz = 40;
+    double norm_A = 0;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    CQRRPTestData<double> all_data(m, n, k);
+    RandLAPACK::CQRRP_blocked<double, r123::Philox4x32> CQRRP_blocked(true, tol, b_sz);
+    CQRRP_blocked.use_lookahead = true;
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::polynomial);
+    m_info.cond_num = 2;
+    m_info.rank = k;
+    m_info.exponent = 2.0;
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+
+    norm_and_copy_computational_helper(norm_A, all_data);
+    test_CQRRP_general(d_factor, norm_A, all_data, CQRRP_blocked, state);
+}
+
+#if defined(_OPENMP)
+// With a single thread, the lookahead is not done; with several, the caller's thread count is left as it was.
+TEST_F(TestCQRRP, CQRRP_blocked_lookahead_thread_count) {
+    int64_t m = 2000;
+    int64_t n = 600;
+    int64_t k = 600;
+    double d_factor = 1.25;
+    int64_t b_sz = 100;
+    double norm_A = 0;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+    int threads_caller = omp_get_max_threads();
+
+    CQRRPTestData<double> all_data(m, n, k);
+    RandLAPACK::CQRRP_blocked<double, r123::Philox4x32> CQRRP_blocked(false, tol, b_sz);
+    CQRRP_blocked.use_lookahead = true;
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::gaussian);
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+    std::vector<double> A(all_data.A);
+
+    for (int threads : {1, 3}) {
+        all_data.A = A;
+        norm_and_copy_computational_helper(norm_A, all_data);
+        omp_set_num_threads(threads);
+        auto state_alg = state;
+        test_CQRRP_general(d_factor, norm_A, all_data, CQRRP_blocked, state_alg);
+        ASSERT_EQ(omp_get_max_threads(), threads);
+    }
+    omp_set_num_threads(threads_caller);
+}
+#endif
+
+// Note: If Subprocess killed exception -> reload vscode
+TEST_F(TestCQRRP, CQRRP_blocked_truncated_tol) {
+    int64_t m = 4000;
+    int64_t n = 1000;
+    int64_t k = 1000;
+    double d_factor = 1.25;
+    int64_t b_sz = 100;
+    double norm_A = 0;
+    double tol = 1e-6;
+    auto state = RandBLAS::RNGState();
+
+    CQRRPTestData<double> all_data(m, n, k);
+    RandLAPACK::CQRRP_blocked<double, r123::Philox4x32> CQRRP_blocked(false, tol, b_sz);
+    CQRRP_blocked.truncated = true;
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::exponential);
+    m_info.cond_num = 1e12;
+    m_info.rank = k;
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+
+    norm_and_copy_computational_helper(norm_A, all_data);
+    test_CQRRP_truncated(d_factor, norm_A, 10 * tol, all_data, CQRRP_blocked, state);
+    // The singular values fall below 1e-6 around the middle of the spectrum.
+    ASSERT_LT(CQRRP_blocked.rank, n);
+}
+
+// Note: If Subprocess killed exception -> reload vscode
+TEST_F(TestCQRRP, CQRRP_blocked_truncated_rank_cap) {
+    int64_t m = 4000;
+    int64_t n = 1000;
+    int64_t k = 300;
+    double d_factor = 1.25;
+    int64_t b_sz = 128;
+    double norm_A = 0;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    CQRRPTestData<double> all_data(m, n, k);
+    RandLAPACK::CQRRP_blocked<double, r123::Philox4x32> CQRRP_blocked(false, tol, b_sz);
+    CQRRP_blocked.truncated = true;
+    CQRRP_blocked.max_rank  = k;
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::polynomial);
+    m_info.cond_num = 10;
+    m_info.rank = k;
+    m_info.exponent = 2.0;
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+
+    norm_and_copy_computational_helper(norm_A, all_data);
+    test_CQRRP_truncated(d_factor, norm_A, std::pow(std::numeric_limits<double>::epsilon(), 0.75), all_data, CQRRP_blocked, state);
+    // The last block is shrunk to stop at the cap.
+    ASSERT_EQ(CQRRP_blocked.rank, k);
+}
+
+// Note: If Subprocess killed exception -> reload vscode
+TEST_F(TestCQRRP, CQRRP_blocked_tournament_qrcp) {
+    int64_t m = 5000;
+    int64_t n = 2000;
+    int64_t k = 2000;
+    double d_factor = 1.25;
+    int64_t b_sz = 100;
+    double norm_A = 0;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    CQRRPTestData<double> all_data(m, n, k);
+    RandLAPACK::CQRRP_blocked<double, r123::Philox4x32> CQRRP_blocked(true, tol, b_sz);
+    RandLAPACK::Tournament_QRCP QRCP;
+    CQRRP_blocked.QRCP_Obj = &QRCP;
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::gaussian);
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+
+    norm_and_copy_computational_helper(norm_A, all_data);
+    test_CQRRP_general(d_factor, norm_A, all_data, CQRRP_blocked, state);
+}
+
+// Note: If Subprocess killed exception -> reload vscode
+TEST_F(TestCQRRP, CQRRP_recursive_full_rank) {
+    int64_t m = 5000;
+    int64_t n = 2000;
+    int64_t k = 2000;
+    double d_factor = 1.25;
+    int64_t b_sz = 200;
+    double norm_A = 0;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    CQRRPTestData<double> all_data(m, n, k);
+    // Leaves of at most 800 columns, so that the recursion is two levels deep.
+    RandLAPACK::CQRRP_recursive<double, r123::Philox4x32> CQRRP_recursive(true, tol, b_sz);
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::gaussian);
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+
+    norm_and_copy_computational_helper(norm_A, all_data);
+    test_CQRRP_general(d_factor, norm_A, all_data, CQRRP_recursive, state);
+    ASSERT_EQ(CQRRP_recursive.rank, k);
+}
+
+// Note: If Subprocess killed exception -> reload vscode
+TEST_F(TestCQRRP, CQRRP_recursive_low_rank) {
+    int64_t m = 5000;
+    int64_t n = 2000;
+    int64_t k = 100;
+    double d_factor = 2.0;
+    int64_t b_sz = 40;
+    double norm_A = 0;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    CQRRPTestData<double> all_data(m, n, k);
+    RandLAPACK::CQRRP_recursive<double, r123::Philox4x32> CQRRP_recursive(true, tol, b_sz);
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::polynomial);
+    m_info.cond_num = 2;
+    m_info.rank = k;
+    m_info.exponent = 2.0;
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+
+    norm_and_copy_computational_helper(norm_A, all_data);
+    test_CQRRP_general(d_factor, norm_A, all_data, CQRRP_recursive, state);
+}
+
 // Note: If Subprocess killed exception -> reload vscode
 TEST_F(TestCQRRP, CQRRP_pivot_qual) {
     int64_t m = std::pow(2, 10);
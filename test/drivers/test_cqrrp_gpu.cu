@@ -144,7 +144,7 @@ class TestCQRRP : public ::testing::TestWithParam<int64_t>
                 max_idx = i;
             }
         }
-        T col_norm_A = blas::nrm2(n, &A_cpy_dat[m * max_idx], 1);
+        T col_norm_A = blas::nrm2(m, &A_cpy_dat[m * max_idx], 1);
         T norm_AQR = lapack::lange(Norm::Fro, m, n, A_dat, m);
         
         printf("REL NORM OF AP - QR:    %14e\n", norm_AQR / norm_A);
@@ -5,8 +5,11 @@
 
 #include <RandBLAS.hh>
 #include <fstream>
+#include <cstdio>
 #include <gtest/gtest.h>
 
+#include "sparse_test_matrix.hh"
+
 
 class TestCQRRPT : public ::testing::Test
 {
@@ -90,7 +93,7 @@ class TestCQRRPT : public ::testing::Test
                 max_idx = i;
             }
         }
-        T col_norm_A = blas::nrm2(n, &A_cpy_dat[m * max_idx], 1);
+        T col_norm_A = blas::nrm2(m, &A_cpy_dat[m * max_idx], 1);
         T norm_AQR = lapack::lange(Norm::Fro, m, n, A_dat, m);
         
         printf("REL NORM OF AP - QR:    %15e\n", norm_AQR / norm_A);
@@ -126,6 +129,112 @@ class TestCQRRPT : public ::testing::Test
 
         error_check(norm_A, all_data); 
     }
+    /// Out-of-core CQRRPT with the Q-factor written back into A:
+    /// checks the result the same way as the in-core version.
+    template <typename T, typename RNG, typename alg_type>
+    static void test_CQRRPT_out_of_core(
+        T d_factor, 
+        T norm_A,
+        int64_t panel_rows,
+        CQRRPTTestData<T> &all_data,
+        alg_type &CQRRPT,
+        RandBLAS::RNGState<RNG> &state) {
+
+        auto m = all_data.row;
+        auto n = all_data.col;
+
+        RandLAPACK::DenseRowPanels<T> A_panels(m, n, all_data.A.data(), m);
+        CQRRPT.call(A_panels, panel_rows, all_data.R.data(), n, all_data.J.data(), d_factor, state, true);
+
+        all_data.rank = CQRRPT.rank;
+        printf("RANK AS RETURNED BY CQRRPT %ld\n", all_data.rank);
+
+        RandLAPACK::util::col_swap(m, n, n, all_data.A_cpy1.data(), m, all_data.J);
+        RandLAPACK::util::col_swap(m, n, n, all_data.A_cpy2.data(), m, all_data.J);
+
+        error_check(norm_A, all_data); 
+    }
+
+    /// Sparse-input CQRRPT: the implicit Q is applied to the identity to form Q explicitly,
+    /// and the result is checked the same way as in the dense version.
+    /// Applying Q' to the explicit Q has to give the identity as well.
+    template <typename T, typename RNG, typename SpMat, typename alg_type>
+    static void test_CQRRPT_sparse(
+        T d_factor, 
+        T norm_A,
+        const SpMat &A_sp,
+        CQRRPTTestData<T> &all_data,
+        alg_type &CQRRPT,
+        RandBLAS::RNGState<RNG> &state) {
+
+        auto m = all_data.row;
+        auto n = all_data.col;
+
+        CQRRPT.call(A_sp, all_data.R.data(), n, all_data.J.data(), d_factor, state);
+
+        all_data.rank = CQRRPT.rank;
+        auto k = all_data.rank;
+        printf("RANK AS RETURNED BY CQRRPT %ld\n", k);
+
+        std::vector<T> I_k(k * k, 0.0);
+        RandLAPACK::util::eye(k, k, I_k.data());
+        RandLAPACK::SparseImplicitQ<T, SpMat> Q(A_sp, k, all_data.J.data(), CQRRPT.Q_precond.data(), CQRRPT.Q_chol.data(), k);
+        Q.apply(Op::NoTrans, k, I_k.data(), k, all_data.A.data(), m);
+
+        std::vector<T> QtQ(k * k, 0.0);
+        Q.apply(Op::Trans, k, all_data.A.data(), m, QtQ.data(), k);
+        for(int64_t i = 0; i < k; ++i)
+            QtQ[i + k * i] -= 1.0;
+        T atol = std::pow(std::numeric_limits<T>::epsilon(), 0.75);
+        ASSERT_LE(lapack::lange(Norm::Fro, k, k, QtQ.data(), k), atol * std::sqrt((T) n));
+
+        RandLAPACK::util::col_swap(m, n, n, all_data.A_cpy1.data(), m, all_data.J);
+        RandLAPACK::util::col_swap(m, n, n, all_data.A_cpy2.data(), m, all_data.J);
+
+        error_check(norm_A, all_data); 
+    }
+
+    /// Row-append updates: after every update, A[:, J] * inv(R) computed from all rows seen so far
+    /// has to be orthogonal. Rows [0, m_0) are used for the initial factorization, and the rest
+    /// are appended in blocks of m_new.
+    template <typename T, typename RNG>
+    static void test_CQRRPT_updatable(
+        int64_t m_0,
+        int64_t m_new,
+        T d_factor,
+        CQRRPTTestData<T> &all_data,
+        RandLAPACK::CQRRPT_updatable<T, RNG> &CQRRPT,
+        RandBLAS::RNGState<RNG> &state) {
+
+        auto m = all_data.row;
+        auto n = all_data.col;
+        T atol = std::pow(std::numeric_limits<T>::epsilon(), 0.75);
+
+        std::vector<T> A_0(m_0 * n, 0.0);
+        lapack::lacpy(MatrixType::General, m_0, n, all_data.A.data(), m, A_0.data(), m_0);
+        CQRRPT.factor(m_0, n, A_0.data(), m_0, d_factor, state);
+
+        for(int64_t row_start = m_0; row_start < m; row_start += m_new) {
+            CQRRPT.update(m_new, &all_data.A[row_start], m);
+            int64_t rows = row_start + m_new;
+            int64_t k = CQRRPT.rank;
+
+            // Q = A[0:rows, J[0:k]] * inv(R[0:k, 0:k])
+            std::vector<T> Q(rows * n, 0.0);
+            lapack::lacpy(MatrixType::General, rows, n, all_data.A.data(), m, Q.data(), rows);
+            RandLAPACK::util::col_swap(rows, n, n, Q.data(), rows, CQRRPT.J);
+            blas::trsm(Layout::ColMajor, Side::Right, Uplo::Upper, Op::NoTrans, Diag::NonUnit, rows, k, 1.0, CQRRPT.R.data(), n, Q.data(), rows);
+
+            std::vector<T> I_k(k * k, 0.0);
+            RandLAPACK::util::eye(k, k, I_k.data());
+            blas::syrk(Layout::ColMajor, Uplo::Upper, Op::Trans, k, rows, 1.0, Q.data(), rows, -1.0, I_k.data(), k);
+            T norm_0 = lapack::lansy(lapack::Norm::Fro, Uplo::Upper, k, I_k.data(), k);
+            printf("ROWS %ld, RANK %ld, PIVOT QUALITY %e, FRO NORM OF (Q'Q - I)/sqrt(n): %2e\n", rows, k, CQRRPT.pivot_quality(), norm_0 / std::sqrt((T) n));
+
+            ASSERT_LE(norm_0, atol * std::sqrt((T) n));
+            ASSERT_LE(CQRRPT.pivot_quality(), CQRRPT.pivot_tol);
+        }
+    }
 };
 
 // Note: If Subprocess killed exception -> reload vscode
@@ -154,6 +263,32 @@ TEST_F(TestCQRRPT, CQRRPT_full_rank_no_hqrrp) {
     test_CQRRPT_general(d_factor, norm_A, all_data, CQRRPT, state);
 }
 
+TEST_F(TestCQRRPT, CQRRPT_full_rank_luqr_qrcp) {
+    int64_t m = 10000;
+    int64_t n = 200;
+    int64_t k = 200;
+    double d_factor = 2;
+    double norm_A = 0;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    CQRRPTTestData<double> all_data(m, n, k);
+    RandLAPACK::CQRRPT<double, r123::Philox4x32> CQRRPT(false, tol);
+    RandLAPACK::LUQR_QRCP QRCP;
+    CQRRPT.nnz = 2;
+    CQRRPT.num_threads = 4;
+    CQRRPT.QRCP_Obj = &QRCP;
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::polynomial);
+    m_info.cond_num = 2;
+    m_info.rank = k;
+    m_info.exponent = 2.0;
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+
+    norm_and_copy_computational_helper(norm_A, all_data);
+    test_CQRRPT_general(d_factor, norm_A, all_data, CQRRPT, state);
+}
+
 TEST_F(TestCQRRPT, CQRRPT_low_rank_with_hqrrp) {
     int64_t m = 10000;
     int64_t n = 200;
@@ -179,6 +314,267 @@ TEST_F(TestCQRRPT, CQRRPT_low_rank_with_hqrrp) {
     test_CQRRPT_general(d_factor, norm_A, all_data, CQRRPT, state);
 }
 
+TEST_F(TestCQRRPT, CQRRPT_full_rank_fused_gram) {
+    int64_t m = 10000;
+    int64_t n = 200;
+    int64_t k = 200;
+    double d_factor = 2;
+    double norm_A = 0;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    CQRRPTTestData<double> all_data(m, n, k);
+    RandLAPACK::CQRRPT<double, r123::Philox4x32> CQRRPT(false, tol);
+    CQRRPT.nnz = 2;
+    CQRRPT.no_hqrrp = 1;
+    CQRRPT.use_fused_gram = 1;
+    // Small panels, so that there are more panels than threads
+    CQRRPT.gram_panel_rows = 300;
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::polynomial);
+    m_info.cond_num = 2;
+    m_info.rank = k;
+    m_info.exponent = 2.0;
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+
+    norm_and_copy_computational_helper(norm_A, all_data);
+    test_CQRRPT_general(d_factor, norm_A, all_data, CQRRPT, state);
+}
+
+TEST_F(TestCQRRPT, CQRRPT_full_rank_adaptive_sketch) {
+    int64_t m = 10000;
+    int64_t n = 200;
+    int64_t k = 200;
+    double d_factor = 2;
+    double norm_A = 0;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    CQRRPTTestData<double> all_data(m, n, k);
+    RandLAPACK::CQRRPT<double, r123::Philox4x32> CQRRPT(false, tol);
+    CQRRPT.nnz = 2;
+    CQRRPT.no_hqrrp = 1;
+    CQRRPT.adaptive_sketch = 1;
+    // A sketch of n + 1 rows is a poor preconditioner, so it has to grow.
+    CQRRPT.adaptive_oversampling = 1;
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::polynomial);
+    m_info.cond_num = 1e5;
+    m_info.rank = k;
+    m_info.exponent = 2.0;
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+
+    norm_and_copy_computational_helper(norm_A, all_data);
+    test_CQRRPT_general(d_factor, norm_A, all_data, CQRRPT, state);
+
+    printf("EMBEDDING DIMENSION %ld, ESTIMATED CONDITION NUMBER %e\n", CQRRPT.d_used, CQRRPT.cond_est);
+    ASSERT_GT(CQRRPT.d_used, n + 1);
+    ASSERT_LE(CQRRPT.d_used, (int64_t) (d_factor * n));
+    ASSERT_TRUE(CQRRPT.cond_est <= CQRRPT.adaptive_cond_tol || CQRRPT.d_used == (int64_t) (d_factor * n));
+}
+
+TEST_F(TestCQRRPT, CQRRPT_full_rank_mixed_precision) {
+    int64_t m = 10000;
+    int64_t n = 200;
+    int64_t k = 200;
+    double d_factor = 2;
+    double norm_A = 0;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    CQRRPTTestData<double> all_data(m, n, k);
+    RandLAPACK::CQRRPT<double, r123::Philox4x32> CQRRPT(false, tol);
+    CQRRPT.nnz = 2;
+    CQRRPT.no_hqrrp = 1;
+    CQRRPT.use_mixed_precision = 1;
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::polynomial);
+    m_info.cond_num = 2;
+    m_info.rank = k;
+    m_info.exponent = 2.0;
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+
+    norm_and_copy_computational_helper(norm_A, all_data);
+    test_CQRRPT_general(d_factor, norm_A, all_data, CQRRPT, state);
+}
+
+TEST_F(TestCQRRPT, CQRRPT_low_rank_mixed_precision) {
+    int64_t m = 10000;
+    int64_t n = 200;
+    int64_t k = 100;
+    double d_factor = 2;
+    double norm_A = 0;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    CQRRPTTestData<double> all_data(m, n, k);
+    RandLAPACK::CQRRPT<double, r123::Philox4x32> CQRRPT(false, tol);
+    CQRRPT.nnz = 2;
+    CQRRPT.no_hqrrp = 0;
+    CQRRPT.use_mixed_precision = 1;
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::polynomial);
+    m_info.cond_num = 2;
+    m_info.rank = k;
+    m_info.exponent = 2.0;
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+
+    norm_and_copy_computational_helper(norm_A, all_data);
+    test_CQRRPT_general(d_factor, norm_A, all_data, CQRRPT, state);
+}
+
+TEST_F(TestCQRRPT, CQRRPT_sparse_csr) {
+    int64_t m = 10000;
+    int64_t n = 200;
+    double d_factor = 2;
+    double norm_A = 0;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    CQRRPTTestData<double> all_data(m, n, n);
+    SparseTestMatrix<double> A_sp;
+    sparse_gen(m, n, 0.02, 0, all_data.A.data(), A_sp);
+    RandLAPACK::CSRMatrixView<double> A_csr(m, n, A_sp.rowptr.data(), A_sp.colidxs.data(), A_sp.csr_vals.data());
+
+    RandLAPACK::CQRRPT<double, r123::Philox4x32> CQRRPT(false, tol);
+    CQRRPT.nnz = 2;
+    CQRRPT.no_hqrrp = 1;
+    // Ignored by the sparse-input version.
+    CQRRPT.adaptive_sketch = 1;
+
+    norm_and_copy_computational_helper(norm_A, all_data);
+    test_CQRRPT_sparse(d_factor, norm_A, A_csr, all_data, CQRRPT, state);
+    ASSERT_EQ(CQRRPT.d_used, (int64_t) (d_factor * n));
+    ASSERT_EQ(CQRRPT.cond_est, 0.0);
+}
+
+TEST_F(TestCQRRPT, CQRRPT_sparse_csc) {
+    int64_t m = 10000;
+    int64_t n = 200;
+    double d_factor = 2;
+    double norm_A = 0;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    CQRRPTTestData<double> all_data(m, n, n);
+    SparseTestMatrix<double> A_sp;
+    sparse_gen(m, n, 0.02, 1, all_data.A.data(), A_sp);
+    RandLAPACK::CSCMatrixView<double> A_csc(m, n, A_sp.colptr.data(), A_sp.rowidxs.data(), A_sp.csc_vals.data());
+
+    RandLAPACK::CQRRPT<double, r123::Philox4x32> CQRRPT(false, tol);
+    CQRRPT.nnz = 2;
+    CQRRPT.no_hqrrp = 0;
+
+    norm_and_copy_computational_helper(norm_A, all_data);
+    test_CQRRPT_sparse(d_factor, norm_A, A_csc, all_data, CQRRPT, state);
+}
+
+// Every odd column is the preceding one plus a 1e-10 multiple of an independent sparse column,
+// so that cond(A) is around 1e10. The preconditioned Gram matrix has to stay well-conditioned.
+TEST_F(TestCQRRPT, CQRRPT_sparse_ill_conditioned) {
+    int64_t m = 10000;
+    int64_t n = 200;
+    double d_factor = 2;
+    double norm_A = 0;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    CQRRPTTestData<double> all_data(m, n, n);
+    CQRRPTTestData<double> all_data_csc(m, n, n);
+    SparseTestMatrix<double> A_sp;
+    sparse_gen(m, n, 0.02, 2, all_data.A.data(), A_sp);
+    for(int64_t j = 1; j < n; j += 2) {
+        blas::scal(m, 1e-10, &all_data.A[m * j], 1);
+        blas::axpy(m, 1.0, &all_data.A[m * (j - 1)], 1, &all_data.A[m * j], 1);
+    }
+    sparse_from_dense(m, n, all_data.A.data(), A_sp);
+    all_data_csc.A = all_data.A;
+    RandLAPACK::CSRMatrixView<double> A_csr(m, n, A_sp.rowptr.data(), A_sp.colidxs.data(), A_sp.csr_vals.data());
+    RandLAPACK::CSCMatrixView<double> A_csc(m, n, A_sp.colptr.data(), A_sp.rowidxs.data(), A_sp.csc_vals.data());
+
+    RandLAPACK::CQRRPT<double, r123::Philox4x32> CQRRPT(false, tol);
+    CQRRPT.nnz = 2;
+    CQRRPT.no_hqrrp = 1;
+
+    norm_and_copy_computational_helper(norm_A, all_data);
+    auto state_alg = state;
+    test_CQRRPT_sparse(d_factor, norm_A, A_csr, all_data, CQRRPT, state_alg);
+
+    norm_and_copy_computational_helper(norm_A, all_data_csc);
+    state_alg = state;
+    test_CQRRPT_sparse(d_factor, norm_A, A_csc, all_data_csc, CQRRPT, state_alg);
+}
+
+TEST_F(TestCQRRPT, CQRRPT_updatable_append) {
+    int64_t m = 10000;
+    int64_t n = 200;
+    int64_t k = 200;
+    double d_factor = 2;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    CQRRPTTestData<double> all_data(m, n, k);
+    RandLAPACK::CQRRPT_updatable<double, r123::Philox4x32> CQRRPT(false, tol);
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::polynomial);
+    m_info.cond_num = 2;
+    m_info.rank = k;
+    m_info.exponent = 2.0;
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+
+    test_CQRRPT_updatable(6000, 1000, d_factor, all_data, CQRRPT, state);
+    ASSERT_EQ(CQRRPT.m, m);
+}
+
+// Fewer rows than nnz are appended at a time, so the new columns of the SASO are taller than they are wide.
+TEST_F(TestCQRRPT, CQRRPT_updatable_append_few_rows) {
+    int64_t m = 2003;
+    int64_t n = 100;
+    int64_t k = 100;
+    double d_factor = 2;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    CQRRPTTestData<double> all_data(m, n, k);
+    RandLAPACK::CQRRPT_updatable<double, r123::Philox4x32> CQRRPT(false, tol);
+    CQRRPT.nnz = 4;
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::polynomial);
+    m_info.cond_num = 2;
+    m_info.rank = k;
+    m_info.exponent = 2.0;
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+
+    test_CQRRPT_updatable(2000, 1, d_factor, all_data, CQRRPT, state);
+    ASSERT_EQ(CQRRPT.m, m);
+}
+
+// The appended rows are dominated by the columns that were pivoted last,
+// so the pivots have to be refreshed.
+TEST_F(TestCQRRPT, CQRRPT_updatable_repivot) {
+    int64_t m = 8000;
+    int64_t n = 100;
+    int64_t k = 100;
+    double d_factor = 2;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    CQRRPTTestData<double> all_data(m, n, k);
+    RandLAPACK::CQRRPT_updatable<double, r123::Philox4x32> CQRRPT(false, tol);
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::gaussian);
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+    // Graded columns, with the weakest ones blown up in the later rows
+    for(int64_t j = 0; j < n; ++j) {
+        blas::scal(m, std::pow(10.0, -3.0 * j / n), &all_data.A[m * j], 1);
+        if(j >= n - 10)
+            blas::scal(m - 5000, 1e5, &all_data.A[m * j + 5000], 1);
+    }
+
+    test_CQRRPT_updatable(3000, 1000, d_factor, all_data, CQRRPT, state);
+    ASSERT_GE(CQRRPT.num_repivots, 1);
+}
+
 // Using L2 norm rank estimation here is similar to using raive estimation. 
 // Fro norm underestimates rank even worse. 
 TEST_F(TestCQRRPT, CQRRPT_bad_orth) {
@@ -203,3 +599,80 @@ TEST_F(TestCQRRPT, CQRRPT_bad_orth) {
     norm_and_copy_computational_helper(norm_A, all_data);
     test_CQRRPT_general(d_factor, norm_A, all_data, CQRRPT, state);
 }
+
+TEST_F(TestCQRRPT, CQRRPT_out_of_core) {
+    int64_t m = 10000;
+    int64_t n = 200;
+    int64_t k = 200;
+    // Does not divide m, so the last panel is shorter
+    int64_t panel_rows = 1500;
+    double d_factor = 2;
+    double norm_A = 0;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    CQRRPTTestData<double> all_data(m, n, k);
+    RandLAPACK::CQRRPT<double, r123::Philox4x32> CQRRPT(false, tol);
+    CQRRPT.nnz = 2;
+    CQRRPT.no_hqrrp = 1;
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::polynomial);
+    m_info.cond_num = 2;
+    m_info.rank = k;
+    m_info.exponent = 2.0;
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+
+    norm_and_copy_computational_helper(norm_A, all_data);
+    test_CQRRPT_out_of_core(d_factor, norm_A, panel_rows, all_data, CQRRPT, state);
+    ASSERT_EQ(CQRRPT.d_used, (int64_t) (d_factor * n));
+    ASSERT_EQ(CQRRPT.cond_est, 0.0);
+}
+
+#if defined(RandLAPACK_HAS_MMAP)
+// Reading from a memory-mapped file must give the same result as reading from memory.
+TEST_F(TestCQRRPT, CQRRPT_out_of_core_mmap) {
+    int64_t m = 5000;
+    int64_t n = 100;
+    int64_t panel_rows = 777;
+    double d_factor = 2;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    std::vector<double> A(m * n, 0.0);
+    std::vector<double> R_mem(n * n, 0.0);
+    std::vector<double> R_file(n * n, 0.0);
+    std::vector<int64_t> J_mem(n, 0);
+    std::vector<int64_t> J_file(n, 0);
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::polynomial);
+    m_info.cond_num = 2;
+    m_info.rank = n;
+    m_info.exponent = 2.0;
+    RandLAPACK::gen::mat_gen(m_info, A.data(), state);
+
+    std::string path = ::testing::TempDir() + "cqrrpt_out_of_core.bin";
+    std::ofstream file(path, std::ios::binary);
+    file.write((char*) A.data(), sizeof(double) * m * n);
+    file.close();
+
+    RandLAPACK::CQRRPT<double, r123::Philox4x32> CQRRPT(false, tol);
+    CQRRPT.nnz = 2;
+    CQRRPT.no_hqrrp = 1;
+
+    auto state_mem = state;
+    RandLAPACK::DenseRowPanels<double> A_mem(m, n, A.data(), m);
+    CQRRPT.call(A_mem, panel_rows, R_mem.data(), n, J_mem.data(), d_factor, state_mem, false);
+
+    auto state_file = state;
+    {
+        RandLAPACK::MMapRowPanels<double> A_file(path, m, n, Layout::ColMajor, false);
+        CQRRPT.call(A_file, panel_rows, R_file.data(), n, J_file.data(), d_factor, state_file, false);
+    }
+    std::remove(path.c_str());
+
+    for(int64_t i = 0; i < n; ++i)
+        ASSERT_EQ(J_mem[i], J_file[i]);
+    for(int64_t i = 0; i < n * n; ++i)
+        ASSERT_EQ(R_mem[i], R_file[i]);
+}
+#endif
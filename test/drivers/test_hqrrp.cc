@@ -94,7 +94,7 @@ class TestHQRRP : public ::testing::Test
                 max_idx = i;
             }
         }
-        T col_norm_A = blas::nrm2(n, &A_cpy_dat[m * max_idx], 1);
+        T col_norm_A = blas::nrm2(m, &A_cpy_dat[m * max_idx], 1);
         T norm_AQR = lapack::lange(Norm::Fro, m, n, A_dat, m);
         
         printf("REL NORM OF AP - QR:    %14e\n", norm_AQR / norm_A);
@@ -117,12 +117,15 @@ class TestHQRRP : public ::testing::Test
         int panel_pivoting,
         T norm_A,
         HQRRPtestData<T> &all_data,
-        RandBLAS::RNGState<RNG> &state) {
+        RandBLAS::RNGState<RNG> &state,
+        RandLAPACK::SketchQRCP* QRCP_Obj = nullptr,
+        int64_t lookahead = 0,
+        int64_t sketch_nnz = 0) {
 
         auto m = all_data.row;
         auto n = all_data.col;
 
-        RandLAPACK::hqrrp(m, n, all_data.A.data(), m, all_data.J.data(), all_data.tau.data(), b_sz, (int64_t) (d_factor * b_sz), panel_pivoting, use_cholqr, state, (T*) nullptr);
+        RandLAPACK::hqrrp(m, n, all_data.A.data(), m, all_data.J.data(), all_data.tau.data(), b_sz, (int64_t) (d_factor * b_sz), panel_pivoting, use_cholqr, state, (T*) nullptr, QRCP_Obj, lookahead, sketch_nnz);
 
         RandLAPACK::util::upsize(all_data.rank * n, all_data.R);
         lapack::lacpy(MatrixType::Upper, all_data.rank, n, all_data.A.data(), m, all_data.R.data(), all_data.rank);
@@ -167,3 +170,107 @@ TEST_F(TestHQRRP, HQRRP_full_rank_cholqr) {
     test_HQRRP_general(d_factor, b_sz, use_cholqr, panel_pivoting, norm_A, all_data, state);
 }
 #endif
+
+// Note: If Subprocess killed exception -> reload vscode
+TEST_F(TestHQRRP, HQRRP_full_rank_tournament_qrcp) {
+    int64_t m = 500;
+    int64_t n = 200;
+    int64_t k = 200;
+    double d_factor = 1.0;
+    int64_t b_sz = 50;
+    int64_t use_cholqr = 0;
+    int panel_pivoting = 1;
+    double norm_A = 0;
+    auto state = RandBLAS::RNGState();
+
+    HQRRPtestData<double> all_data(m, n, k);
+    // Only the leading b_sz pivots of the sketch are used by HQRRP.
+    RandLAPACK::Tournament_QRCP QRCP;
+    QRCP.num_pivots = b_sz;
+    QRCP.group_cols = 60;
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::polynomial);
+    m_info.cond_num = 2;
+    m_info.rank = k;
+    m_info.exponent = 2.0;
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+
+    norm_and_copy_computational_helper(norm_A, all_data);
+    test_HQRRP_general(d_factor, b_sz, use_cholqr, panel_pivoting, norm_A, all_data, state, &QRCP);
+}
+
+TEST_F(TestHQRRP, HQRRP_full_rank_lookahead) {
+    int64_t m = 500;
+    int64_t n = 230;
+    int64_t k = 230;
+    double d_factor = 1.0;
+    int64_t b_sz = 50;
+    int64_t use_cholqr = 0;
+    int panel_pivoting = 1;
+    double norm_A = 0;
+    auto state = RandBLAS::RNGState();
+
+    HQRRPtestData<double> all_data(m, n, k);
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::polynomial);
+    m_info.cond_num = 2;
+    m_info.rank = k;
+    m_info.exponent = 2.0;
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+
+    norm_and_copy_computational_helper(norm_A, all_data);
+    test_HQRRP_general(d_factor, b_sz, use_cholqr, panel_pivoting, norm_A, all_data, state, nullptr, 2);
+}
+
+#if defined(_OPENMP)
+// With a single thread, the lookahead is not done, and the panels are factored in sequence.
+TEST_F(TestHQRRP, HQRRP_full_rank_lookahead_one_thread) {
+    int64_t m = 500;
+    int64_t n = 230;
+    int64_t k = 230;
+    double d_factor = 1.0;
+    int64_t b_sz = 50;
+    int64_t use_cholqr = 0;
+    int panel_pivoting = 1;
+    double norm_A = 0;
+    auto state = RandBLAS::RNGState();
+    int threads_caller = omp_get_max_threads();
+
+    HQRRPtestData<double> all_data(m, n, k);
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::polynomial);
+    m_info.cond_num = 2;
+    m_info.rank = k;
+    m_info.exponent = 2.0;
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+
+    norm_and_copy_computational_helper(norm_A, all_data);
+    omp_set_num_threads(1);
+    test_HQRRP_general(d_factor, b_sz, use_cholqr, panel_pivoting, norm_A, all_data, state, nullptr, 2);
+    ASSERT_EQ(omp_get_max_threads(), 1);
+    omp_set_num_threads(threads_caller);
+}
+#endif
+
+TEST_F(TestHQRRP, HQRRP_full_rank_sparse_sketch) {
+    int64_t m = 2000;
+    int64_t n = 200;
+    int64_t k = 200;
+    double d_factor = 1.0;
+    int64_t b_sz = 50;
+    int64_t use_cholqr = 0;
+    int panel_pivoting = 1;
+    double norm_A = 0;
+    auto state = RandBLAS::RNGState();
+
+    HQRRPtestData<double> all_data(m, n, k);
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::polynomial);
+    m_info.cond_num = 2;
+    m_info.rank = k;
+    m_info.exponent = 2.0;
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+
+    norm_and_copy_computational_helper(norm_A, all_data);
+    test_HQRRP_general(d_factor, b_sz, use_cholqr, panel_pivoting, norm_A, all_data, state, nullptr, 0, 4);
+}
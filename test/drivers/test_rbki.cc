@@ -7,6 +7,8 @@
 #include <fstream>
 #include <gtest/gtest.h>
 
+#include "sparse_test_matrix.hh"
+
 
 class TestRBKI : public ::testing::Test
 {
@@ -99,6 +101,26 @@ class TestRBKI : public ::testing::Test
         printf("residual_err_custom %e\n", residual_err_custom);
         ASSERT_LE(residual_err_custom, 10 * std::pow(std::numeric_limits<T>::epsilon(), 0.825));
     }
+
+    /// Same as above, with A accessed through a linear operator; all_data.A holds its explicit form.
+    template <typename T, typename RNG, typename alg_type>
+    static void test_RBKI_linop(
+        int64_t b_sz,
+        int64_t target_rank,
+        int64_t custom_rank,
+        RandLAPACK::LinearOperator<T> &A_linop,
+        RBKITestData<T> &all_data,
+        alg_type &RBKI,
+        RandBLAS::RNGState<RNG> &state) {
+
+        RBKI.max_krylov_iters = (int) ((target_rank * 2) / b_sz);
+
+        RBKI.call(A_linop, b_sz, all_data.U.data(), all_data.VT.data(), all_data.Sigma.data(), state);
+
+        T residual_err_custom = residual_error_comp<T>(all_data, custom_rank);
+        printf("residual_err_custom %e\n", residual_err_custom);
+        ASSERT_LE(residual_err_custom, 10 * std::pow(std::numeric_limits<T>::epsilon(), 0.825));
+    }
 };
 
 // Note: If Subprocess killed exception -> reload vscode
@@ -121,3 +143,319 @@ TEST_F(TestRBKI, RBKI_basic) {
 
     test_RBKI_general(b_sz, target_rank, custom_rank, all_data, RBKI, state);
 }
+
+// The space for the Krylov bases starts at a single iteration and is grown on the way.
+TEST_F(TestRBKI, RBKI_growing_workspace) {
+    int64_t m           = 400;
+    int64_t n           = 200;
+    int64_t b_sz        = 10;
+    int64_t target_rank = 200;
+    int64_t custom_rank = 100;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    RBKITestData<double> all_data(m, n);
+    RandLAPACK::RBKI<double, r123::Philox4x32> RBKI(false, false, tol);
+    RBKI.num_threads_some = 4;
+    RBKI.num_threads_rest = 16;
+    RBKI.init_krylov_iters = 1;
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::gaussian);
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+
+    test_RBKI_general(b_sz, target_rank, custom_rank, all_data, RBKI, state);
+}
+
+// Only two blocks of each Krylov basis are kept; the factors are formed in a second pass.
+// The leading triplets should agree with the ones found with the full bases.
+TEST_F(TestRBKI, RBKI_two_pass) {
+    int64_t m           = 400;
+    int64_t n           = 200;
+    int64_t b_sz        = 10;
+    int64_t custom_rank = 10;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    RBKITestData<double> all_data(m, n);
+    RBKITestData<double> all_data_two_pass(m, n);
+    RandLAPACK::RBKI<double, r123::Philox4x32> RBKI(false, false, tol);
+    RBKI.num_threads_some = 4;
+    RBKI.num_threads_rest = 16;
+    RBKI.max_krylov_iters = 40;
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::gaussian);
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+    all_data_two_pass.A = all_data.A;
+
+    auto state_alg = state;
+    RBKI.call(m, n, all_data.A.data(), m, b_sz, all_data.U.data(), all_data.VT.data(), all_data.Sigma.data(), state_alg);
+    int iters = RBKI.num_krylov_iters;
+    int64_t one_pass_bytes = RBKI.workspace_query(m, n, b_sz);
+
+    RBKI.two_pass = true;
+    // Neither the bases nor R and S are stored in full, so even the worst-case workspace is smaller.
+    ASSERT_LT(RBKI.workspace_query(m, n, b_sz), one_pass_bytes);
+    state_alg = state;
+    RBKI.call(m, n, all_data_two_pass.A.data(), m, b_sz, all_data_two_pass.U.data(), all_data_two_pass.VT.data(), all_data_two_pass.Sigma.data(), state_alg);
+    ASSERT_EQ(RBKI.num_krylov_iters, iters);
+
+    double atol = std::pow(std::numeric_limits<double>::epsilon(), 0.75);
+    for (int64_t i = 0; i < custom_rank; ++i)
+        ASSERT_NEAR(all_data_two_pass.Sigma[i], all_data.Sigma[i], atol * all_data.Sigma[0]);
+
+    double residual_err_custom = residual_error_comp<double>(all_data_two_pass, custom_rank);
+    printf("residual_err_custom %e\n", residual_err_custom);
+    ASSERT_LE(residual_err_custom, atol * all_data.Sigma[0]);
+}
+
+// A second pass that does not reproduce R and S must not go unnoticed.
+// A negative replay_tol makes every replay count as diverged: with a caller-owned workspace, 1 is returned
+// and the RNG state is left as on entry; the allocating call falls back to storing the bases.
+TEST_F(TestRBKI, RBKI_two_pass_replay_mismatch) {
+    int64_t m           = 400;
+    int64_t n           = 200;
+    int64_t b_sz        = 10;
+    int64_t custom_rank = 10;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    RBKITestData<double> all_data(m, n);
+    RBKITestData<double> all_data_fallback(m, n);
+    RandLAPACK::RBKI<double, r123::Philox4x32> RBKI(false, false, tol);
+    RBKI.num_threads_some = 4;
+    RBKI.num_threads_rest = 16;
+    RBKI.max_krylov_iters = 40;
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::gaussian);
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+    all_data_fallback.A = all_data.A;
+
+    auto state_alg = state;
+    RBKI.call(m, n, all_data.A.data(), m, b_sz, all_data.U.data(), all_data.VT.data(), all_data.Sigma.data(), state_alg);
+
+    RBKI.two_pass   = true;
+    RBKI.replay_tol = -1.0;
+    int64_t work_bytes = RBKI.workspace_query(m, n, b_sz);
+    void* work = RandLAPACK::util::workspace_alloc(work_bytes);
+    state_alg = state;
+    ASSERT_EQ(RBKI.call(m, n, all_data_fallback.A.data(), m, b_sz, all_data_fallback.U.data(), all_data_fallback.VT.data(), all_data_fallback.Sigma.data(), state_alg, work, work_bytes), 1);
+    free(work);
+    ASSERT_TRUE(state_alg.counter == state.counter);
+
+    ASSERT_EQ(RBKI.call(m, n, all_data_fallback.A.data(), m, b_sz, all_data_fallback.U.data(), all_data_fallback.VT.data(), all_data_fallback.Sigma.data(), state_alg), 0);
+    double atol = std::pow(std::numeric_limits<double>::epsilon(), 0.75);
+    for (int64_t i = 0; i < custom_rank; ++i)
+        ASSERT_NEAR(all_data_fallback.Sigma[i], all_data.Sigma[i], atol * all_data.Sigma[0]);
+    ASSERT_LE(residual_error_comp<double>(all_data_fallback, custom_rank), atol * all_data.Sigma[0]);
+}
+
+// The fused and the selective second Gram-Schmidt passes should be as accurate as the default one.
+// The selective pass may be skipped, the fused one never is.
+TEST_F(TestRBKI, RBKI_reorth_policies) {
+    int64_t m           = 400;
+    int64_t n           = 200;
+    int64_t b_sz        = 10;
+    int64_t target_rank = 200;
+    int64_t custom_rank = 100;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    RBKITestData<double> all_data(m, n);
+    RandLAPACK::RBKI<double, r123::Philox4x32> RBKI(false, false, tol);
+    RBKI.num_threads_some = 4;
+    RBKI.num_threads_rest = 16;
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::gaussian);
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+
+    auto state_alg = state;
+    test_RBKI_general(b_sz, target_rank, custom_rank, all_data, RBKI, state_alg);
+    int reorths = RBKI.num_reorths;
+
+    RBKI.reorth = RandLAPACK::cgs2_fused;
+    state_alg = state;
+    test_RBKI_general(b_sz, target_rank, custom_rank, all_data, RBKI, state_alg);
+    ASSERT_EQ(RBKI.num_reorths, reorths);
+
+    RBKI.reorth = RandLAPACK::cgs2_selective;
+    state_alg = state;
+    test_RBKI_general(b_sz, target_rank, custom_rank, all_data, RBKI, state_alg);
+    ASSERT_LE(RBKI.num_reorths, reorths);
+}
+
+TEST_F(TestRBKI, RBKI_sparse_linop) {
+    int64_t m           = 400;
+    int64_t n           = 200;
+    int64_t b_sz        = 10;
+    int64_t target_rank = 200;
+    int64_t custom_rank = 100;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    RBKITestData<double> all_data(m, n);
+    SparseTestMatrix<double> A_sp;
+    sparse_gen(m, n, 0.1, 0, all_data.A.data(), A_sp);
+    RandLAPACK::RBKI<double, r123::Philox4x32> RBKI(false, false, tol);
+    RBKI.num_threads_some = 4;
+    RBKI.num_threads_rest = 16;
+
+    RandLAPACK::CSRMatrixView<double> A_csr(m, n, A_sp.rowptr.data(), A_sp.colidxs.data(), A_sp.csr_vals.data());
+    RandLAPACK::SparseLinOp<double, RandLAPACK::CSRMatrixView<double>> A_csr_linop(A_csr);
+    test_RBKI_linop(b_sz, target_rank, custom_rank, A_csr_linop, all_data, RBKI, state);
+
+    RandLAPACK::CSCMatrixView<double> A_csc(m, n, A_sp.colptr.data(), A_sp.rowidxs.data(), A_sp.csc_vals.data());
+    RandLAPACK::SparseLinOp<double, RandLAPACK::CSCMatrixView<double>> A_csc_linop(A_csc);
+    test_RBKI_linop(b_sz, target_rank, custom_rank, A_csc_linop, all_data, RBKI, state);
+}
+
+// A stored with a leading dimension larger than m, and A = A * I as a composition of two operators.
+TEST_F(TestRBKI, RBKI_dense_linop) {
+    int64_t m           = 400;
+    int64_t n           = 200;
+    int64_t lda         = 410;
+    int64_t b_sz        = 10;
+    int64_t target_rank = 200;
+    int64_t custom_rank = 100;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    RBKITestData<double> all_data(m, n);
+    RandLAPACK::RBKI<double, r123::Philox4x32> RBKI(false, false, tol);
+    RBKI.num_threads_some = 4;
+    RBKI.num_threads_rest = 16;
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::gaussian);
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+
+    std::vector<double> A_strided(lda * n, 0.0);
+    lapack::lacpy(MatrixType::General, m, n, all_data.A.data(), m, A_strided.data(), lda);
+    RandLAPACK::ExplicitLinOp<double> A_linop(m, n, A_strided.data(), lda, Layout::ColMajor);
+    test_RBKI_linop(b_sz, target_rank, custom_rank, A_linop, all_data, RBKI, state);
+
+    std::vector<double> I(n * n, 0.0);
+    RandLAPACK::util::eye(n, n, I.data());
+    RandLAPACK::ExplicitLinOp<double> I_linop(n, n, I.data(), n, Layout::ColMajor);
+    RandLAPACK::ComposedLinOp<double> AI_linop(A_linop, I_linop, A_linop.fro_nrm());
+    test_RBKI_linop(b_sz, target_rank, custom_rank, AI_linop, all_data, RBKI, state);
+}
+
+// A double A is kept as a float copy, and the products with it are done in float.
+// The leading singular values and vectors should be accurate to about single precision.
+TEST_F(TestRBKI, RBKI_mixed_precision) {
+    int64_t m           = 400;
+    int64_t n           = 200;
+    int64_t b_sz        = 10;
+    int64_t custom_rank = 10;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    RBKITestData<double> all_data(m, n);
+    RBKITestData<double> all_data_mixed(m, n);
+    RandLAPACK::RBKI<double, r123::Philox4x32> RBKI(false, false, tol);
+    RBKI.num_threads_some = 4;
+    RBKI.num_threads_rest = 16;
+    RBKI.max_krylov_iters = 40;
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::gaussian);
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+    all_data_mixed.A = all_data.A;
+
+    auto state_alg = state;
+    RBKI.call(m, n, all_data.A.data(), m, b_sz, all_data.U.data(), all_data.VT.data(), all_data.Sigma.data(), state_alg);
+
+    RandLAPACK::MixedPrecisionLinOp<double, float> A_linop(m, n, all_data_mixed.A.data(), m, Layout::ColMajor);
+    state_alg = state;
+    RBKI.call(A_linop, b_sz, all_data_mixed.U.data(), all_data_mixed.VT.data(), all_data_mixed.Sigma.data(), state_alg);
+
+    double atol = 10 * std::numeric_limits<float>::epsilon() * std::sqrt((double) n);
+    for (int64_t i = 0; i < custom_rank; ++i)
+        ASSERT_NEAR(all_data_mixed.Sigma[i], all_data.Sigma[i], atol * all_data.Sigma[0]);
+
+    double residual_err_custom = residual_error_comp<double>(all_data_mixed, custom_rank);
+    printf("residual_err_custom %e\n", residual_err_custom);
+    ASSERT_LE(residual_err_custom, atol * all_data.Sigma[0]);
+}
+
+// The leading triplets of a matrix with a decaying spectrum converge long before max_krylov_iters;
+// the algorithm should stop there, and their residuals should be within the requested tolerance.
+TEST_F(TestRBKI, RBKI_residual_termination) {
+    int64_t m           = 400;
+    int64_t n           = 200;
+    int64_t b_sz        = 10;
+    int64_t k_target    = 10;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    double residual_tol = 1e-10;
+    auto state = RandBLAS::RNGState();
+
+    RBKITestData<double> all_data(m, n);
+    RandLAPACK::RBKI<double, r123::Philox4x32> RBKI(false, false, tol);
+    RBKI.num_threads_some = 4;
+    RBKI.num_threads_rest = 16;
+    RBKI.max_krylov_iters = 40;
+    RBKI.k_target = k_target;
+    RBKI.residual_tol = residual_tol;
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::gaussian);
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+    for (int64_t j = 0; j < n; ++j)
+        blas::scal(m, std::pow(0.9, (double) j), &all_data.A[m * j], 1);
+
+    RBKI.call(m, n, all_data.A.data(), m, b_sz, all_data.U.data(), all_data.VT.data(), all_data.Sigma.data(), state);
+    printf("krylov_iters %d\n", RBKI.num_krylov_iters);
+    ASSERT_LT(RBKI.num_krylov_iters, 40);
+
+    double residual_err_custom = residual_error_comp<double>(all_data, k_target);
+    printf("residual_err_custom %e\n", residual_err_custom);
+    ASSERT_LE(residual_err_custom, std::sqrt((double) k_target) * residual_tol * all_data.Sigma[0]);
+}
+
+// After a small perturbation of A, starting from the right singular vectors of the original A
+// should take fewer iterations than a cold start to reach the same residuals.
+TEST_F(TestRBKI, RBKI_warm_start) {
+    int64_t m           = 400;
+    int64_t n           = 200;
+    int64_t b_sz        = 10;
+    int64_t k_target    = 10;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    double residual_tol = 1e-10;
+    auto state = RandBLAS::RNGState();
+
+    RBKITestData<double> all_data(m, n);
+    RandLAPACK::RBKI<double, r123::Philox4x32> RBKI(false, false, tol);
+    RBKI.num_threads_some = 4;
+    RBKI.num_threads_rest = 16;
+    RBKI.max_krylov_iters = 40;
+    RBKI.k_target = k_target;
+    RBKI.residual_tol = residual_tol;
+    RBKI.residual_check_freq = 2;
+
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::gaussian);
+    RandLAPACK::gen::mat_gen(m_info, all_data.A.data(), state);
+    for (int64_t j = 0; j < n; ++j)
+        blas::scal(m, std::pow(0.9, (double) j), &all_data.A[m * j], 1);
+
+    RBKI.call(m, n, all_data.A.data(), m, b_sz, all_data.U.data(), all_data.VT.data(), all_data.Sigma.data(), state);
+
+    // V of the original A.
+    std::vector<double> Y_init(n * b_sz, 0.0);
+    RandLAPACK::util::transposition(b_sz, n, all_data.VT.data(), n, Y_init.data(), n, 0);
+
+    std::vector<double> E(m * n, 0.0);
+    RandLAPACK::gen::mat_gen(m_info, E.data(), state);
+    blas::axpy(m * n, 1e-6, E.data(), 1, all_data.A.data(), 1);
+    RandLAPACK::ExplicitLinOp<double> A_linop(m, n, all_data.A.data(), m, Layout::ColMajor);
+
+    auto state_alg = state;
+    RBKI.call(A_linop, b_sz, all_data.U.data(), all_data.VT.data(), all_data.Sigma.data(), state_alg);
+    int iters_cold = RBKI.num_krylov_iters;
+
+    state_alg = state;
+    RBKI.call(A_linop, b_sz, all_data.U.data(), all_data.VT.data(), all_data.Sigma.data(), state_alg, Y_init.data(), n, b_sz);
+    int iters_warm = RBKI.num_krylov_iters;
+    printf("krylov_iters cold %d, warm %d\n", iters_cold, iters_warm);
+    ASSERT_LT(iters_warm, iters_cold);
+
+    double residual_err_custom = residual_error_comp<double>(all_data, k_target);
+    printf("residual_err_custom %e\n", residual_err_custom);
+    ASSERT_LE(residual_err_custom, std::sqrt((double) k_target) * residual_tol * all_data.Sigma[0]);
+}
@@ -0,0 +1,416 @@
+#include "RandLAPACK.hh"
+#include "rl_blaspp.hh"
+#include "rl_lapackpp.hh"
+#include "rl_gen.hh"
+
+#include <RandBLAS.hh>
+#include <atomic>
+#include <cerrno>
+#include <new>
+#include <numeric>
+#include <gtest/gtest.h>
+
+// This test replaces the C allocation functions and operator new with counting versions,
+// hence it is built as a separate executable.
+//
+// Every allocation made while counting is on is counted, including the ones made by
+// std::vector, std::thread and the work arrays of the LAPACK++ wrappers.
+// Only the warm-up call that each test makes before it starts counting may allocate.
+#if defined(__GLIBC__)
+#define RL_COUNTING_MALLOC_HOOK 1
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t num, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+}
+
+static std::atomic<bool>    count_allocations(false);
+static std::atomic<int64_t> num_allocations(0);
+
+static inline void record_allocation() {
+    if (count_allocations.load(std::memory_order_relaxed))
+        num_allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+extern "C" {
+void* malloc(size_t size) {
+    record_allocation();
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t num, size_t size) {
+    record_allocation();
+    return __libc_calloc(num, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    record_allocation();
+    return __libc_realloc(ptr, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    record_allocation();
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size) {
+    record_allocation();
+    *ptr = __libc_memalign(alignment, size);
+    return (*ptr == nullptr) ? ENOMEM : 0;
+}
+}
+
+void* operator new(size_t size) {
+    record_allocation();
+    void* ptr = __libc_malloc(size ? size : 1);
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    record_allocation();
+    void* ptr = __libc_memalign((size_t) alignment, size ? size : 1);
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { free(ptr); }
+#endif
+
+
+// Every test runs an algorithm through its allocating interface (this also warms up
+// BLAS and OpenMP internals), then through its workspace interface,
+// counting the allocations made in the latter.
+// Both runs start from the same data and RNG state, so their outputs must match exactly.
+class TestWorkspace : public ::testing::Test
+{
+    protected:
+
+    virtual void SetUp() {
+        #if !defined(RL_COUNTING_MALLOC_HOOK)
+        GTEST_SKIP() << "Allocation counting requires glibc.";
+        #endif
+    };
+
+    virtual void TearDown() {};
+
+    #if defined(RL_COUNTING_MALLOC_HOOK)
+    static void start_counting() {
+        num_allocations = 0;
+        count_allocations = true;
+    }
+
+    static int64_t stop_counting() {
+        count_allocations = false;
+        return num_allocations;
+    }
+    #else
+    static void start_counting() {}
+    static int64_t stop_counting() { return 0; }
+    #endif
+
+    /// Checks that the two vectors are equal entry by entry.
+    template <typename T>
+    static void check_outputs_match(std::vector<T> &out_alloc, std::vector<T> &out_ws) {
+        for(size_t i = 0; i < out_alloc.size(); ++i)
+            ASSERT_EQ(out_alloc[i], out_ws[i]);
+    }
+};
+
+TEST_F(TestWorkspace, CQRRPT_no_allocations) {
+    int64_t m = 2000;
+    int64_t n = 100;
+    double d_factor = 2;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    std::vector<double> A(m * n, 0.0);
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::polynomial);
+    m_info.cond_num = 2;
+    m_info.rank = n;
+    m_info.exponent = 2.0;
+    RandLAPACK::gen::mat_gen(m_info, A.data(), state);
+
+    RandLAPACK::CQRRPT<double, r123::Philox4x32> CQRRPT(false, tol);
+    CQRRPT.nnz = 2;
+    CQRRPT.no_hqrrp = 1;
+
+    std::vector<double> A_alloc(A);
+    std::vector<double> A_ws(A);
+    std::vector<double> R_alloc(n * n, 0.0);
+    std::vector<double> R_ws(n * n, 0.0);
+    std::vector<int64_t> J_alloc(n, 0);
+    std::vector<int64_t> J_ws(n, 0);
+
+    auto state_alloc = state;
+    CQRRPT.call(m, n, A_alloc.data(), m, R_alloc.data(), n, J_alloc.data(), d_factor, state_alloc);
+
+    int64_t work_bytes = CQRRPT.workspace_query(m, n, d_factor);
+    void* work = RandLAPACK::util::workspace_alloc(work_bytes);
+
+    auto state_ws = state;
+    start_counting();
+    CQRRPT.call(m, n, A_ws.data(), m, R_ws.data(), n, J_ws.data(), d_factor, state_ws, work, work_bytes);
+    int64_t allocations = stop_counting();
+    free(work);
+
+    ASSERT_EQ(allocations, 0);
+    check_outputs_match(A_alloc, A_ws);
+    check_outputs_match(R_alloc, R_ws);
+    for(int64_t i = 0; i < n; ++i)
+        ASSERT_EQ(J_alloc[i], J_ws[i]);
+}
+
+TEST_F(TestWorkspace, HQRRP_no_allocations) {
+    int64_t m = 1000;
+    int64_t n = 300;
+    int64_t nb_alg = 32;
+    int64_t pp = 10;
+    auto state = RandBLAS::RNGState();
+
+    std::vector<double> A(m * n, 0.0);
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::gaussian);
+    RandLAPACK::gen::mat_gen(m_info, A.data(), state);
+
+    // Panel QRCP and panel GEQRF
+    for(int64_t panel_pivoting : {1, 0}) {
+        int64_t qr_type = panel_pivoting ? 0 : 1;
+
+        std::vector<double> A_alloc(A);
+        std::vector<double> A_ws(A);
+        std::vector<double> tau_alloc(n, 0.0);
+        std::vector<double> tau_ws(n, 0.0);
+        std::vector<int64_t> J_alloc(n, 0);
+        std::vector<int64_t> J_ws(n, 0);
+        std::iota(J_alloc.begin(), J_alloc.end(), 1);
+        std::iota(J_ws.begin(), J_ws.end(), 1);
+
+        auto state_alloc = state;
+        RandLAPACK::hqrrp(m, n, A_alloc.data(), m, J_alloc.data(), tau_alloc.data(), nb_alg, pp, panel_pivoting, qr_type, state_alloc, (double*) nullptr);
+
+        int64_t work_bytes = RandLAPACK::hqrrp_workspace_query<double>(m, n, nb_alg, pp);
+        void* work = RandLAPACK::util::workspace_alloc(work_bytes);
+
+        auto state_ws = state;
+        start_counting();
+        RandLAPACK::hqrrp(m, n, A_ws.data(), m, J_ws.data(), tau_ws.data(), nb_alg, pp, panel_pivoting, qr_type, state_ws, (double*) nullptr, work, work_bytes);
+        int64_t allocations = stop_counting();
+        free(work);
+
+        ASSERT_EQ(allocations, 0);
+        check_outputs_match(A_alloc, A_ws);
+        check_outputs_match(tau_alloc, tau_ws);
+        for(int64_t i = 0; i < n; ++i)
+            ASSERT_EQ(J_alloc[i], J_ws[i]);
+    }
+}
+
+#if !defined(__APPLE__)
+TEST_F(TestWorkspace, CQRRP_blocked_no_allocations) {
+    int64_t m = 2000;
+    int64_t n = 400;
+    int64_t b_sz = 100;
+    double d_factor = 1.25;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    std::vector<double> A(m * n, 0.0);
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::gaussian);
+    RandLAPACK::gen::mat_gen(m_info, A.data(), state);
+
+    RandLAPACK::CQRRP_blocked<double, r123::Philox4x32> CQRRP_blocked(false, tol, b_sz);
+    // Several tiles, so that the sketching operator is generated by one thread while the rest apply it.
+    CQRRP_blocked.sketch_tile_cols = 512;
+
+    std::vector<double> A_alloc(A);
+    std::vector<double> A_ws(A);
+    std::vector<double> tau_alloc(n, 0.0);
+    std::vector<double> tau_ws(n, 0.0);
+    std::vector<int64_t> J_alloc(n, 0);
+    std::vector<int64_t> J_ws(n, 0);
+
+    auto state_alloc = state;
+    CQRRP_blocked.call(m, n, A_alloc.data(), m, d_factor, tau_alloc.data(), J_alloc.data(), state_alloc);
+
+    int64_t work_bytes = CQRRP_blocked.workspace_query(m, n, d_factor);
+    void* work = RandLAPACK::util::workspace_alloc(work_bytes);
+
+    auto state_ws = state;
+    start_counting();
+    CQRRP_blocked.call(m, n, A_ws.data(), m, d_factor, tau_ws.data(), J_ws.data(), state_ws, work, work_bytes);
+    int64_t allocations = stop_counting();
+    free(work);
+
+    ASSERT_EQ(allocations, 0);
+    check_outputs_match(A_alloc, A_ws);
+    check_outputs_match(tau_alloc, tau_ws);
+    for(int64_t i = 0; i < n; ++i)
+        ASSERT_EQ(J_alloc[i], J_ws[i]);
+}
+#endif
+
+TEST_F(TestWorkspace, RBKI_no_allocations) {
+    int64_t m = 400;
+    int64_t n = 200;
+    int64_t k = 10;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.85);
+    auto state = RandBLAS::RNGState();
+
+    std::vector<double> A(m * n, 0.0);
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::polynomial);
+    m_info.cond_num = 1e6;
+    m_info.rank = n;
+    m_info.exponent = 2.0;
+    RandLAPACK::gen::mat_gen(m_info, A.data(), state);
+
+    RandLAPACK::RBKI<double, r123::Philox4x32> RBKI(false, false, tol);
+    RBKI.max_krylov_iters = 20;
+
+    std::vector<double> U_alloc(m * n, 0.0);
+    std::vector<double> U_ws(m * n, 0.0);
+    std::vector<double> VT_alloc(n * n, 0.0);
+    std::vector<double> VT_ws(n * n, 0.0);
+    std::vector<double> Sigma_alloc(n, 0.0);
+    std::vector<double> Sigma_ws(n, 0.0);
+
+    auto state_alloc = state;
+    RBKI.call(m, n, A.data(), m, k, U_alloc.data(), VT_alloc.data(), Sigma_alloc.data(), state_alloc);
+
+    int64_t work_bytes = RBKI.workspace_query(m, n, k);
+    void* work = RandLAPACK::util::workspace_alloc(work_bytes);
+
+    auto state_ws = state;
+    start_counting();
+    RBKI.call(m, n, A.data(), m, k, U_ws.data(), VT_ws.data(), Sigma_ws.data(), state_ws, work, work_bytes);
+    int64_t allocations = stop_counting();
+    free(work);
+
+    ASSERT_EQ(allocations, 0);
+    check_outputs_match(U_alloc, U_ws);
+    check_outputs_match(VT_alloc, VT_ws);
+    check_outputs_match(Sigma_alloc, Sigma_ws);
+}
+
+TEST_F(TestWorkspace, RSVD_no_allocations) {
+    int64_t m = 1000;
+    int64_t n = 200;
+    int64_t k = 50;
+    int64_t b_sz = 10;
+    double tol = std::pow(std::numeric_limits<double>::epsilon(), 0.75);
+    auto state = RandBLAS::RNGState();
+
+    std::vector<double> A(m * n, 0.0);
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, n, RandLAPACK::gen::polynomial);
+    m_info.cond_num = 2;
+    m_info.rank = k;
+    m_info.exponent = 2.0;
+    RandLAPACK::gen::mat_gen(m_info, A.data(), state);
+
+    RandLAPACK::PLUL<double> Stab(false, false);
+    RandLAPACK::RS<double, r123::Philox4x32> RS(Stab, 2, 1, false, false);
+    RandLAPACK::CholQRQ<double> Orth_RF(false, false);
+    RandLAPACK::RF<double, r123::Philox4x32> RF(RS, Orth_RF, false, false);
+    RandLAPACK::CholQRQ<double> Orth_QB(false, false);
+    RandLAPACK::QB<double, r123::Philox4x32> QB(RF, Orth_QB, false, false);
+    RandLAPACK::RSVD<double, r123::Philox4x32> RSVD(QB, b_sz);
+
+    std::vector<double> U_ws(m * k, 0.0);
+    std::vector<double> S_ws(k, 0.0);
+    std::vector<double> V_ws(n * k, 0.0);
+    double* U_alloc = nullptr;
+    double* S_alloc = nullptr;
+    double* V_alloc = nullptr;
+
+    int64_t k_alloc = k;
+    auto state_alloc = state;
+    RSVD.call(m, n, A.data(), k_alloc, tol, U_alloc, S_alloc, V_alloc, state_alloc);
+
+    int64_t work_bytes = RSVD.workspace_query(m, n, k);
+    void* work = RandLAPACK::util::workspace_alloc(work_bytes);
+
+    int64_t k_ws = k;
+    auto state_ws = state;
+    start_counting();
+    RSVD.call(m, n, A.data(), k_ws, tol, U_ws.data(), S_ws.data(), V_ws.data(), state_ws, work, work_bytes);
+    int64_t allocations = stop_counting();
+    free(work);
+
+    ASSERT_EQ(allocations, 0);
+    ASSERT_EQ(k_alloc, k_ws);
+    for(int64_t i = 0; i < m * k_ws; ++i)
+        ASSERT_EQ(U_alloc[i], U_ws[i]);
+    for(int64_t i = 0; i < k_ws; ++i)
+        ASSERT_EQ(S_alloc[i], S_ws[i]);
+
+    free(U_alloc);
+    free(S_alloc);
+    free(V_alloc);
+}
+
+TEST_F(TestWorkspace, REVD2_no_allocations) {
+    int64_t m = 500;
+    int64_t k = 10;
+    int64_t k_max = 160;
+    double tol = std::pow(10, -14);
+    auto state = RandBLAS::RNGState(0);
+
+    std::vector<double> A_gen(m * m, 0.0);
+    std::vector<double> A(m * m, 0.0);
+    RandLAPACK::gen::mat_gen_info<double> m_info(m, m, RandLAPACK::gen::polynomial);
+    m_info.cond_num = std::pow(10, 8);
+    m_info.rank = 100;
+    m_info.exponent = 2.0;
+    RandLAPACK::gen::mat_gen(m_info, A_gen.data(), state);
+    // A = A_gen' * A_gen is symmetric positive semidefinite.
+    blas::syrk(Layout::ColMajor, Uplo::Upper, Op::Trans, m, m, 1.0, A_gen.data(), m, 0.0, A.data(), m);
+
+    RandLAPACK::SYPS<double, r123::Philox4x32> SYPS(3, 1, false, false);
+    RandLAPACK::HQRQ<double> Orth_RF(false, false);
+    RandLAPACK::SYRF<double, r123::Philox4x32> SYRF(SYPS, Orth_RF, false, false);
+    RandLAPACK::REVD2<double, r123::Philox4x32> REVD2(SYRF, 10, false);
+    RandLAPACK::ExplicitSymLinOp<double> A_linop(m, Uplo::Upper, A.data(), m, Layout::ColMajor);
+
+    std::vector<double> V_alloc;
+    std::vector<double> eigvals_alloc;
+    std::vector<double> V_ws(m * k_max, 0.0);
+    std::vector<double> eigvals_ws(k_max, 0.0);
+
+    int64_t k_alloc = k;
+    auto state_alloc = state;
+    REVD2.call(A_linop, k_alloc, tol, V_alloc, eigvals_alloc, state_alloc);
+
+    int64_t work_bytes = REVD2.workspace_query(m, k_max);
+    void* work = RandLAPACK::util::workspace_alloc(work_bytes);
+
+    int64_t k_ws = k;
+    auto state_ws = state;
+    start_counting();
+    int info = REVD2.call(A_linop, k_ws, tol, V_ws, eigvals_ws, state_ws, work, work_bytes);
+    int64_t allocations = stop_counting();
+    free(work);
+
+    ASSERT_EQ(info, 0);
+    ASSERT_EQ(allocations, 0);
+    ASSERT_EQ(k_alloc, k_ws);
+    for(int64_t i = 0; i < k_ws; ++i)
+        ASSERT_EQ(eigvals_alloc[i], eigvals_ws[i]);
+}